@@ -0,0 +1,238 @@
+"""Convert a .bmerawbin or .bmerawz log file to the .bmerawdata JSON layout or to CSV.
+
+Usage:
+    python bmerawbin_convert.py LOG.bmerawbin [-o OUTPUT] [--csv]
+    python bmerawbin_convert.py LOG.bmerawz [-o OUTPUT] [--csv]
+
+The output defaults to LOG.bmerawdata, or LOG.csv with --csv. The .bmerawdata
+output is the text the firmware writes in that format: the same header and
+dataBlock rows, one '\t\t[...]' line per row with the floats printed as '%.6f'.
+The CSV layout is the one of dataset1.py: one column per dataColumns name,
+';' separated.
+"""
+import argparse
+import json
+import math
+import os
+import struct
+import sys
+
+MAGIC = b'BME68XRB'
+SUPPORTED_VERSIONS = (1,)
+RAWZ_MAGIC = b'BME68XRZ'
+# version 1 encoded the time since power on on 32 bits, it wrapped after 49.7 days
+RAWZ_SUPPORTED_VERSIONS = (1, 2)
+# magic, version, recordSize, dataOffset
+HEADER = struct.Struct('<8sHHI')
+# timeSincePowerOn, rtcTsp, sensorId, temperature, pressure, humidity,
+# gasResistance, sensorIndex, gasIndex, modeLabel, code; the sensor id is
+# signed, as printed to the .bmerawdata files
+RECORD = struct.Struct('<IIiffffBBBb')
+NULL_BYTE = 0xFF
+NULL_MODE = 0x0F
+
+# .bmerawdata layout, see createFile and closeFile of bme68x_datalogger.cpp: the
+# first row starts on a sector boundary, the footer is END_OF_FILE followed by "\r\n"
+DATA_BLOCK_LINE = '\t    "dataBlock": ['
+SECTOR_SIZE = 512
+ROW_SEPARATOR = ',\n'
+FOOTER = '\n\t    ]\n\t}\n}\n\r\n'
+
+# .bmerawz blocks and record tags, see sample_encoder.h
+RAWZ_BLOCK_SYNC = b'ZBLK'
+RAWZ_MAX_SENSORS = 8
+RAWZ_MAX_STEPS = 10
+TAG_SENSOR = 0x01
+TAG_SENSOR_ID = 0x02
+TAG_DATA = 0x04
+TAG_RTC = 0x08
+TAG_META = 0x10
+TAG_END_OF_BLOCK = 0x80
+FLOAT_BITS = struct.Struct('<I')
+FLOAT = struct.Struct('<f')
+
+
+def make_row(tick, rtc, sensor_id, temperature, pressure, humidity, gas_resistance,
+             sensor_index, gas_index, mode_label, code):
+    """Return the .bmerawdata row of the fields of a binary record."""
+    has_sensor = sensor_index != NULL_BYTE
+    has_data = gas_index != NULL_BYTE
+    mode = mode_label & 0x0F
+    return [
+        sensor_index if has_sensor else None,
+        sensor_id if has_sensor else None,
+        tick,
+        rtc,
+        temperature if has_data else None,
+        pressure if has_data else None,
+        humidity if has_data else None,
+        gas_resistance if has_data else None,
+        gas_index if has_data else None,
+        mode if mode != NULL_MODE else None,
+        mode_label >> 4,
+        code,
+    ]
+
+
+def format_value(value):
+    """Return a value as the firmware prints it: null, an integer, or a float with 6 decimals."""
+    if value is None:
+        return 'null'
+    if isinstance(value, float):
+        return '%.6f' % value
+    return str(value)
+
+
+def format_row(row):
+    """Return the .bmerawdata dataBlock line of a row, as rawRow::appendText writes it."""
+    return '\t\t[' + ','.join(format_value(value) for value in row) + ']'
+
+
+def read_varint(data, pos, mask=0xFFFFFFFF):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value & mask, pos
+        shift += 7
+
+
+def read_delta(data, pos, previous, mask=0xFFFFFFFF):
+    value, pos = read_varint(data, pos, mask)
+    delta = (value >> 1) ^ -(value & 1)
+    return (previous + delta) & mask, pos
+
+
+def decode_blocks(data, pos, version):
+    """Return the data rows of the .bmerawz blocks from pos on."""
+    tick_mask = 0xFFFFFFFF if version == 1 else 0xFFFFFFFFFFFFFFFF
+    rows = []
+    while True:
+        pos = data.find(RAWZ_BLOCK_SYNC, pos)
+        if pos < 0:
+            return rows
+        pos += len(RAWZ_BLOCK_SYNC)
+        float_bits = {}
+        sensor_ids = {}
+        tick = rtc = 0
+        mode_label = code = None
+        try:
+            while pos < len(data):
+                tag = data[pos]
+                # the end of the block, or the sync of the next one after dropped rows
+                if tag & ~(TAG_SENSOR | TAG_SENSOR_ID | TAG_DATA | TAG_RTC | TAG_META):
+                    break
+                pos += 1
+                sensor_index = NULL_BYTE
+                if tag & TAG_SENSOR:
+                    sensor_index = data[pos]
+                    pos += 1
+                slot = sensor_index if sensor_index < RAWZ_MAX_SENSORS else RAWZ_MAX_SENSORS
+                if tag & TAG_SENSOR_ID:
+                    sensor_ids[slot], pos = read_varint(data, pos)
+                sensor_id = sensor_ids.get(slot, 0) if tag & TAG_SENSOR else 0
+                tick, pos = read_delta(data, pos, tick, tick_mask)
+                if tag & TAG_RTC:
+                    rtc, pos = read_delta(data, pos, rtc)
+                values = [math.nan] * 4
+                gas_index = NULL_BYTE
+                if tag & TAG_DATA:
+                    gas_index = data[pos]
+                    pos += 1
+                    key = (slot, gas_index) if gas_index < RAWZ_MAX_STEPS else None
+                    previous = float_bits.get(key, [0, 0, 0, 0])
+                    bits = []
+                    for i in range(4):
+                        value, pos = read_delta(data, pos, previous[i])
+                        bits.append(value)
+                    if key is not None:
+                        float_bits[key] = bits
+                    values = [FLOAT.unpack(FLOAT_BITS.pack(value))[0] for value in bits]
+                if tag & TAG_META:
+                    mode_label = data[pos]
+                    code = struct.unpack_from('<b', data, pos + 1)[0]
+                    pos += 2
+                if pos > len(data) or mode_label is None:
+                    break
+                # the sensor id is signed, as printed to the .bmerawdata files
+                sensor_id = sensor_id - (1 << 32) if sensor_id >= (1 << 31) else sensor_id
+                rows.append(make_row(tick, rtc, sensor_id, *values, sensor_index, gas_index, mode_label, code))
+        except (IndexError, struct.error):
+            # a record cut short by a power loss is ignored
+            return rows
+
+
+
+def read_log(path):
+    """Return the Json header text, the parsed header and the list of data rows of a .bmerawbin or .bmerawz file."""
+    with open(path, 'rb') as file:
+        data = file.read()
+
+    magic, version, record_size, data_offset = HEADER.unpack_from(data, 0)
+    if magic == RAWZ_MAGIC:
+        if version not in RAWZ_SUPPORTED_VERSIONS:
+            raise ValueError('unsupported .bmerawz version %d' % version)
+        header_text = data[HEADER.size:data_offset].rstrip(b'\0').decode('utf-8')
+        return header_text, json.loads(header_text), decode_blocks(data, data_offset, version)
+    if magic != MAGIC:
+        raise ValueError('%s is not a .bmerawbin or .bmerawz file' % path)
+    if version not in SUPPORTED_VERSIONS:
+        raise ValueError('unsupported .bmerawbin version %d' % version)
+    if record_size < RECORD.size:
+        raise ValueError('record size %d is too small' % record_size)
+
+    header_text = data[HEADER.size:data_offset].rstrip(b'\0').decode('utf-8')
+
+    rows = []
+    # a record cut short by a power loss is ignored
+    for pos in range(data_offset, len(data) - record_size + 1, record_size):
+        rows.append(make_row(*RECORD.unpack_from(data, pos)))
+    return header_text, json.loads(header_text), rows
+
+
+def write_json(path, header_text, rows):
+    """Write the .bmerawdata text the firmware writes for the same header and rows."""
+    # the header of a binary file ends with an empty dataBlock, the rows go after its first line
+    start = header_text.index(DATA_BLOCK_LINE)
+    end = header_text.index('\n', start) + 1
+    # blank padding before the dataBlock line, the first row starts on a sector boundary
+    padding = -(start + len(DATA_BLOCK_LINE) + 2) % SECTOR_SIZE
+    with open(path, 'w', newline='') as file:
+        file.write(header_text[:start])
+        file.write(' ' * padding)
+        file.write(header_text[start:end])
+        file.write(ROW_SEPARATOR.join(format_row(row) for row in rows))
+        file.write(FOOTER)
+
+
+def write_csv(path, header, rows):
+    columns = [column['name'] for column in header['rawDataBody']['dataColumns']]
+    with open(path, 'w') as file:
+        file.write(';'.join(columns) + '\n')
+        for row in rows:
+            file.write(';'.join('' if value is None or (isinstance(value, float) and math.isnan(value))
+                                else format_value(value) for value in row) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a .bmerawbin or .bmerawz log file to .bmerawdata JSON or CSV')
+    parser.add_argument('log', help='.bmerawbin or .bmerawz file')
+    parser.add_argument('-o', '--output', help='output file')
+    parser.add_argument('--csv', action='store_true', help='write CSV instead of JSON')
+    args = parser.parse_args()
+
+    header_text, header, rows = read_log(args.log)
+    output = args.output or os.path.splitext(args.log)[0] + ('.csv' if args.csv else '.bmerawdata')
+    if args.csv:
+        write_csv(output, header, rows)
+    else:
+        write_json(output, header_text, rows)
+    print('%d rows written to %s' % (len(rows), output))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
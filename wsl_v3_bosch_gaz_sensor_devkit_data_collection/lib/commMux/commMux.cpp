@@ -37,15 +37,66 @@
  */
 
 #include "commMux.h"
+#ifdef COMM_MUX_SIMULATION
+#include "commMuxSim.h"
+#endif
 
 #define CLOCK_FREQUENCY 400000
 #define COMM_SPEED 8000000
+/* Register bursts of at least this many bytes use the SPI block transfer calls */
+#define COMM_BURST_THRESHOLD 4
 
 const uint8_t I2C_EXPANDER_ADDR = 0x20;
 const uint8_t I2C_EXPANDER_OUTPUT_REG_ADDR = 0x01;
 const uint8_t I2C_EXPANDER_OUTPUT_DESELECT = 0xFF;
 const uint8_t I2C_EXPANDER_CONFIG_REG_ADDR = 0x03;
 const uint8_t I2C_EXPANDER_CONFIG_REG_MASK = 0x00;
+/* Never used as a select mask, forces the next expander write */
+const uint8_t I2C_EXPANDER_OUTPUT_SELECT_UNKNOWN = 0x00;
+
+/* Chip select mask currently driven on the I2C-Expander outputs */
+static uint8_t chipSelectMask = I2C_EXPANDER_OUTPUT_DESELECT;
+/* Descriptor holding the open chip select session, if any */
+static commMux *sessionComm = nullptr;
+/* Number of I2C-Expander write transactions issued so far */
+static uint32_t expanderWrites = 0;
+/* Nesting depth, owner and start time of the current bus ownership */
+static uint8_t busLockDepth = 0;
+static commMuxBusOwner busHolder = COMM_MUX_OWNER_SENSORS;
+static uint64_t busHoldStart = 0;
+static commMuxBusStats busStats[COMM_MUX_OWNER_COUNT];
+/* Injected time base, nullptr while the platform clock is used */
+static const commMuxClock *timeBase = nullptr;
+/* Bus settings shared by all sensors, built once */
+static const SPISettings commSettings(COMM_SPEED, MSBFIRST, SPI_MODE0);
+
+#ifdef COMM_MUX_SIMULATION
+/* Number of simulated sensors, one per expander output */
+#define COMM_MUX_SIM_UNITS 8
+/* Base of the simulated unique ids, the sensor index is added */
+#define COMM_MUX_SIM_UNIQUE_ID 0x5A0000C0
+
+static bme68xSim simSensors[COMM_MUX_SIM_UNITS];
+
+/**
+ * @brief Function to retrieve the simulated sensor behind a descriptor
+ */
+static bme68xSim &getSim(const commMux *comm)
+{
+	/* the select mask has the sensor output driven low */
+	return simSensors[__builtin_ctz((uint8_t) ~comm->select)];
+}
+
+/**
+ * @brief Function to retrieve a simulated sensor, e.g. to inject faults
+ */
+bme68xSim *commMuxGetSim(uint8_t idx)
+{
+	return (idx < COMM_MUX_SIM_UNITS) ? &simSensors[idx] : nullptr;
+}
+#endif
+
+static void setChipSelect(TwoWire *wireobj, uint8_t mask);
 
 /**
  * @brief Function to configure the communication across sensors
@@ -66,10 +117,22 @@ void commMuxBegin(TwoWire &wireobj, SPIClass &spiobj)
 {
 	// wireobj.begin(I2C_SDA,I2C_SCL);
 	// wireobj.setClock(CLOCK_FREQUENCY); // don't work properly with wireless stick lite
+#ifdef COMM_MUX_SIMULATION
+	for (uint8_t i = 0; i < COMM_MUX_SIM_UNITS; i++)
+	{
+		simSensors[i].begin(COMM_MUX_SIM_UNIQUE_ID + i, commMuxGetTimeUs);
+	}
+#else
 	wireobj.beginTransmission(I2C_EXPANDER_ADDR);
 	wireobj.write(I2C_EXPANDER_CONFIG_REG_ADDR);
 	wireobj.write(I2C_EXPANDER_CONFIG_REG_MASK);
 	wireobj.endTransmission();
+#endif
+
+	/* start from a known deselected state */
+	sessionComm = nullptr;
+	chipSelectMask = I2C_EXPANDER_OUTPUT_SELECT_UNKNOWN;
+	setChipSelect(&wireobj, I2C_EXPANDER_OUTPUT_DESELECT);
 
 	spiobj.begin();
 }
@@ -79,6 +142,12 @@ void commMuxBegin(TwoWire &wireobj, SPIClass &spiobj)
  */
 static void setChipSelect(TwoWire *wireobj, uint8_t mask)
 {
+	/* the expander already drives this mask, skip the I2C transaction */
+	if (mask == chipSelectMask)
+	{
+		return;
+	}
+#ifndef COMM_MUX_SIMULATION
 	// send I2C-Expander device address
 	wireobj->beginTransmission(I2C_EXPANDER_ADDR);
 	// send I2C-Expander output register address
@@ -87,6 +156,278 @@ static void setChipSelect(TwoWire *wireobj, uint8_t mask)
 	wireobj->write(mask);
 	// end communication
 	wireobj->endTransmission();
+#else
+	/* the simulated sensors have no chip select */
+	(void) wireobj;
+#endif
+
+	chipSelectMask = mask;
+	expanderWrites++;
+}
+
+/**
+ * @brief Function to pulse the chip select of an already selected sensor
+ */
+static void pulseChipSelect(TwoWire *wireobj, uint8_t mask)
+{
+	/* the output register is not auto incremented, each data byte updates the
+	   GPIO levels: deselect and reselect within a single I2C transaction */
+#ifndef COMM_MUX_SIMULATION
+	wireobj->beginTransmission(I2C_EXPANDER_ADDR);
+	wireobj->write(I2C_EXPANDER_OUTPUT_REG_ADDR);
+	wireobj->write(I2C_EXPANDER_OUTPUT_DESELECT);
+	wireobj->write(mask);
+	wireobj->endTransmission();
+#else
+	/* the simulated sensors have no chip select */
+	(void) wireobj;
+#endif
+
+	chipSelectMask = mask;
+	expanderWrites++;
+}
+
+/**
+ * @brief Function to assert the chip select before a register access
+ */
+static void selectSensor(commMux *comm)
+{
+	if ((comm == sessionComm) && (chipSelectMask == comm->select))
+	{
+		/* every SPI frame starts on a falling chip select edge */
+		pulseChipSelect(comm->wireobj, comm->select);
+	}
+	else
+	{
+		setChipSelect(comm->wireobj, I2C_EXPANDER_OUTPUT_DESELECT);
+		setChipSelect(comm->wireobj, comm->select);
+	}
+}
+
+/**
+ * @brief Function to release the chip select after a register access
+ */
+static void releaseSensor(commMux *comm)
+{
+	/* within a session the sensor stays selected until the session ends */
+	if (comm != sessionComm)
+	{
+		setChipSelect(comm->wireobj, I2C_EXPANDER_OUTPUT_DESELECT);
+	}
+}
+
+/**
+ * @brief Function to replace the time base of commMux
+ */
+void commMuxSetClock(const commMuxClock *clock)
+{
+	timeBase = clock;
+}
+
+/**
+ * @brief Function to retrieve the current time of the commMux time base
+ */
+uint64_t commMuxGetTimeUs(void)
+{
+	return timeBase ? timeBase->now() : commMuxPortGetTimeUs();
+}
+
+/**
+ * @brief Function to take ownership of the shared SPI bus
+ */
+void commMuxLockBus(commMuxBusOwner owner)
+{
+	uint64_t waitStart = commMuxGetTimeUs();
+	bool contended = false;
+
+	if (!commMuxPortLock(false))
+	{
+		contended = true;
+		(void) commMuxPortLock(true);
+	}
+
+	if (busLockDepth++ == 0)
+	{
+		uint64_t now = commMuxGetTimeUs();
+		uint32_t waitUs = (uint32_t) (now - waitStart);
+		commMuxBusStats &stats = busStats[owner];
+
+		stats.acquisitions++;
+		if (contended)
+		{
+			stats.contentions++;
+		}
+		stats.waitUs += waitUs;
+		if (waitUs > stats.maxWaitUs)
+		{
+			stats.maxWaitUs = waitUs;
+		}
+		busHolder = owner;
+		busHoldStart = now;
+	}
+}
+
+/**
+ * @brief Function to release ownership of the shared SPI bus
+ */
+void commMuxUnlockBus(commMuxBusOwner owner)
+{
+	(void) owner;
+
+	if (--busLockDepth == 0)
+	{
+		uint32_t holdUs = (uint32_t) (commMuxGetTimeUs() - busHoldStart);
+		commMuxBusStats &stats = busStats[busHolder];
+
+		stats.holdUs += holdUs;
+		if (holdUs > stats.maxHoldUs)
+		{
+			stats.maxHoldUs = holdUs;
+		}
+	}
+	commMuxPortUnlock();
+}
+
+/**
+ * @brief Function to retrieve the bus contention statistics of an owner
+ */
+commMuxBusStats commMuxGetBusStats(commMuxBusOwner owner)
+{
+	commMuxBusStats stats;
+
+	/* taken directly, reading the statistics must not count as a bus access */
+	(void) commMuxPortLock(true);
+	stats = busStats[owner];
+	commMuxPortUnlock();
+
+	return stats;
+}
+
+/**
+ * @brief Function to account a finished register access to its descriptor
+ */
+static void recordAccess(commMux *comm, bool isRead, uint32_t length, uint32_t startCycles, uint32_t startExpanderWrites)
+{
+	uint32_t cycles = commMuxPortGetCycles() - startCycles;
+	uint8_t bucket = 0;
+
+	/* bucket by the position of the most significant bit */
+	if (cycles >> COMM_MUX_LATENCY_BASE_SHIFT)
+	{
+		bucket = (31 - __builtin_clz(cycles)) - COMM_MUX_LATENCY_BASE_SHIFT;
+		if (bucket >= COMM_MUX_LATENCY_BUCKETS)
+		{
+			bucket = COMM_MUX_LATENCY_BUCKETS - 1;
+		}
+	}
+
+	if (isRead)
+	{
+		comm->stats.reads++;
+	}
+	else
+	{
+		comm->stats.writes++;
+	}
+	comm->stats.bytes += length;
+	comm->stats.expanderWrites += expanderWrites - startExpanderWrites;
+	comm->stats.latency[bucket]++;
+}
+
+/**
+ * @brief Function to retrieve the bus transaction counters of a sensor
+ */
+commMuxStats commMuxGetStats(const commMux &comm)
+{
+	commMuxStats stats;
+
+	(void) commMuxPortLock(true);
+	stats = comm.stats;
+	commMuxPortUnlock();
+
+	return stats;
+}
+
+/**
+ * @brief Function to clear the bus transaction counters of a sensor
+ */
+void commMuxResetStats(commMux &comm)
+{
+	(void) commMuxPortLock(true);
+	memset(&comm.stats, 0, sizeof(comm.stats));
+	commMuxPortUnlock();
+}
+
+#ifdef ARDUINO
+/**
+ * @brief Function to print the bus transaction counters of a sensor as one line
+ */
+void commMuxPrintStats(Print &out, const commMux &comm, uint8_t idx)
+{
+	commMuxStats stats = commMuxGetStats(comm);
+
+	out.printf("sensor %u: reads %lu writes %lu bytes %lu expander %lu latency", idx,
+			   (unsigned long) stats.reads, (unsigned long) stats.writes,
+			   (unsigned long) stats.bytes, (unsigned long) stats.expanderWrites);
+	for (uint8_t i = 0; i < COMM_MUX_LATENCY_BUCKETS; i++)
+	{
+		out.printf(" %lu", (unsigned long) stats.latency[i]);
+	}
+	out.println();
+}
+
+/**
+ * @brief Function to print the bus contention statistics of all owners
+ */
+void commMuxPrintBusStats(Print &out)
+{
+	static const char *ownerNames[COMM_MUX_OWNER_COUNT] = {"sensors", "storage"};
+
+	for (uint8_t i = 0; i < COMM_MUX_OWNER_COUNT; i++)
+	{
+		commMuxBusStats stats = commMuxGetBusStats((commMuxBusOwner) i);
+		out.printf("bus %s: acquisitions %lu contentions %lu wait %llu us (max %lu) hold %llu us (max %lu)\n",
+				   ownerNames[i], (unsigned long) stats.acquisitions, (unsigned long) stats.contentions,
+				   (unsigned long long) stats.waitUs, (unsigned long) stats.maxWaitUs,
+				   (unsigned long long) stats.holdUs, (unsigned long) stats.maxHoldUs);
+	}
+}
+#endif
+
+/**
+ * @brief Function to keep a sensor selected over several register accesses
+ */
+void commMuxBeginSession(commMux &comm)
+{
+	commMuxLockBus(COMM_MUX_OWNER_SENSORS);
+	if (sessionComm != nullptr)
+	{
+		commMuxEndSession();
+	}
+	sessionComm = &comm;
+}
+
+/**
+ * @brief Function to close the current chip select session
+ */
+void commMuxEndSession(void)
+{
+	if (sessionComm != nullptr)
+	{
+		uint32_t startExpanderWrites = expanderWrites;
+		setChipSelect(sessionComm->wireobj, I2C_EXPANDER_OUTPUT_DESELECT);
+		sessionComm->stats.expanderWrites += expanderWrites - startExpanderWrites;
+		sessionComm = nullptr;
+		commMuxUnlockBus(COMM_MUX_OWNER_SENSORS);
+	}
+}
+
+/**
+ * @brief Function to retrieve the number of I2C-Expander write transactions
+ */
+uint32_t commMuxGetExpanderWrites(void)
+{
+	return expanderWrites;
 }
 
 /**
@@ -95,23 +436,42 @@ static void setChipSelect(TwoWire *wireobj, uint8_t mask)
 int8_t commMuxWrite(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length, void *intf_ptr)
 {
 	commMux *comm = (commMux*) intf_ptr;
+	int8_t rslt = 0;
 	uint32_t i;
 
 	if (comm)
 	{
-		setChipSelect(comm->wireobj, comm->select);
+		commMuxLockBus(COMM_MUX_OWNER_SENSORS);
+		uint32_t startCycles = commMuxPortGetCycles();
+		uint32_t startExpanderWrites = expanderWrites;
+		selectSensor(comm);
 
-		comm->spiobj->beginTransaction(SPISettings(COMM_SPEED, MSBFIRST, SPI_MODE0));
+#ifdef COMM_MUX_SIMULATION
+		(void) i;
+		rslt = getSim(comm).write(reg_addr, reg_data, length);
+#else
+		comm->spiobj->beginTransaction(commSettings);
 		comm->spiobj->transfer(reg_addr);
-		for (i = 0; i < length; i++)
+		if (length >= COMM_BURST_THRESHOLD)
+		{
+			/* push the whole burst through the SPI FIFO at once */
+			comm->spiobj->writeBytes(reg_data, length);
+		}
+		else
 		{
-			comm->spiobj->transfer(reg_data[i]);
+			for (i = 0; i < length; i++)
+			{
+				comm->spiobj->transfer(reg_data[i]);
+			}
 		}
 		comm->spiobj->endTransaction();
+#endif
 
-		setChipSelect(comm->wireobj, I2C_EXPANDER_OUTPUT_DESELECT);
+		releaseSensor(comm);
+		recordAccess(comm, false, length, startCycles, startExpanderWrites);
+		commMuxUnlockBus(COMM_MUX_OWNER_SENSORS);
 
-		return 0;
+		return rslt;
 	}
 
 	return 1;
@@ -123,23 +483,42 @@ int8_t commMuxWrite(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length,
 int8_t commMuxRead(uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf_ptr)
 {
 	commMux *comm = (commMux*) intf_ptr;
+	int8_t rslt = 0;
 	uint32_t i;
 
 	if (comm)
 	{
-		setChipSelect(comm->wireobj, comm->select);
+		commMuxLockBus(COMM_MUX_OWNER_SENSORS);
+		uint32_t startCycles = commMuxPortGetCycles();
+		uint32_t startExpanderWrites = expanderWrites;
+		selectSensor(comm);
 
-		comm->spiobj->beginTransaction(SPISettings(COMM_SPEED, MSBFIRST, SPI_MODE0));
+#ifdef COMM_MUX_SIMULATION
+		(void) i;
+		rslt = getSim(comm).read(reg_addr, reg_data, length);
+#else
+		comm->spiobj->beginTransaction(commSettings);
 		comm->spiobj->transfer(reg_addr);
-		for (i = 0; i < length; i++)
+		if (length >= COMM_BURST_THRESHOLD)
+		{
+			/* without input data the block transfer clocks out 0xFF */
+			comm->spiobj->transferBytes(nullptr, reg_data, length);
+		}
+		else
 		{
-			reg_data[i] = comm->spiobj->transfer(0xFF);
+			for (i = 0; i < length; i++)
+			{
+				reg_data[i] = comm->spiobj->transfer(0xFF);
+			}
 		}
 		comm->spiobj->endTransaction();
+#endif
 
-		setChipSelect(comm->wireobj, I2C_EXPANDER_OUTPUT_DESELECT);
+		releaseSensor(comm);
+		recordAccess(comm, true, length, startCycles, startExpanderWrites);
+		commMuxUnlockBus(COMM_MUX_OWNER_SENSORS);
 
-		return 0;
+		return rslt;
 	}
 
 	return 1;
@@ -151,5 +530,12 @@ int8_t commMuxRead(uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *i
 void commMuxDelay(uint32_t period_us, void *intf_ptr)
 {
 	(void) intf_ptr;
-	delayMicroseconds(period_us);
+	if (timeBase)
+	{
+		timeBase->delay(period_us);
+	}
+	else
+	{
+		commMuxPortDelay(period_us);
+	}
 }
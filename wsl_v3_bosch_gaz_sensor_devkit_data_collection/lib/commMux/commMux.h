@@ -38,11 +38,29 @@
 #ifndef COMM_MUX_H
 #define COMM_MUX_H
 
-#include "Arduino.h"
-#include "Wire.h"
-#include "SPI.h"
+#include "commMuxPort.h"
+#ifdef COMM_MUX_SIMULATION
+#include "commMuxSim.h"
+#endif
 
 
+/* Number of buckets of the access latency histogram */
+#define COMM_MUX_LATENCY_BUCKETS       16
+/* Bucket 0 counts accesses below 2^COMM_MUX_LATENCY_BASE_SHIFT CPU cycles */
+#define COMM_MUX_LATENCY_BASE_SHIFT    10
+
+/**
+ * Bus transaction counters of one interface descriptor
+ */
+typedef struct {
+   uint32_t reads;
+   uint32_t writes;
+   uint32_t bytes;
+   uint32_t expanderWrites;
+   /* bucket i counts accesses of [2^(i+BASE_SHIFT), 2^(i+BASE_SHIFT+1)) cycles, the last one is open ended */
+   uint32_t latency[COMM_MUX_LATENCY_BUCKETS];
+} commMuxStats;
+
 /**
  * Datatype working as an interface descriptor
  */
@@ -50,8 +68,30 @@ typedef struct {
    TwoWire *wireobj;
    SPIClass *spiobj;
    uint8_t select;
+   commMuxStats stats;
 } commMux;
 
+/**
+ * Owners competing for the shared SPI bus
+ */
+typedef enum {
+   COMM_MUX_OWNER_SENSORS,
+   COMM_MUX_OWNER_STORAGE,
+   COMM_MUX_OWNER_COUNT
+} commMuxBusOwner;
+
+/**
+ * Bus contention statistics of one owner
+ */
+typedef struct {
+   uint32_t acquisitions;
+   uint32_t contentions;
+   uint64_t waitUs;
+   uint32_t maxWaitUs;
+   uint64_t holdUs;
+   uint32_t maxHoldUs;
+} commMuxBusStats;
+
 /**
  * @brief Function to configure the communication across sensors
  * @param wireobj : The TwoWire object
@@ -69,6 +109,101 @@ commMux commMuxSetConfig(TwoWire &wireobj, SPIClass &spiobj, uint8_t idx, commMu
  */
 void commMuxBegin(TwoWire &wireobj, SPIClass &spiobj);
 
+/**
+ * @brief Function to keep a sensor selected over several register accesses.
+ *        Each access then costs a single I2C-Expander transaction instead of two.
+ *        The session owns the SPI bus until it is ended.
+ * @param comm    : Structure for selected sensor
+ */
+void commMuxBeginSession(commMux &comm);
+
+/**
+ * @brief Function to close the current chip select session and deselect the sensor
+ */
+void commMuxEndSession(void);
+
+/**
+ * @brief Function to retrieve the number of I2C-Expander write transactions
+ * @return Number of expander writes since power on
+ */
+uint32_t commMuxGetExpanderWrites(void);
+
+/**
+ * @brief Function to take ownership of the shared SPI bus. Blocks until the bus is free,
+ *        nested calls from the owning task are allowed.
+ * @param owner   : The bus owner
+ */
+void commMuxLockBus(commMuxBusOwner owner);
+
+/**
+ * @brief Function to release ownership of the shared SPI bus
+ * @param owner   : The bus owner
+ */
+void commMuxUnlockBus(commMuxBusOwner owner);
+
+/**
+ * @brief Function to retrieve the bus contention statistics of an owner
+ * @param owner   : The bus owner
+ * @return        : Copy of the statistics
+ */
+commMuxBusStats commMuxGetBusStats(commMuxBusOwner owner);
+
+/**
+ * @brief Function to retrieve the bus transaction counters of a sensor
+ * @param comm    : Structure for selected sensor
+ * @return        : Copy of the counters
+ */
+commMuxStats commMuxGetStats(const commMux &comm);
+
+/**
+ * @brief Function to clear the bus transaction counters of a sensor
+ * @param comm    : Structure for selected sensor
+ */
+void commMuxResetStats(commMux &comm);
+
+#ifdef ARDUINO
+/**
+ * @brief Function to print the bus transaction counters of a sensor as one line
+ * @param out     : Output stream, e.g. Serial
+ * @param comm    : Structure for selected sensor
+ * @param idx     : Sensor index printed as line prefix
+ */
+void commMuxPrintStats(Print &out, const commMux &comm, uint8_t idx);
+
+/**
+ * @brief Function to print the bus contention statistics of all owners
+ * @param out     : Output stream, e.g. Serial
+ */
+void commMuxPrintBusStats(Print &out);
+#endif
+
+#ifdef COMM_MUX_SIMULATION
+/**
+ * @brief Function to retrieve a simulated sensor, e.g. to inject faults or set its environment
+ * @param idx     : Sensor index
+ * @return        : Pointer to the simulated sensor, nullptr if the index is out of range
+ */
+bme68xSim *commMuxGetSim(uint8_t idx);
+#endif
+
+/**
+ * Scoped ownership of the shared SPI bus
+ */
+class commMuxBusGuard
+{
+public:
+   commMuxBusGuard(commMuxBusOwner owner) : _owner(owner)
+   {
+      commMuxLockBus(_owner);
+   }
+   ~commMuxBusGuard()
+   {
+      commMuxUnlockBus(_owner);
+   }
+private:
+   commMuxBusOwner _owner;
+};
+
 /**
  * @brief Function to write the sensor data to the register
  * @param reg_addr : Address of the register
@@ -90,7 +225,8 @@ int8_t commMuxWrite(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length,
 int8_t commMuxRead(uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf_ptr);
 
 /**
- * @brief Function to maintain a delay between communication
+ * @brief Function to maintain a delay between communication, delays of a millisecond or more
+ *        block the calling task instead of spinning, so other tasks can use the bus and the CPU
  * @param period_us   : Time delay in micro secs
  * @param intf_ptr    : Pointer to the interface descriptor
  */
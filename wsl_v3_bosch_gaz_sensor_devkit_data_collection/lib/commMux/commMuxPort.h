@@ -0,0 +1,162 @@
+/**
+   Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+
+   BSD-3-Clause
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+   FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+   COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+   IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+
+
+   @file    commMuxPort.h
+   @date    17 October 2026
+   @version 1.5.5
+
+*/
+#ifndef COMM_MUX_PORT_H
+#define COMM_MUX_PORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include "Arduino.h"
+#include "Wire.h"
+#include "SPI.h"
+#else
+/* Host stand-ins of the Arduino bus classes, tests derive from them to count or fake the transfers */
+#ifndef MSBFIRST
+#define MSBFIRST 1
+#endif
+#ifndef SPI_MODE0
+#define SPI_MODE0 0
+#endif
+
+/**
+ * I2C master interface, as used by commMux to drive the I2C-Expander
+ */
+class TwoWire
+{
+public:
+   virtual ~TwoWire() {}
+   virtual void beginTransmission(uint8_t address) { (void) address; }
+   virtual size_t write(uint8_t data) { (void) data; return 1; }
+   virtual uint8_t endTransmission(void) { return 0; }
+};
+
+/**
+ * Clock, bit order and mode of an SPI transaction
+ */
+class SPISettings
+{
+public:
+   SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) :
+      _clock(clock), _bitOrder(bitOrder), _dataMode(dataMode) {}
+   uint32_t _clock;
+   uint8_t _bitOrder;
+   uint8_t _dataMode;
+};
+
+/**
+ * SPI master interface, as used by commMux to access the sensors
+ */
+class SPIClass
+{
+public:
+   virtual ~SPIClass() {}
+   virtual void begin(void) {}
+   virtual void beginTransaction(const SPISettings &settings) { (void) settings; }
+   virtual void endTransaction(void) {}
+   virtual uint8_t transfer(uint8_t data) { (void) data; return 0xFF; }
+   virtual void writeBytes(const uint8_t *data, uint32_t size) { (void) data; (void) size; }
+   virtual void transferBytes(const uint8_t *data, uint8_t *out, uint32_t size)
+   {
+      (void) data;
+      memset(out, 0xFF, size);
+   }
+};
+#endif
+
+/**
+ * Time base of commMux, the bus statistics, the delays and the simulated sensors run on it.
+ * Tests and benchmarks inject a virtual clock so that runs are reproducible.
+ */
+typedef struct {
+   /* monotonic time in micro secs */
+   uint64_t (*now)(void);
+   /* waits for the given time, a virtual clock just advances */
+   void (*delay)(uint32_t period_us);
+} commMuxClock;
+
+/**
+ * @brief Function to replace the time base of commMux
+ * @param clock   : Clock to use, nullptr restores the platform clock. Must outlive its use.
+ */
+void commMuxSetClock(const commMuxClock *clock);
+
+/**
+ * @brief Function to retrieve the current time of the commMux time base
+ * @return Time in micro secs
+ */
+uint64_t commMuxGetTimeUs(void);
+
+/*
+ * Platform layer, implemented once for the ESP32 in commMuxPortEsp32.cpp
+ * and once for host builds in commMuxPortHost.cpp
+ */
+
+/**
+ * @brief Function to take the recursive mutex guarding the shared SPI bus
+ * @param wait    : Blocks until the mutex is free if true, returns at once otherwise
+ * @return true if the mutex has been taken
+ */
+bool commMuxPortLock(bool wait);
+
+/**
+ * @brief Function to release the recursive mutex guarding the shared SPI bus
+ */
+void commMuxPortUnlock(void);
+
+/**
+ * @brief Function to retrieve the platform monotonic time
+ * @return Time in micro secs
+ */
+uint64_t commMuxPortGetTimeUs(void);
+
+/**
+ * @brief Function to wait on the platform clock, blocking the calling task for long delays
+ * @param period_us   : Time delay in micro secs
+ */
+void commMuxPortDelay(uint32_t period_us);
+
+/**
+ * @brief Function to retrieve the CPU cycle counter, the time base of the latency histogram
+ * @return Cycle count, wraps around
+ */
+uint32_t commMuxPortGetCycles(void);
+
+#endif /* COMM_MUX_PORT_H */
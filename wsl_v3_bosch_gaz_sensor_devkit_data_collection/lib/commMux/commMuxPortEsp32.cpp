@@ -0,0 +1,108 @@
+/**
+ Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+
+ BSD-3-Clause
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+
+ @file    commMuxPortEsp32.cpp
+ @date    17 October 2026
+ @version 1.5.5
+
+ */
+
+#ifdef ARDUINO
+
+#include "commMuxPort.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+/* Shortest delay, in micro secs, worth giving the CPU away for */
+#define COMM_DELAY_YIELD_US 1000
+
+/**
+ * @brief Function to retrieve the mutex guarding the shared SPI bus
+ */
+static SemaphoreHandle_t getBusMutex(void)
+{
+	/* recursive, so that accesses within a session nest; the mutex applies priority inheritance */
+	static SemaphoreHandle_t busMutex = xSemaphoreCreateRecursiveMutex();
+	return busMutex;
+}
+
+/**
+ * @brief Function to take the recursive mutex guarding the shared SPI bus
+ */
+bool commMuxPortLock(bool wait)
+{
+	return (xSemaphoreTakeRecursive(getBusMutex(), wait ? portMAX_DELAY : 0) == pdTRUE);
+}
+
+/**
+ * @brief Function to release the recursive mutex guarding the shared SPI bus
+ */
+void commMuxPortUnlock(void)
+{
+	xSemaphoreGiveRecursive(getBusMutex());
+}
+
+/**
+ * @brief Function to retrieve the platform monotonic time
+ */
+uint64_t commMuxPortGetTimeUs(void)
+{
+	return (uint64_t) esp_timer_get_time();
+}
+
+/**
+ * @brief Function to wait on the platform clock
+ */
+void commMuxPortDelay(uint32_t period_us)
+{
+	if ((period_us >= COMM_DELAY_YIELD_US) && (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING))
+	{
+		/* one extra tick, the first one may already be partly elapsed */
+		vTaskDelay((TickType_t) ((period_us + (portTICK_PERIOD_MS * 1000) - 1) / (portTICK_PERIOD_MS * 1000)) + 1);
+	}
+	else
+	{
+		delayMicroseconds(period_us);
+	}
+}
+
+/**
+ * @brief Function to retrieve the CPU cycle counter
+ */
+uint32_t commMuxPortGetCycles(void)
+{
+	return ESP.getCycleCount();
+}
+
+#endif /* ARDUINO */
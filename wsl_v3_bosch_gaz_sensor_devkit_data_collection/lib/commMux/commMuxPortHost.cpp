@@ -0,0 +1,105 @@
+/**
+ Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+
+ BSD-3-Clause
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+
+ @file    commMuxPortHost.cpp
+ @date    17 October 2026
+ @version 1.5.5
+
+ */
+
+#ifndef ARDUINO
+
+#include "commMuxPort.h"
+#include <mutex>
+
+/* Cycles per micro sec of the modelled CPU, the ESP32-S3 runs at 240 MHz */
+#define COMM_MUX_HOST_CYCLES_PER_US 240
+
+/* The host platform clock is virtual too, it only advances on delays, so that runs are reproducible */
+static uint64_t hostTimeUs = 0;
+
+/**
+ * @brief Function to retrieve the mutex guarding the shared SPI bus
+ */
+static std::recursive_mutex &getBusMutex(void)
+{
+	static std::recursive_mutex busMutex;
+	return busMutex;
+}
+
+/**
+ * @brief Function to take the recursive mutex guarding the shared SPI bus
+ */
+bool commMuxPortLock(bool wait)
+{
+	if (wait)
+	{
+		getBusMutex().lock();
+		return true;
+	}
+	return getBusMutex().try_lock();
+}
+
+/**
+ * @brief Function to release the recursive mutex guarding the shared SPI bus
+ */
+void commMuxPortUnlock(void)
+{
+	getBusMutex().unlock();
+}
+
+/**
+ * @brief Function to retrieve the platform monotonic time
+ */
+uint64_t commMuxPortGetTimeUs(void)
+{
+	return hostTimeUs;
+}
+
+/**
+ * @brief Function to wait on the platform clock
+ */
+void commMuxPortDelay(uint32_t period_us)
+{
+	hostTimeUs += period_us;
+}
+
+/**
+ * @brief Function to retrieve the CPU cycle counter
+ */
+uint32_t commMuxPortGetCycles(void)
+{
+	/* derived from the time base, so that the latency histogram follows an injected clock */
+	return (uint32_t) (commMuxGetTimeUs() * COMM_MUX_HOST_CYCLES_PER_US);
+}
+
+#endif /* ARDUINO */
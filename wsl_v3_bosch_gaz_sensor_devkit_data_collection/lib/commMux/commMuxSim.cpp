@@ -0,0 +1,516 @@
+/**
+ Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+
+ BSD-3-Clause
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+
+ @file    commMuxSim.cpp
+ @date    17 October 2026
+ @version 1.5.5
+
+ */
+
+#include "commMuxSim.h"
+#include <string.h>
+#include <math.h>
+
+/* Register map, see the BME688 datasheet */
+#define REG_FIELD0              0x1D
+#define LEN_FIELD               17
+#define NUM_FIELDS              3
+#define REG_GAS_WAIT0           0x64
+#define REG_CTRL_GAS_1          0x71
+#define REG_STATUS              0x73
+#define REG_CTRL_MEAS           0x74
+#define REG_UNIQUE_ID           0x83
+#define REG_COEFF1              0x8A
+#define REG_CHIP_ID             0xD0
+#define REG_SOFT_RESET          0xE0
+#define REG_COEFF2              0xE1
+#define REG_VARIANT_ID          0xF0
+#define REG_COEFF3              0x00
+
+#define SPI_ADDR_MSK            0x7F
+#define MEM_PAGE_MSK            0x10
+#define MODE_MSK                0x03
+#define NB_CONV_MSK             0x0F
+#define RUN_GAS_MSK             0x30
+#define SOFT_RESET_CMD          0xB6
+#define NEW_DATA_MSK            0x80
+#define GASM_VALID_MSK          0x20
+#define HEAT_STAB_MSK           0x10
+#define MAX_PROFILE_LEN         10
+
+#define MODE_SLEEP              0
+#define MODE_FORCED             1
+#define MODE_PARALLEL           2
+
+/* Calibration set of a typical part, index layout of the concatenated coefficient registers */
+static const uint16_t PAR_T1 = 26180;
+static const int16_t  PAR_T2 = 26439;
+static const int8_t   PAR_T3 = 3;
+static const uint16_t PAR_P1 = 35815;
+static const int16_t  PAR_P2 = -10436;
+static const int8_t   PAR_P3 = 88;
+static const int16_t  PAR_P4 = 6543;
+static const int16_t  PAR_P5 = -150;
+static const int8_t   PAR_P6 = 30;
+static const int8_t   PAR_P7 = 41;
+static const int16_t  PAR_P8 = -1495;
+static const int16_t  PAR_P9 = -2100;
+static const uint8_t  PAR_P10 = 30;
+static const uint16_t PAR_H1 = 771;
+static const uint16_t PAR_H2 = 1021;
+static const int8_t   PAR_H3 = 0;
+static const int8_t   PAR_H4 = 45;
+static const int8_t   PAR_H5 = 20;
+static const uint8_t  PAR_H6 = 120;
+static const int8_t   PAR_H7 = -100;
+static const int8_t   PAR_GH1 = -37;
+static const int16_t  PAR_GH2 = -10857;
+static const int8_t   PAR_GH3 = 18;
+static const int8_t   RES_HEAT_VAL = 47;
+static const uint8_t  RES_HEAT_RANGE = 1;
+
+/**
+ * @brief Function to store the calibration coefficients in their registers
+ */
+static void writeCalibration(uint8_t regs[256])
+{
+	uint8_t coeff[42];
+
+	memset(coeff, 0, sizeof(coeff));
+	coeff[0] = (uint8_t) PAR_T2;
+	coeff[1] = (uint8_t) (PAR_T2 >> 8);
+	coeff[2] = (uint8_t) PAR_T3;
+	coeff[4] = (uint8_t) PAR_P1;
+	coeff[5] = (uint8_t) (PAR_P1 >> 8);
+	coeff[6] = (uint8_t) PAR_P2;
+	coeff[7] = (uint8_t) (PAR_P2 >> 8);
+	coeff[8] = (uint8_t) PAR_P3;
+	coeff[10] = (uint8_t) PAR_P4;
+	coeff[11] = (uint8_t) (PAR_P4 >> 8);
+	coeff[12] = (uint8_t) PAR_P5;
+	coeff[13] = (uint8_t) (PAR_P5 >> 8);
+	coeff[14] = (uint8_t) PAR_P7;
+	coeff[15] = (uint8_t) PAR_P6;
+	coeff[18] = (uint8_t) PAR_P8;
+	coeff[19] = (uint8_t) (PAR_P8 >> 8);
+	coeff[20] = (uint8_t) PAR_P9;
+	coeff[21] = (uint8_t) (PAR_P9 >> 8);
+	coeff[22] = PAR_P10;
+	coeff[23] = (uint8_t) (PAR_H2 >> 4);
+	coeff[24] = (uint8_t) (((PAR_H2 & 0x0F) << 4) | (PAR_H1 & 0x0F));
+	coeff[25] = (uint8_t) (PAR_H1 >> 4);
+	coeff[26] = (uint8_t) PAR_H3;
+	coeff[27] = (uint8_t) PAR_H4;
+	coeff[28] = (uint8_t) PAR_H5;
+	coeff[29] = PAR_H6;
+	coeff[30] = (uint8_t) PAR_H7;
+	coeff[31] = (uint8_t) PAR_T1;
+	coeff[32] = (uint8_t) (PAR_T1 >> 8);
+	coeff[33] = (uint8_t) PAR_GH2;
+	coeff[34] = (uint8_t) (PAR_GH2 >> 8);
+	coeff[35] = (uint8_t) PAR_GH1;
+	coeff[36] = (uint8_t) PAR_GH3;
+	coeff[37] = (uint8_t) RES_HEAT_VAL;
+	coeff[39] = (uint8_t) (RES_HEAT_RANGE << 4);
+
+	memcpy(&regs[REG_COEFF1], &coeff[0], 23);
+	memcpy(&regs[REG_COEFF2], &coeff[23], 14);
+	memcpy(&regs[REG_COEFF3], &coeff[37], 5);
+}
+
+/**
+ * @brief Function to compensate a temperature reading, as the bme68x driver does
+ */
+static float compensateTemperature(uint32_t adc, float &tFine)
+{
+	float var1 = (((float) adc / 16384.0f) - ((float) PAR_T1 / 1024.0f)) * ((float) PAR_T2);
+	float var2 = (((float) adc / 131072.0f) - ((float) PAR_T1 / 8192.0f));
+
+	var2 = (var2 * var2) * ((float) PAR_T3 * 16.0f);
+	tFine = var1 + var2;
+	return tFine / 5120.0f;
+}
+
+/**
+ * @brief Function to compensate a pressure reading, as the bme68x driver does
+ */
+static float compensatePressure(uint32_t adc, float tFine)
+{
+	float var1 = (tFine / 2.0f) - 64000.0f;
+	float var2 = var1 * var1 * (((float) PAR_P6) / (131072.0f));
+	float var3;
+	float pressure;
+
+	var2 = var2 + (var1 * ((float) PAR_P5) * 2.0f);
+	var2 = (var2 / 4.0f) + (((float) PAR_P4) * 65536.0f);
+	var1 = (((((float) PAR_P3 * var1 * var1) / 16384.0f) + ((float) PAR_P2 * var1)) / 524288.0f);
+	var1 = ((1.0f + (var1 / 32768.0f)) * ((float) PAR_P1));
+	pressure = (1048576.0f - ((float) adc));
+	pressure = (((pressure - (var2 / 4096.0f)) * 6250.0f) / var1);
+	var1 = (((float) PAR_P9) * pressure * pressure) / 2147483648.0f;
+	var2 = pressure * (((float) PAR_P8) / 32768.0f);
+	var3 = ((pressure / 256.0f) * (pressure / 256.0f) * (pressure / 256.0f) * (PAR_P10 / 131072.0f));
+	return (pressure + (var1 + var2 + var3 + ((float) PAR_P7 * 128.0f)) / 16.0f);
+}
+
+/**
+ * @brief Function to compensate a humidity reading, as the bme68x driver does
+ */
+static float compensateHumidity(uint32_t adc, float tFine)
+{
+	float tempComp = tFine / 5120.0f;
+	float var1 = (float) adc - (((float) PAR_H1 * 16.0f) + (((float) PAR_H3 / 2.0f) * tempComp));
+	float var2 = var1 * ((float) (((float) PAR_H2 / 262144.0f) * (1.0f + (((float) PAR_H4 / 16384.0f) * tempComp) +
+					(((float) PAR_H5 / 1048576.0f) * tempComp * tempComp))));
+	float var3 = (float) PAR_H6 / 16384.0f;
+	float var4 = (float) PAR_H7 / 2097152.0f;
+
+	return var2 + ((var3 + (var4 * tempComp)) * var2 * var2);
+}
+
+/**
+ * @brief Function to find the adc value of a monotonic compensation function by bisection
+ */
+template <typename Func>
+static uint32_t invert(Func compensate, float target, uint8_t bits, bool increasing)
+{
+	uint32_t low = 0, high = (UINT32_C(1) << bits) - 1;
+
+	while (low < high)
+	{
+		uint32_t mid = low + (high - low) / 2;
+		if ((compensate(mid) < target) == increasing)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return low;
+}
+
+/**
+ * @brief Constructor of the simulated sensor
+ */
+bme68xSim::bme68xSim() : _clock(nullptr), _uniqueId(0), _faults(BME68X_SIM_FAULT_NONE),
+	_temperature(25.0f), _pressure(100000.0f), _humidity(45.0f), _gasResistance(50000.0f),
+	_stepStartUs(0), _step(0), _measIndex(0), _nextField(0), _fieldCount(0), _noise(1)
+{
+	memset(_regs, 0, sizeof(_regs));
+}
+
+/**
+ * @brief Function to power up the simulated sensor
+ */
+void bme68xSim::begin(uint32_t uniqueId, clockFunc clock)
+{
+	_uniqueId = uniqueId;
+	_clock = clock;
+	_noise = uniqueId | 1;
+	_fieldCount = 0;
+	_measIndex = 0;
+	reset();
+}
+
+/**
+ * @brief Function to set the ambient conditions the sensor measures
+ */
+void bme68xSim::setEnvironment(float temperature, float pressure, float humidity, float gasResistance)
+{
+	_temperature = temperature;
+	_pressure = pressure;
+	_humidity = humidity;
+	_gasResistance = gasResistance;
+}
+
+/**
+ * @brief Function to inject faults
+ */
+void bme68xSim::setFaults(uint8_t faults)
+{
+	_faults = faults;
+}
+
+/**
+ * @brief Function to retrieve the number of published field data records
+ */
+uint32_t bme68xSim::getFieldCount(void) const
+{
+	return _fieldCount;
+}
+
+/**
+ * @brief Function to restore the power on register content
+ */
+void bme68xSim::reset(void)
+{
+	memset(_regs, 0, sizeof(_regs));
+	writeCalibration(_regs);
+
+	_regs[REG_CHIP_ID] = BME68X_SIM_CHIP_ID;
+	_regs[REG_VARIANT_ID] = BME68X_SIM_VARIANT_ID;
+	/* inverse of the byte order the driver assembles the unique id from */
+	_regs[REG_UNIQUE_ID] = (uint8_t) _uniqueId;
+	_regs[REG_UNIQUE_ID + 1] = (uint8_t) (_uniqueId >> 8);
+	_regs[REG_UNIQUE_ID + 2] = (uint8_t) ((_uniqueId >> 24) & 0x7F);
+	_regs[REG_UNIQUE_ID + 3] = (uint8_t) (_uniqueId >> 16);
+
+	_step = 0;
+	_nextField = 0;
+}
+
+/**
+ * @brief Function to translate an SPI address into the register map, depending on the memory page
+ */
+uint8_t bme68xSim::mapAddress(uint8_t spiAddr) const
+{
+	uint8_t addr = spiAddr & SPI_ADDR_MSK;
+
+	/* the status register is visible on both pages */
+	if (addr == REG_STATUS)
+	{
+		return REG_STATUS;
+	}
+	/* page 1 holds 0x00 to 0x7F, page 0 holds 0x80 to 0xFF */
+	return (_regs[REG_STATUS] & MEM_PAGE_MSK) ? addr : (uint8_t) (addr | 0x80);
+}
+
+/**
+ * @brief Function to apply a register write and its side effects
+ */
+void bme68xSim::writeRegister(uint8_t addr, uint8_t value)
+{
+	switch (addr)
+	{
+		case REG_SOFT_RESET:
+			if (value == SOFT_RESET_CMD)
+			{
+				reset();
+			}
+		break;
+		case REG_CTRL_MEAS:
+		{
+			uint8_t mode = value & MODE_MSK;
+			if ((mode == MODE_PARALLEL) && ((_regs[REG_CTRL_MEAS] & MODE_MSK) != MODE_PARALLEL))
+			{
+				/* a new measurement sequence starts with the first heater step */
+				_step = 0;
+				_stepStartUs = _clock ? _clock() : 0;
+			}
+			_regs[REG_CTRL_MEAS] = value;
+			if (mode == MODE_FORCED)
+			{
+				publishField(0);
+				_regs[REG_CTRL_MEAS] = value & (uint8_t) ~MODE_MSK;
+			}
+		}
+		break;
+		case REG_CHIP_ID:
+		case REG_VARIANT_ID:
+		break;
+		default:
+			/* unique id and calibration data are read only */
+			if (((addr >= REG_UNIQUE_ID) && (addr < REG_UNIQUE_ID + 4)) || ((addr >= REG_COEFF1) && (addr < REG_COEFF1 + 23)) ||
+				(addr >= REG_COEFF2 && (addr < REG_COEFF2 + 14)) || (addr < REG_COEFF3 + 5))
+			{
+				break;
+			}
+			_regs[addr] = value;
+		break;
+	}
+}
+
+/**
+ * @brief Function to advance the parallel mode measurement sequence to the current time
+ */
+void bme68xSim::update(void)
+{
+	if (((_regs[REG_CTRL_MEAS] & MODE_MSK) != MODE_PARALLEL) || (_clock == nullptr) || (_faults & BME68X_SIM_FAULT_STUCK))
+	{
+		return;
+	}
+
+	uint8_t profileLen = _regs[REG_CTRL_GAS_1] & NB_CONV_MSK;
+	if (profileLen == 0)
+	{
+		profileLen = 1;
+	}
+	else if (profileLen > MAX_PROFILE_LEN)
+	{
+		profileLen = MAX_PROFILE_LEN;
+	}
+
+	uint64_t now = _clock();
+	/* at most one sequence is caught up, older fields would be overwritten anyway */
+	for (uint8_t i = 0; i < 2 * MAX_PROFILE_LEN; i++)
+	{
+		uint8_t multiplier = _regs[REG_GAS_WAIT0 + _step];
+		uint64_t stepUs = (uint64_t) (multiplier ? multiplier : 1) * BME68X_SIM_STEP_BASE_US;
+
+		if ((now - _stepStartUs) < stepUs)
+		{
+			return;
+		}
+		_stepStartUs += stepUs;
+
+		if (_faults & BME68X_SIM_FAULT_DROP_FIELD)
+		{
+			_faults &= (uint8_t) ~BME68X_SIM_FAULT_DROP_FIELD;
+		}
+		else
+		{
+			publishField(_step);
+		}
+		_step = (_step + 1) % profileLen;
+	}
+	_stepStartUs = now;
+}
+
+/**
+ * @brief Function to write a measurement of a heater step into the next field
+ */
+void bme68xSim::publishField(uint8_t gasIndex)
+{
+	uint8_t *field = &_regs[REG_FIELD0 + (_nextField * LEN_FIELD)];
+	float tFine;
+	float temperature = _temperature + noise(0.05f);
+	float pressure = _pressure + noise(2.0f);
+	float humidity = _humidity + noise(0.2f);
+	/* hotter heater steps lower the gas resistance */
+	float gasResistance = (_gasResistance / (1.0f + 0.15f * gasIndex)) * (1.0f + noise(0.02f));
+
+	uint32_t tempAdc = invert([](uint32_t adc) { float t; return compensateTemperature(adc, t); }, temperature, 20, true);
+	(void) compensateTemperature(tempAdc, tFine);
+	uint32_t presAdc = invert([tFine](uint32_t adc) { return compensatePressure(adc, tFine); }, pressure, 20, false);
+	uint32_t humAdc = invert([tFine](uint32_t adc) { return compensateHumidity(adc, tFine); }, humidity, 16, true);
+
+	/* high variant: R = 1e6 * (262144 >> range) / (4096 + 3 * (adc - 512)) */
+	uint8_t gasRange = 0;
+	uint32_t gasAdc = 512;
+	for (uint8_t range = 0; range < 16; range++)
+	{
+		float var2 = 1000000.0f * (float) (UINT32_C(262144) >> range) / gasResistance;
+		if ((var2 >= 2560.0f) && (var2 <= 5629.0f))
+		{
+			gasRange = range;
+			gasAdc = (uint32_t) lroundf((var2 - 4096.0f) / 3.0f) + 512;
+			break;
+		}
+	}
+
+	uint8_t gasStatus = HEAT_STAB_MSK;
+	if (((_regs[REG_CTRL_GAS_1] & RUN_GAS_MSK) != 0) && !(_faults & BME68X_SIM_FAULT_GAS_INVALID))
+	{
+		gasStatus |= GASM_VALID_MSK;
+	}
+
+	memset(field, 0, LEN_FIELD);
+	field[0] = NEW_DATA_MSK | (gasIndex & 0x0F);
+	field[1] = _measIndex++;
+	field[2] = (uint8_t) (presAdc >> 12);
+	field[3] = (uint8_t) (presAdc >> 4);
+	field[4] = (uint8_t) ((presAdc & 0x0F) << 4);
+	field[5] = (uint8_t) (tempAdc >> 12);
+	field[6] = (uint8_t) (tempAdc >> 4);
+	field[7] = (uint8_t) ((tempAdc & 0x0F) << 4);
+	field[8] = (uint8_t) (humAdc >> 8);
+	field[9] = (uint8_t) humAdc;
+	/* gas registers of both variants */
+	field[13] = field[15] = (uint8_t) (gasAdc >> 2);
+	field[14] = field[16] = (uint8_t) (((gasAdc & 0x03) << 6) | gasStatus | gasRange);
+
+	_nextField = (_nextField + 1) % NUM_FIELDS;
+	_fieldCount++;
+}
+
+/**
+ * @brief Function to draw a deterministic pseudo random value in [-amplitude, amplitude]
+ */
+float bme68xSim::noise(float amplitude)
+{
+	_noise = _noise * UINT32_C(1664525) + UINT32_C(1013904223);
+	return amplitude * ((float) ((int32_t) ((_noise >> 8) & 0xFFFF) - 32768) / 32768.0f);
+}
+
+/**
+ * @brief Function to read registers
+ */
+int8_t bme68xSim::read(uint8_t reg_addr, uint8_t *reg_data, uint32_t length)
+{
+	if (_faults & BME68X_SIM_FAULT_BUS)
+	{
+		return BME68X_SIM_E_COM_FAIL;
+	}
+
+	update();
+	for (uint32_t i = 0; i < length; i++)
+	{
+		uint8_t addr = mapAddress((uint8_t) (reg_addr + i));
+		reg_data[i] = _regs[addr];
+
+		if ((addr == REG_CHIP_ID) && (_faults & BME68X_SIM_FAULT_CHIP_ID))
+		{
+			reg_data[i] = (uint8_t) ~BME68X_SIM_CHIP_ID;
+		}
+		/* new data flags are cleared once the field has been read */
+		if ((addr >= REG_FIELD0) && (addr < REG_FIELD0 + NUM_FIELDS * LEN_FIELD) && (((addr - REG_FIELD0) % LEN_FIELD) == 0))
+		{
+			_regs[addr] &= (uint8_t) ~NEW_DATA_MSK;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Function to write registers
+ */
+int8_t bme68xSim::write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length)
+{
+	if (_faults & BME68X_SIM_FAULT_BUS)
+	{
+		return BME68X_SIM_E_COM_FAIL;
+	}
+
+	update();
+	if (length)
+	{
+		writeRegister(mapAddress(reg_addr), reg_data[0]);
+	}
+	/* further registers follow as address/data pairs */
+	for (uint32_t i = 1; (i + 1) < length; i += 2)
+	{
+		writeRegister(mapAddress(reg_data[i]), reg_data[i + 1]);
+	}
+	return 0;
+}
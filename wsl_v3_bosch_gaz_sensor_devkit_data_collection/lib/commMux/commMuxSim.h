@@ -0,0 +1,151 @@
+/**
+   Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+
+   BSD-3-Clause
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+   FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+   COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+   IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+
+   @file    commMuxSim.h
+   @date    17 October 2026
+   @version 1.5.5
+
+*/
+#ifndef COMM_MUX_SIM_H
+#define COMM_MUX_SIM_H
+
+#include <stdint.h>
+
+/* Identification registers of a BME688 */
+#define BME68X_SIM_CHIP_ID             0x61
+#define BME68X_SIM_VARIANT_ID          0x01
+/* Duration of one heater step per gas_wait multiplier in parallel mode */
+#define BME68X_SIM_STEP_BASE_US        140000
+/* Return code of a simulated bus failure, same as BME68X_E_COM_FAIL */
+#define BME68X_SIM_E_COM_FAIL          -2
+
+/**
+ * Faults that can be injected into a simulated sensor, may be combined
+ */
+typedef enum {
+   BME68X_SIM_FAULT_NONE = 0x00,
+   /* every register access fails */
+   BME68X_SIM_FAULT_BUS = 0x01,
+   /* the chip id register reads a foreign device */
+   BME68X_SIM_FAULT_CHIP_ID = 0x02,
+   /* the next heater step is measured but never published */
+   BME68X_SIM_FAULT_DROP_FIELD = 0x04,
+   /* the measurement sequence stops, no new field data */
+   BME68X_SIM_FAULT_STUCK = 0x08,
+   /* gas measurements are published without the valid flag */
+   BME68X_SIM_FAULT_GAS_INVALID = 0x10
+} bme68xSimFault;
+
+/**
+ * Register level model of a BME688 on the SPI interface: memory pages, chip and unique id,
+ * calibration data, soft reset and the parallel mode field data FIFO with gas_index sequencing.
+ * It has no dependency on the Arduino core so that it also builds on the host.
+ */
+class bme68xSim
+{
+public:
+   /* monotonic time source in micro seconds */
+   typedef uint64_t (*clockFunc)(void);
+
+   /**
+    * @brief Constructor of the simulated sensor
+    */
+   bme68xSim();
+
+   /**
+    * @brief Function to power up the simulated sensor
+    * @param uniqueId : Value returned by the unique id registers
+    * @param clock    : Time source driving the measurement sequence
+    */
+   void begin(uint32_t uniqueId, clockFunc clock);
+
+   /**
+    * @brief Function to set the ambient conditions the sensor measures
+    * @param temperature : Temperature in degree Celsius
+    * @param pressure    : Pressure in Pascal
+    * @param humidity    : Relative humidity in percent
+    * @param gasResistance : Gas resistance of the first heater step in Ohm
+    */
+   void setEnvironment(float temperature, float pressure, float humidity, float gasResistance);
+
+   /**
+    * @brief Function to inject faults
+    * @param faults   : Combination of bme68xSimFault flags
+    */
+   void setFaults(uint8_t faults);
+
+   /**
+    * @brief Function to read registers, same contract as the bme68x read callback
+    * @param reg_addr : SPI register address with the read bit set
+    * @param reg_data : Buffer receiving the register data
+    * @param length   : Number of registers to read
+    * @return 0 if successful, non-zero otherwise
+    */
+   int8_t read(uint8_t reg_addr, uint8_t *reg_data, uint32_t length);
+
+   /**
+    * @brief Function to write registers, same contract as the bme68x write callback
+    * @param reg_addr : SPI register address of the first register
+    * @param reg_data : Register data, followed by address/data pairs for further registers
+    * @param length   : Number of bytes in reg_data
+    * @return 0 if successful, non-zero otherwise
+    */
+   int8_t write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length);
+
+   /**
+    * @brief Function to retrieve the number of published field data records
+    * @return Number of fields since power up
+    */
+   uint32_t getFieldCount(void) const;
+
+private:
+   clockFunc _clock;
+   uint8_t _regs[256];
+   uint32_t _uniqueId;
+   uint8_t _faults;
+   float _temperature, _pressure, _humidity, _gasResistance;
+   uint64_t _stepStartUs;
+   uint8_t _step;
+   uint8_t _measIndex;
+   uint8_t _nextField;
+   uint32_t _fieldCount;
+   uint32_t _noise;
+
+   void reset(void);
+   uint8_t mapAddress(uint8_t spiAddr) const;
+   void writeRegister(uint8_t addr, uint8_t value);
+   void update(void);
+   void publishField(uint8_t gasIndex);
+   float noise(float amplitude);
+};
+
+#endif /* COMM_MUX_SIM_H */
@@ -45,6 +45,8 @@
 #include "bsec2.h"
 
 #define FIRMWARE_VERSION 				"1.5.5"
+/* Capacity of a sample batch: 8 sensors with up to 3 fields each */
+#define SAMPLE_BATCH_SIZE				24
 
 /*!
  * @brief Enumeration for demo app mode
@@ -56,6 +58,19 @@ enum demoAppMode
 	DEMO_BLE_STREAMING_MODE
 };
 
+/*!
+ * @brief Enumeration for the start-up milestones, in boot order
+ */
+enum bootPhase
+{
+	BOOT_PHASE_STORAGE_READY,
+	BOOT_PHASE_CONFIG_LOADED,
+	BOOT_PHASE_SENSORS_INITIALIZED,
+	BOOT_PHASE_SENSORS_CONFIGURED,
+	BOOT_PHASE_FIRST_SAMPLE,
+	BOOT_PHASE_COUNT
+};
+
 /*!
  * @brief Enumeration for the demo app return code
  */
@@ -94,6 +109,9 @@ enum demoRetCode
 	
 	EDK_DATALOGGER_RTC_BEGIN_WARNING = 2,
 	EDK_DATALOGGER_RTC_ADJUST_WARNING = 3,
+	EDK_DATALOGGER_DATA_DROP_WARNING = 4,
+	
+	EDK_BSEC_STATE_RESTORE_WARNING = 5,
 	
 	EDK_BUFFER_DATA_ERROR = -21
 };
@@ -103,6 +121,7 @@ enum demoRetCode
  */
 struct bme68xHeaterProfile 
 {
+	/* in milliseconds */
 	uint64_t sleepDuration;
 	uint16_t temperature[10];
 	uint16_t duration[10];
@@ -118,6 +137,7 @@ struct bme68xSensor
 	bme68xDev device;
 	bme68xHeaterProfile heaterProfile;
 	
+	/* tick in microseconds */
 	uint64_t wakeUpTime;
 	uint32_t id;
 	bool isConfigured;
@@ -127,4 +147,37 @@ struct bme68xSensor
 	int8_t i2cMask;
 };
 
+/*!
+ * @brief Structure to hold one sample of a sensor
+ */
+struct bme68xSample
+{
+	bme68x_data data;
+	uint32_t sensorId;
+	demoRetCode code;
+	uint8_t sensorNum;
+	uint8_t mode;
+	bool hasData;
+};
+
+/*!
+ * @brief Structure to hold the samples of all sensors collected in one pass
+ */
+struct bme68xSampleBatch
+{
+	/* tick in microseconds */
+	uint64_t tickUs;
+	uint8_t count;
+	bme68xSample samples[SAMPLE_BATCH_SIZE];
+};
+
+/*!
+ * @brief Structure to hold one sample with the time stamp of its batch, as passed from acquisition to logging
+ */
+struct bme68xSampleRecord
+{
+	uint64_t tickUs;
+	bme68xSample sample;
+};
+
 #endif
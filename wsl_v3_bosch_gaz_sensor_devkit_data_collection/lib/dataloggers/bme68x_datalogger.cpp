@@ -42,6 +42,9 @@
 /* own header include */
 #include "bme68x_datalogger.h"
 #include <Esp.h>
+#include <math.h>
+#include <unistd.h>
+#include <ctype.h>
 
 /*!
  * @brief The constructor of the bme68xDataLogger class
@@ -52,36 +55,94 @@ bme68xDataLogger::bme68xDataLogger() : _fileCounter(0)
 /*!
  * @brief Function to configure the datalogger using the provided sensor config file
  */
-demoRetCode bme68xDataLogger::begin(const String& configName)
+demoRetCode bme68xDataLogger::begin(const String& configName, bme68xLogFormat format)
 {
 	demoRetCode retCode = utils::begin();
 	
 	_configName = configName;
+	_format = format;
 	if (retCode >= EDK_OK)
 	{
-		_saveDataPos = false;
+		retCode = sdWriter::begin();
+	}
+	if (retCode >= EDK_OK)
+	{
+		String openLogName;
+		size_t committedLen = 0;
+		bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS];
+		memset(journal, 0, sizeof(journal));
+		/* the writer task owns the log file while it has jobs */
+		sdWriter::sync();
+		if (_logFile)
+		{
+			closeFile();
+		}
+		{
+			commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+			File marker = SD.open(BME68X_OPEN_LOG_MARKER, FILE_READ);
+			if (marker)
+			{
+				openLogName = marker.readStringUntil('\n');
+				openLogName.trim();
+				/* missing in the markers of older firmware, then 0 */
+				committedLen = marker.readStringUntil('\n').toInt();
+				/* likewise the journal, a short read leaves unused entries */
+				(void) marker.read((uint8_t*)journal, sizeof(journal));
+				marker.close();
+			}
+		}
+		/* the previous log file was not closed, completes it before starting a new one */
+		if (openLogName.length())
+		{
+			recoverFile(openLogName, committedLen, journal);
+		}
+		loadConfig();
+		
 		retCode = createFile(_logFileName);
-		retCode = createFile(_tempLogFile);
+		_writeStatus = retCode;
 		
-		_ss.setf(std::ios::fixed, std::ios::floatfield);
+		_bufferPos = 0;
+		_bufferLen = 0;
+		_bufferCommitted = 0;
+		_endOfLine = false;
+		_endOfLineCommitted = false;
+		_encoder.reset();
+		if (_buffer == nullptr)
+		{
+			_buffer = (char*) sdWriter::acquire();
+		}
 	}
 	return retCode;
 }
 
 /*!
- * @brief Function to commit data. temp file is used to unsure the retention of the data, due to the library SD who lost all data if the file is not closed
+ * @brief Function which flushes the buffered sensor data if the flush policy requires it
  */
-unsigned long bme68xDataLogger::commitLog(unsigned long pos, String logFileName, const char* logData){
-	File logFile = SD.open(logFileName, FILE_WRITE);
-	if(!logFile){
-		return pos;
-	}
-	logFile.seek(pos);
-	logFile.print(logData);
-	unsigned long new_pos = logFile.position();
-	logFile.println(END_OF_FILE);
-	logFile.close();
-	return new_pos;
+demoRetCode bme68xDataLogger::flushIfDue(gasLabel label)
+{
+	return _commit.isDue((int)label) ? flush() : EDK_OK;
+}
+
+/*!
+ * @brief Function which sets the flush policy
+ */
+void bme68xDataLogger::setFlushPolicy(const logFlushPolicy& policy)
+{
+	logFlushPolicy bufferPolicy = policy;
+	
+	if (bufferPolicy.maxBytes > (BME68X_LOG_BUFFER_SIZE - BME68X_LOG_ROW_MAX_LEN - BME68X_LOG_SECTOR_SIZE))
+	{
+		bufferPolicy.maxBytes = BME68X_LOG_BUFFER_SIZE - BME68X_LOG_ROW_MAX_LEN - BME68X_LOG_SECTOR_SIZE;
+	}
+	_commit.setPolicy(bufferPolicy);
+}
+
+/*!
+ * @brief Function which prints the flush statistics
+ */
+void bme68xDataLogger::printFlushStats(Print& out) const
+{
+	_commit.printStats(out, "bme68x log");
 }
 
 /*!
@@ -89,74 +150,410 @@ unsigned long bme68xDataLogger::commitLog(unsigned long pos, String logFileName,
  */
 demoRetCode bme68xDataLogger::flush()
 {
-	demoRetCode retCode = EDK_OK;
-	std::string txt;
+	demoRetCode retCode = _writeStatus;
 	
-    if (_ss.rdbuf()->in_avail())
+    if ((_buffer != nullptr) && (_bufferLen > _bufferCommitted))
 	{
-		txt = _ss.str();
-		_ss.str(std::string());
+		size_t len = _bufferLen;
+		size_t sectorsLen = (len / BME68X_LOG_SECTOR_SIZE) * BME68X_LOG_SECTOR_SIZE;
+		bool rotate = ((_bufferPos + len) >= FILE_SIZE_LIMIT);
+		/* backpressure: waits for the card when all buffers are queued */
+		char* nextBuffer = (char*) sdWriter::acquire();
 		
-		if (_fileCounter)
+		if (nextBuffer == nullptr)
 		{
-			commitLog(_sensorDataPos, _logFileName, txt.c_str());
-			_sensorDataPos = commitLog(_sensorDataPos, _tempLogFile, txt.c_str());
-
-			if (_sensorDataPos >= FILE_SIZE_LIMIT)
-			{
-				_saveDataPos = false;
-				retCode = createFile(_logFileName);
-				retCode = createFile(_tempLogFile);
-			}
+			/* the rows since the last flush are lost, the file stays consistent */
+			sdWriter::drop(len - _bufferCommitted);
+			_commit.committed(0);
+			_bufferLen = _bufferCommitted;
+			/* without the dropped rows, the next row may again be the first of the data block */
+			_endOfLine = _endOfLineCommitted;
+			/* the dropped records may have opened the block or updated the encoder state */
+			_encoder.reset();
+			return EDK_DATALOGGER_DATA_DROP_WARNING;
+		}
+		_commit.committed(len - _bufferCommitted);
+		
+		sdWriteJob job;
+		job.write = writeJob;
+		job.context = this;
+		job.data = (uint8_t*) _buffer;
+		job.len = len;
+		job.offset = _bufferPos;
+		job.flags = rotate ? BME68X_WRITE_ROTATE : 0;
+		
+		if (rotate)
+		{
+			/* the rows from here go to the next file */
+			_bufferPos = 0;
+			_bufferLen = 0;
+			_endOfLine = false;
+			_encoder.reset();
 		}
 		else
 		{
-			retCode = EDK_DATALOGGER_LOG_FILE_ERROR;
+			/* the partial last sector is written again with the next rows, so that each write starts on a sector boundary */
+			memcpy(nextBuffer, &_buffer[sectorsLen], len - sectorsLen);
+			_bufferPos += sectorsLen;
+			_bufferLen = len - sectorsLen;
 		}
+		_bufferCommitted = _bufferLen;
+		_endOfLineCommitted = _endOfLine;
+		sdWriter::submit(job);
+		_buffer = nextBuffer;
 	}
 	return retCode;
 }
 
+/*!
+ * @brief Function which writes a buffer to the log file, in the SD writer task
+ */
+void bme68xDataLogger::writeJob(const sdWriteJob& job)
+{
+	bme68xDataLogger* logger = (bme68xDataLogger*) job.context;
+	
+	if (!logger->_logFile)
+	{
+		logger->_writeStatus = EDK_DATALOGGER_LOG_FILE_ERROR;
+		return;
+	}
+	
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		unsigned long pos = logger->_dataStart + job.offset;
+		logger->preallocate(pos + job.len);
+		logger->_logFile.seek(pos);
+		logger->_logFile.write(job.data, job.len);
+		/* the rows survive a power loss */
+		logger->_logFile.flush();
+		logger->_sensorDataPos = pos + job.len;
+		logger->recordCommit(pos, utils::crc32(job.data, job.len));
+	}
+	
+	if (job.flags & BME68X_WRITE_ROTATE)
+	{
+		logger->closeFile();
+		logger->_writeStatus = logger->createFile(logger->_logFileName);
+	}
+}
+
+/*!
+ * @brief Function writes the footer of the current log file and closes it
+ */
+void bme68xDataLogger::closeFile()
+{
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	if (_logFile)
+	{
+		_logFile.seek(_sensorDataPos);
+		/* binary records need no closing brackets */
+		if (_format == BME68X_LOG_FORMAT_JSON)
+		{
+			_logFile.println(END_OF_FILE);
+		}
+		size_t length = _logFile.position();
+		_logFile.close();
+		/* cuts off the preallocated space */
+		(void) ::truncate((String(BME68X_SD_MOUNT_POINT) + _logFileName).c_str(), length);
+	}
+	if (_markerFile)
+	{
+		_markerFile.close();
+	}
+	SD.remove(BME68X_OPEN_LOG_MARKER);
+}
+
+/*!
+ * @brief Function which allocates the space of the log file up to the given position
+ */
+void bme68xDataLogger::preallocate(unsigned long endPos)
+{
+	if (endPos > _allocEnd)
+	{
+		unsigned long allocEnd = ((endPos + BME68X_LOG_PREALLOC_SIZE - 1) / BME68X_LOG_PREALLOC_SIZE) * BME68X_LOG_PREALLOC_SIZE;
+		/* seeking past the end of a file open for writing allocates the clusters in one go, mostly contiguous;
+		   on a full card the writes allocate as they go */
+		if (_logFile.seek(allocEnd))
+		{
+			_allocEnd = allocEnd;
+		}
+	}
+}
+
+/*!
+ * @brief Function which records the committed length of the log file in the open log marker
+ */
+void bme68xDataLogger::recordLength()
+{
+	if (_markerFile)
+	{
+		char length[BME68X_LOG_LENGTH_DIGITS + 1];
+		snprintf(length, sizeof(length), "%0*lu", BME68X_LOG_LENGTH_DIGITS, _sensorDataPos);
+		_markerFile.seek(_markerLengthPos);
+		_markerFile.write((const uint8_t*)length, BME68X_LOG_LENGTH_DIGITS);
+		_markerFile.flush();
+	}
+}
+
+/*!
+ * @brief Function which records a write of the log file and the committed length in the open log marker
+ */
+void bme68xDataLogger::recordCommit(unsigned long start, uint32_t crc)
+{
+	if (_markerFile)
+	{
+		bme68xJournalEntry entry;
+		entry.seq = ++_journalSeq;
+		entry.start = start;
+		entry.end = _sensorDataPos;
+		entry.crc = crc;
+		/* the journal and the length share the first sector of the marker, both are written by its flush */
+		_markerFile.seek(_journalPos + (entry.seq % BME68X_LOG_JOURNAL_SLOTS) * sizeof(entry));
+		_markerFile.write((const uint8_t*)&entry, sizeof(entry));
+	}
+	recordLength();
+}
+
+/*!
+ * @brief Function which reads the log file being recovered
+ */
+size_t bme68xDataLogger::readLogFile(void* context, size_t pos, uint8_t* data, size_t len)
+{
+	File* file = (File*)context;
+	return file->seek(pos) ? file->read(data, len) : 0;
+}
+
+/*!
+ * @brief Function completes the log file left open by a power loss
+ */
+void bme68xDataLogger::recoverFile(const String& fileName, size_t committedLen, const bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS])
+{
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	File file = SD.open(fileName, FILE_READ);
+	size_t fileSize = file ? file.size() : 0;
+	size_t size = file ? logRecovery::committedLength(readLogFile, &file, journal, committedLen, fileSize) : 0;
+	size_t validSize = size;
+	bool addFooter = false;
+	
+	/* a .bmerawz file only needs the cut to the committed length, which ends on a whole record */
+	if (file && fileName.endsWith(BME68X_RAWBIN_FILE_EXT))
+	{
+		validSize = logRecovery::cutBinary(readLogFile, &file, size);
+	}
+	else if (file && fileName.endsWith(BME68X_RAWDATA_FILE_EXT))
+	{
+		validSize = logRecovery::cutJson(readLogFile, &file, size, addFooter);
+	}
+	if (file)
+	{
+		file.close();
+	}
+	
+	if (validSize < fileSize)
+	{
+		(void) ::truncate((String(BME68X_SD_MOUNT_POINT) + fileName).c_str(), validSize);
+	}
+	if (addFooter)
+	{
+		File logFile = SD.open(fileName, FILE_APPEND);
+		if (logFile)
+		{
+			logFile.println(END_OF_FILE);
+			logFile.close();
+		}
+	}
+	SD.remove(BME68X_OPEN_LOG_MARKER);
+}
+
 /*!
  * @brief Function writes the sensor data to the current log file
  */
 demoRetCode bme68xDataLogger::writeSensorData(const uint8_t* num, const uint32_t* sensorId, const uint8_t* sensorMode, const bme68x_data* bme68xData, gasLabel label, demoRetCode code)
 {
-	demoRetCode retCode = EDK_OK;
-    uint32_t rtcTsp = utils::getRtc().now().unixtime();
-    uint32_t timeSincePowerOn = millis();
-	if (_endOfLine)
+    uint32_t rtcTsp = utils::getUnixTime();
+    uint64_t timeSincePowerOn = utils::getTickMs();
+	
+	writeRow(num, sensorId, sensorMode, bme68xData, label, code, timeSincePowerOn, rtcTsp);
+    return EDK_OK;
+}
+
+/*!
+ * @brief Function writes all samples of a batch to the current log file
+ */
+demoRetCode bme68xDataLogger::writeBatch(const bme68xSampleBatch& batch, gasLabel label)
+{
+	/* one clock read for the whole batch */
+    uint32_t rtcTsp = utils::getUnixTime();
+	
+	for (uint8_t i = 0; i < batch.count; i++)
 	{
-		_ss << ",\n";
+		const bme68xSample& sample = batch.samples[i];
+		writeRow(&sample.sensorNum, &sample.sensorId, &sample.mode, sample.hasData ? &sample.data : nullptr,
+															label, sample.code, batch.tickUs / 1000, rtcTsp);
 	}
+    return EDK_OK;
+}
+
+/*!
+ * @brief Function formats one data row with the provided time stamps
+ */
+void bme68xDataLogger::writeRow(const uint8_t* num, const uint32_t* sensorId, const uint8_t* sensorMode, const bme68x_data* bme68xData,
+										gasLabel label, demoRetCode code, uint64_t timeSincePowerOn, uint32_t rtcTsp)
+{
+	/* commits the buffered rows early rather than dropping the new one, and before a label change */
+	if (((BME68X_LOG_BUFFER_SIZE - _bufferLen) < BME68X_LOG_ROW_MAX_LEN) || _commit.isDue((int)label))
+	{
+		(void) flush();
+	}
+	/* the datalogger did not start */
+	if (_buffer == nullptr)
+	{
+		return;
+	}
+	size_t rowStart = _bufferLen;
+	bme68xRawBinRecord record;
 	
-	_ss << "\t\t[";
-	(num != nullptr) ? (_ss << (int)*num) : (_ss << "null");
-	_ss << ",";
-	(sensorId != nullptr) ? (_ss << (int)*sensorId) : (_ss << "null");
-	_ss << ",";
-	_ss << timeSincePowerOn;
-	_ss << ",";
-	_ss << rtcTsp;
-	_ss << ",";
-	(bme68xData != nullptr) ? (_ss << bme68xData->temperature) : (_ss << "null");
-	_ss << ",";
-	(bme68xData != nullptr) ? (_ss << (bme68xData->pressure * .01f)) : (_ss << "null");
-	_ss << ",";
-	(bme68xData != nullptr) ? (_ss << bme68xData->humidity) : (_ss << "null");
-	_ss << ",";
-	(bme68xData != nullptr) ? (_ss << bme68xData->gas_resistance) : (_ss << "null");
-	_ss << ",";
-	(bme68xData != nullptr) ? (_ss << (int)bme68xData->gas_index) : (_ss << "null");
-	_ss << ",";
-	(sensorMode != nullptr) ? (_ss << (int)(*sensorMode == BME68X_PARALLEL_MODE)) : (_ss << "null");
-	_ss << ",";
-	_ss << (int)label;
-	_ss << ",";
-	_ss << (int)code;
-	_ss << "]";
+	makeRecord(record, num, sensorId, sensorMode, bme68xData, label, code, timeSincePowerOn, rtcTsp);
+	if (_format != BME68X_LOG_FORMAT_JSON)
+	{
+		writeRecord(record, timeSincePowerOn);
+	}
+	else
+	{
+		writeText(record, timeSincePowerOn);
+	}
+	_commit.add(_bufferLen - rowStart, (int)label);
+}
+
+/*!
+ * @brief Function fills the binary record of one data row
+ */
+void bme68xDataLogger::makeRecord(bme68xRawBinRecord& record, const uint8_t* num, const uint32_t* sensorId, const uint8_t* sensorMode,
+								  const bme68x_data* bme68xData, gasLabel label, demoRetCode code, uint64_t timeSincePowerOn, uint32_t rtcTsp)
+{
+	record.timeSincePowerOn = (uint32_t)timeSincePowerOn;
+	record.rtcTsp = rtcTsp;
+	record.sensorId = (sensorId != nullptr) ? *sensorId : 0;
+	record.sensorIndex = (num != nullptr) ? *num : BME68X_RAWBIN_NULL;
+	if (bme68xData != nullptr)
+	{
+		record.temperature = bme68xData->temperature;
+		record.pressure = bme68xData->pressure * .01f;
+		record.humidity = bme68xData->humidity;
+		record.gasResistance = bme68xData->gas_resistance;
+		record.gasIndex = bme68xData->gas_index;
+	}
+	else
+	{
+		record.temperature = record.pressure = record.humidity = record.gasResistance = NAN;
+		record.gasIndex = BME68X_RAWBIN_NULL;
+	}
+	record.modeLabel = (sensorMode != nullptr) ? (uint8_t)(*sensorMode == BME68X_PARALLEL_MODE) : BME68X_RAWBIN_MODE_NULL;
+	record.modeLabel |= (uint8_t)(label << 4);
+	record.code = (int8_t)code;
+}
+
+/*!
+ * @brief This function appends the Json data row of a record
+ */
+void bme68xDataLogger::writeText(const bme68xRawBinRecord& record, uint64_t timeSincePowerOn)
+{
+	if (_endOfLine)
+	{
+		append(",\n");
+	}
+	rawRow::appendText(_buffer, _bufferLen, BME68X_LOG_BUFFER_SIZE, record, timeSincePowerOn);
 	_endOfLine = true;
-    return retCode;
+}
+
+/*!
+ * @brief Function appends a binary record, encoded in the compressed format
+ */
+void bme68xDataLogger::writeRecord(const bme68xRawBinRecord& record, uint64_t timeSincePowerOn)
+{
+	if (_format == BME68X_LOG_FORMAT_COMPRESSED)
+	{
+		_bufferLen += _encoder.encode((uint8_t*)&_buffer[_bufferLen], record, timeSincePowerOn);
+	}
+	else
+	{
+		/* the ESP32 is little endian, the record is stored as is */
+		memcpy(&_buffer[_bufferLen], &record, sizeof(record));
+		_bufferLen += sizeof(record);
+	}
+}
+
+/*!
+ * @brief Function appends a string to the log buffer
+ */
+void bme68xDataLogger::append(const char* str)
+{
+	textFormat::append(_buffer, _bufferLen, str);
+}
+
+/*!
+ * @brief Function which reads the sensor config file into the config cache
+ */
+void bme68xDataLogger::loadConfig()
+{
+	_configText = "";
+	_configCached = false;
+	if (!_configName.length())
+	{
+		/* the header starts the Json document itself */
+		_configText = "{";
+		_configCached = true;
+		return;
+	}
+	
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	File configFile = SD.open(_configName, FILE_READ);
+	if (configFile && (configFile.size() <= BME68X_CONFIG_CACHE_MAX_SIZE))
+	{
+		uint8_t chunk[BME68X_LOG_SECTOR_SIZE];
+		size_t len;
+		bool inString = false, escaped = false;
+		
+		_configText.reserve(configFile.size());
+		while ((len = configFile.read(chunk, sizeof(chunk))) > 0)
+		{
+			for (size_t i = 0; i < len; i++)
+			{
+				char c = (char)chunk[i];
+				/* the white space outside of the strings is dropped */
+				if (inString)
+				{
+					inString = escaped || (c != '"');
+					escaped = !escaped && (c == '\\');
+				}
+				else if (isspace((unsigned char)c))
+				{
+					continue;
+				}
+				else
+				{
+					inString = (c == '"');
+				}
+				_configText += c;
+			}
+		}
+		/* the log header continues the Json document after the config members */
+		int end = _configText.lastIndexOf('}');
+		if (end > 0)
+		{
+			_configText.remove(end);
+			_configText += ',';
+			_configCached = true;
+		}
+		else
+		{
+			_configText = "";
+		}
+	}
+	if (configFile)
+	{
+		configFile.close();
+	}
 }
 
 /*!
@@ -168,11 +565,43 @@ demoRetCode bme68xDataLogger::createFile(String &fileName)
 	String macStr = utils::getMacAddress();
     String logFileBaseName = "_Board_" + macStr + "_PowerOnOff_1_";
 	
-    fileName = "/" + utils::getDateTime() + logFileBaseName + utils::getFileSeed() + "_File_" + String(_fileCounter) + BME68X_RAWDATA_FILE_EXT;             
+    fileName = "/" + utils::getDateTime() + logFileBaseName + utils::getFileSeed() + "_File_" + String(_fileCounter) + 
+			   ((_format == BME68X_LOG_FORMAT_BINARY) ? BME68X_RAWBIN_FILE_EXT :
+			   (_format == BME68X_LOG_FORMAT_COMPRESSED) ? BME68X_RAWZ_FILE_EXT : BME68X_RAWDATA_FILE_EXT);
 
-	File configFile = SD.open(_configName, FILE_READ);
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	/* a config file too large for the cache is copied line by line */
+	bool streamConfig = !_configCached;
+	File configFile;
+	if (streamConfig)
+	{
+		configFile = SD.open(_configName, FILE_READ);
+	}
 	File file = SD.open(fileName, FILE_WRITE);
-    if (_configName.length() && !configFile)
+	if (file)
+	{
+		_markerFile = SD.open(BME68X_OPEN_LOG_MARKER, FILE_WRITE);
+		if (_markerFile)
+		{
+			_markerFile.println(fileName);
+			/* the committed length, 0 until the header is written */
+			_markerLengthPos = _markerFile.position();
+			for (uint8_t i = 0; i < BME68X_LOG_LENGTH_DIGITS; i++)
+			{
+				_markerFile.write((uint8_t)'0');
+			}
+			_markerFile.println();
+			/* the journal of the writes, no entries yet */
+			_journalPos = _markerFile.position();
+			_journalSeq = 0;
+			for (size_t i = 0; i < BME68X_LOG_JOURNAL_SLOTS * sizeof(bme68xJournalEntry); i++)
+			{
+				_markerFile.write((uint8_t)0);
+			}
+			_markerFile.flush();
+		}
+	}
+    if (streamConfig && !configFile)
 	{
 		retCode = EDK_DATALOGGER_SENSOR_CONFIG_FILE_ERROR;
 	}
@@ -182,7 +611,25 @@ demoRetCode bme68xDataLogger::createFile(String &fileName)
 	}
 	else
 	{
-		if (_configName.length())
+		/* the header is collected and written in chunks */
+		logHeaderWriter header(file);
+		bme68xRawBinHeader binHeader;
+		if (_format != BME68X_LOG_FORMAT_JSON)
+		{
+			bool compressed = (_format == BME68X_LOG_FORMAT_COMPRESSED);
+			/* the data offset is known once the Json header is written */
+			memcpy(binHeader.magic, compressed ? BME68X_RAWZ_MAGIC : BME68X_RAWBIN_MAGIC, sizeof(binHeader.magic));
+			binHeader.version = compressed ? BME68X_RAWZ_VERSION : BME68X_RAWBIN_VERSION;
+			binHeader.recordSize = compressed ? 0 : sizeof(bme68xRawBinRecord);
+			binHeader.dataOffset = 0;
+			header.write((const uint8_t*)&binHeader, sizeof(binHeader));
+		}
+		
+		if (!streamConfig)
+		{
+			header.println(_configText);
+		}
+		else
 		{
 			String lineBuffer;
 			/* read in each line from the config file and copy it to the log file */
@@ -192,123 +639,90 @@ demoRetCode bme68xDataLogger::createFile(String &fileName)
 				/* skip the last closing curly bracket of the JSON document */
 				if (lineBuffer == "}")
 				{
-					file.println("\t,");
+					header.println("\t,");
 					break;
 				}
-				file.println(lineBuffer);
+				header.println(lineBuffer);
 			}
 			configFile.close();
 		}
-		else
-		{
-			file.println("{");
-		}
 
 		/* write data header / skeleton */
 		/* raw data header */
-		file.println("    \"rawDataHeader\":");		
-		file.println("\t{");
-		file.println("\t    \"counterPowerOnOff\": 1,");
-		file.println("\t    \"seedPowerOnOff\": \"" + utils::getFileSeed() + "\",");
-		file.println("\t    \"counterFileLimit\": " + String(_fileCounter) + ",");
-		file.println("\t    \"dateCreated\": \"" + String(utils::getRtc().now().unixtime()) + "\",");
-		file.println("\t    \"dateCreated_ISO\": \"" + utils::getRtc().now().timestamp() + "+00:00\",");
-		file.println("\t    \"firmwareVersion\": \"" + String(FIRMWARE_VERSION) + "\",");
-		file.println("\t    \"boardId\": \"" + macStr + "\"");
-		file.println("\t},");
-		file.println("    \"rawDataBody\":");
-		file.println("\t{");
-		file.println("\t    \"dataColumns\": [");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Sensor Index\",");
-		file.println("\t\t    \"unit\": \"\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"sensor_index\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Sensor ID\",");
-		file.println("\t\t    \"unit\": \"\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"sensorId\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Time Since PowerOn\",");
-		file.println("\t\t    \"unit\": \"Milliseconds\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"timestamp_since_poweron\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Real time clock\",");
-		file.println("\t\t    \"unit\": \"Unix Timestamp: seconds since Jan 01 1970. (UTC); 0 = missing\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"real_time_clock\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Temperature\",");
-		file.println("\t\t    \"unit\": \"DegreesClecius\",");
-		file.println("\t\t    \"format\": \"float\",");
-		file.println("\t\t    \"key\": \"temperature\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Pressure\",");
-		file.println("\t\t    \"unit\": \"Hectopascals\",");
-		file.println("\t\t    \"format\": \"float\",");
-		file.println("\t\t    \"key\": \"pressure\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Relative Humidity\",");
-		file.println("\t\t    \"unit\": \"Percent\",");
-		file.println("\t\t    \"format\": \"float\",");
-		file.println("\t\t    \"key\": \"relative_humidity\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Resistance Gassensor\",");
-		file.println("\t\t    \"unit\": \"Ohms\",");
-		file.println("\t\t    \"format\": \"float\",");
-		file.println("\t\t    \"key\": \"resistance_gassensor\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Heater Profile Step Index\",");
-		file.println("\t\t    \"unit\": \"\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"heater_profile_step_index\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Scanning enabled\",");
-		file.println("\t\t    \"unit\": \"\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"scanning_enabled\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Label Tag\",");
-		file.println("\t\t    \"unit\": \"\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"label_tag\"");
-		file.println("\t\t},");
-		file.println("\t\t{");
-		file.println("\t\t    \"name\": \"Error Code\",");
-		file.println("\t\t    \"unit\": \"\",");
-		file.println("\t\t    \"format\": \"integer\",");
-		file.println("\t\t    \"key\": \"error_code\"");
-		file.println("\t\t}");
-		file.println("\t    ],");
+		header.println("    \"rawDataHeader\":");		
+		header.println("\t{");
+		header.println("\t    \"counterPowerOnOff\": 1,");
+		header.print("\t    \"seedPowerOnOff\": \"");
+		header.print(utils::getFileSeed());
+		header.println("\",");
+		header.print("\t    \"counterFileLimit\": ");
+		header.print(_fileCounter);
+		header.println(",");
+		header.print("\t    \"dateCreated\": \"");
+		header.print(utils::getUnixTime());
+		header.println("\",");
+		header.print("\t    \"dateCreated_ISO\": \"");
+		header.print(DateTime(utils::getUnixTime()).timestamp());
+		header.println("+00:00\",");
+		header.println("\t    \"firmwareVersion\": \"" FIRMWARE_VERSION "\",");
+		header.print("\t    \"boardId\": \"");
+		header.print(macStr);
+		header.println("\",");
+		/* completion time of each boot phase in ms since power on, 0 if not reached when the file was created */
+		header.println("\t    \"bootPhasesMs\":");
+		header.println("\t    {");
+		for (uint8_t phase = 0; phase < BOOT_PHASE_COUNT; phase++)
+		{
+			header.print("\t\t\"");
+			header.print(utils::getBootPhaseName((bootPhase) phase));
+			header.print("\": ");
+			header.print(utils::getBootPhase((bootPhase) phase));
+			header.println((phase + 1 < BOOT_PHASE_COUNT) ? "," : "");
+		}
+		header.println("\t    }");
+		header.println("\t},");
+		header.println("    \"rawDataBody\":");
+		header.println("\t{");
+		logSchema::writeColumns(header, bme68xLogColumns, BME68X_LOG_COLUMN_COUNT);
 		
 		/* data block */
-		file.println("\t    \"dataBlock\": [");
-		/* save position in file, where to write the first data set */
-		if(_saveDataPos) _sensorDataPos = file.position();
-		else _saveDataPos = true;
-		file.println("\t    ]");
-		file.println("\t}");
-		file.println("}");
-
-		// Serial.print("Position : ");
-		// Serial.println(_sensorDataPos);
-		
-		/* close log file */
-		file.close();
+		const char* dataBlockLine = "\t    \"dataBlock\": [";
+		if (_format == BME68X_LOG_FORMAT_JSON)
+		{
+			/* blank padding, the first row starts on a sector boundary; println ends the line with "\r\n" */
+			size_t lineEnd = header.position() + strlen(dataBlockLine) + 2;
+			while (lineEnd++ % BME68X_LOG_SECTOR_SIZE)
+			{
+				header.write((uint8_t)' ');
+			}
+		}
+		header.println(dataBlockLine);
+		if (_format != BME68X_LOG_FORMAT_JSON)
+		{
+			header.println("\t    ]");
+			header.println("\t}");
+			header.println("}");
+			/* zero padding up to the first record */
+			while (header.position() % BME68X_LOG_SECTOR_SIZE)
+			{
+				header.write((uint8_t)0);
+			}
+			header.flush();
+			binHeader.dataOffset = header.position();
+			file.seek(0);
+			file.write((const uint8_t*)&binHeader, sizeof(binHeader));
+			file.seek(binHeader.dataOffset);
+		}
+		header.flush();
+		/* the rows are appended from here, the footer is written when the file is closed */
+		file.flush();
+		_sensorDataPos = file.position();
+		_dataStart = _sensorDataPos;
+		_allocEnd = _sensorDataPos;
+		_logFile = file;
+		preallocate(_sensorDataPos + 1);
+		recordLength();
 		
-		_endOfLine = false;
 		++_fileCounter;
 	}
     return retCode;
@@ -49,7 +49,49 @@
 #include "utils.h"
 #include "demo_app.h"
 #include "label_provider.h"
-#include <sstream>
+#include "group_commit.h"
+#include "sd_writer.h"
+#include "log_schema.h"
+#include "raw_record.h"
+#include "log_recovery.h"
+#include "sample_encoder.h"
+#include "raw_row.h"
+
+/* Capacity of the log buffer, a buffer of the SD writer, and the space kept free for one more row */
+#define BME68X_LOG_BUFFER_SIZE 			SD_WRITER_BUFFER_SIZE
+#define BME68X_LOG_ROW_MAX_LEN 			384
+/* Writes start on a sector boundary of the log file, the partial last sector stays in the buffer */
+#define BME68X_LOG_SECTOR_SIZE 			512
+/* Log files grow by this many bytes at once, the unused end is cut off when the file is closed */
+#define BME68X_LOG_PREALLOC_SIZE 		UINT32_C(4194304)
+/* Digits of the committed length recorded in the open log marker */
+#define BME68X_LOG_LENGTH_DIGITS 		10
+/* Sensor config files up to this size are kept in RAM for the log file headers, larger ones are copied from the card */
+#define BME68X_CONFIG_CACHE_MAX_SIZE 	8192
+/* Write job flag: the log file is rotated once the job is written */
+#define BME68X_WRITE_ROTATE 			UINT32_C(0x01)
+
+/* Remembers the name, committed length and write journal of the log file being written, until its footer is written */
+#define BME68X_OPEN_LOG_MARKER 			"/bme68xOpenLog"
+/* Mount point of the SD card in the virtual file system */
+#define BME68X_SD_MOUNT_POINT 			"/sd"
+
+/*!
+ * @brief Enumeration for the raw data log file format
+ */
+enum bme68xLogFormat
+{
+	/* .bmerawdata, Json text */
+	BME68X_LOG_FORMAT_JSON,
+	/* .bmerawbin, Json header followed by fixed size binary records */
+	BME68X_LOG_FORMAT_BINARY,
+	/* .bmerawz, Json header followed by the binary records delta and varint encoded */
+	BME68X_LOG_FORMAT_COMPRESSED
+};
+
+static_assert((RAWZ_BLOCK_SYNC_LEN + RAWZ_RECORD_MAX_LEN + 1) <= BME68X_LOG_ROW_MAX_LEN, "an encoded record fits in the space kept free for a row");
+static_assert(BME68X_LOG_COLUMN_COUNT == 12, "binary record fields follow the column schema");
+static_assert(BME68X_LOG_ROW_MAX_LEN <= LOG_RECOVERY_TAIL_SIZE, "the recovery reads the whole last row");
 
 /*!
  * @brief : Class library that holds functionality of the bme68x datalogger
@@ -57,20 +99,133 @@
 class bme68xDataLogger
 {
 private:
-	String _configName, _logFileName, _tempLogFile;
-	std::stringstream _ss;
+	String _configName, _logFileName;
+	/* the sensor config minified, without its closing bracket, as written to the log file headers */
+	String _configText;
+	bool _configCached = false;
+	/* owned by the SD writer task once started: the log file stays open, new rows are appended */
+	File _logFile;
+	/* the open log marker stays open, the committed length is updated on each flush */
+	File _markerFile;
+	size_t _markerLengthPos = 0;
+	size_t _journalPos = 0;
+	uint32_t _journalSeq = 0;
+	/* file position of the first row, sector aligned */
+	unsigned long _dataStart = 0;
+	/* end of the space allocated to the log file */
+	unsigned long _allocEnd = 0;
 	unsigned long _sensorDataPos = 0;
     int _fileCounter = 0;
+	/* result of the last write job */
+	volatile demoRetCode _writeStatus = EDK_OK;
+	/* SD writer buffer being filled: rows not yet committed follow the partial sector already written */
+	char* _buffer = nullptr;
+	size_t _bufferLen = 0;
+	size_t _bufferCommitted = 0;
+	/* position of the start of the buffer in the data block, sector aligned */
+	unsigned long _bufferPos = 0;
+	/* decides when the buffered rows are committed */
+	groupCommit _commit;
+	/* encoder state of the compressed format */
+	sampleEncoder _encoder;
+	bme68xLogFormat _format = BME68X_LOG_FORMAT_JSON;
     bool _endOfLine = false;
-	bool _saveDataPos = false;
+	/* _endOfLine after the last committed row, restored with the buffer when the rows since are dropped */
+	bool _endOfLineCommitted = false;
 		
 	/*!
-	 * @brief : This function creates a bme68x datalogger output file with .bmerawdata extension
+	 * @brief : This function reads the sensor config file into the config cache, unless it is too large
+	 */
+	void loadConfig();
+	
+	/*!
+	 * @brief : This function creates a bme68x datalogger output file with .bmerawdata, .bmerawbin or .bmerawz extension
 	 * 
      * @return  bosch error code
 	 */
 	demoRetCode createFile(String &fileName);
-	unsigned long commitLog(unsigned long pos, String logFileName, const char* logData);
+	
+	/*!
+	 * @brief : This function writes a buffer to the log file, it runs in the SD writer task
+	 * 
+	 * @param[in] job : write job, its offset is the position in the data block
+	 */
+	static void writeJob(const sdWriteJob& job);
+	
+	/*!
+	 * @brief : This function writes the footer of the current log file, cuts off the preallocated space and closes it
+	 */
+	void closeFile();
+	
+	/*!
+	 * @brief : This function allocates the space of the log file up to the given position, in steps of
+	 *			BME68X_LOG_PREALLOC_SIZE, so that the flushes do not allocate clusters
+	 * 
+	 * @param[in] endPos : end position of the next write
+	 */
+	void preallocate(unsigned long endPos);
+	
+	/*!
+	 * @brief : This function records the committed length of the log file in the open log marker
+	 */
+	void recordLength();
+	
+	/*!
+	 * @brief : This function records a write of the log file and the committed length in the open log marker
+	 * 
+	 * @param[in] start : file position of the written bytes
+	 * @param[in] crc 	: CRC-32 of the written bytes
+	 */
+	void recordCommit(unsigned long start, uint32_t crc);
+	
+	/*!
+	 * @brief : This function reads the log file being recovered, for the logRecovery
+	 * 
+	 * @param[in] context 	: log file, a File
+	 * @param[in] pos 		: file position
+	 * @param[out] data 	: read bytes
+	 * @param[in] len 		: bytes to read
+	 * 
+	 * @return  bytes read
+	 */
+	static size_t readLogFile(void* context, size_t pos, uint8_t* data, size_t len);
+	
+	/*!
+	 * @brief : This function completes the log file left open by a power loss: the preallocated space, a torn
+	 *			last write and the incomplete last row or record are cut off and the footer is written
+	 * 
+	 * @param[in] fileName 		: log file name
+	 * @param[in] committedLen 	: committed length recorded in the open log marker, ignored if 0
+	 * @param[in] journal 		: journal entries read from the open log marker
+	 */
+	void recoverFile(const String& fileName, size_t committedLen, const bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS]);
+	
+	/*!
+	 * @brief : This function appends text to the log buffer, the caller ensures the space
+	 */
+	void append(const char* str);
+	
+	/*!
+	 * @brief : This function formats one data row with the provided time stamps
+	 */
+	void writeRow(const uint8_t* num, const uint32_t* sensorId, const uint8_t* sensorMode, const bme68x_data* bme68xData,
+										gasLabel label, demoRetCode code, uint64_t timeSincePowerOn, uint32_t rtcTsp);
+	
+	/*!
+	 * @brief : This function fills the binary record of one data row, all formats are written from it
+	 */
+	static void makeRecord(bme68xRawBinRecord& record, const uint8_t* num, const uint32_t* sensorId, const uint8_t* sensorMode,
+						   const bme68x_data* bme68xData, gasLabel label, demoRetCode code, uint64_t timeSincePowerOn, uint32_t rtcTsp);
+	
+	/*!
+	 * @brief : This function appends the Json data row of a record
+	 */
+	void writeText(const bme68xRawBinRecord& record, uint64_t timeSincePowerOn);
+	
+	/*!
+	 * @brief : This function appends a binary record, encoded in the compressed format
+	 */
+	void writeRecord(const bme68xRawBinRecord& record, uint64_t timeSincePowerOn);
 	// demoRetCode createTempLogFile();
 public:
     /*!
@@ -83,18 +238,43 @@ public:
 	 * @brief : This function configures the datalogger using the provided sensor config file
 	 * 
 	 * @param[in] configName : sensor configuration file
+	 * @param[in] format 	 : log file format
      * 
      * @return  bosch error code
 	 */
-    demoRetCode begin(const String& configName = "");
+    demoRetCode begin(const String& configName = "", bme68xLogFormat format = BME68X_LOG_FORMAT_JSON);
 	
 	/*!
-	 * @brief : This function flushes the buffered sensor data to the current log file
+	 * @brief : This function hands the buffered sensor data to the SD writer task, which writes it to the current log file.
+	 *			The data is dropped if the card falls behind and no buffer frees up in time.
 	 * 
-     * @return  bosch error code
+     * @return  bosch error code of the last write, EDK_DATALOGGER_DATA_DROP_WARNING if data was dropped
 	 */
 	demoRetCode flush();
 	
+	/*!
+	 * @brief : This function flushes the buffered sensor data if the flush policy requires it
+	 * 
+	 * @param[in] label : current class label
+	 * 
+     * @return  bosch error code
+	 */
+	demoRetCode flushIfDue(gasLabel label);
+	
+	/*!
+	 * @brief : This function sets the flush policy, the byte threshold is limited to the log buffer capacity
+	 * 
+	 * @param[in] policy : flush policy
+	 */
+	void setFlushPolicy(const logFlushPolicy& policy);
+	
+	/*!
+	 * @brief : This function prints the flush statistics
+	 * 
+	 * @param[in] out : output stream
+	 */
+	void printFlushStats(Print& out) const;
+	
 	/*!
 	 * @brief : This function writes the sensor data to the current log file.
 	 * 
@@ -109,6 +289,16 @@ public:
 	 */
     demoRetCode writeSensorData(const uint8_t* num, const uint32_t* sensorId, const uint8_t* sensorMode, 
 												const bme68x_data* bme68xData, gasLabel label, demoRetCode code);
+	
+	/*!
+	 * @brief : This function writes all samples of a batch to the current log file, time stamped with the batch time.
+	 * 
+	 * @param[in] batch 	: samples collected by the sensor manager
+	 * @param[in] label 	: class label
+     * 
+     * @return  bosch error code
+	 */
+	demoRetCode writeBatch(const bme68xSampleBatch& batch, gasLabel label);
 };
 
 #endif
\ No newline at end of file
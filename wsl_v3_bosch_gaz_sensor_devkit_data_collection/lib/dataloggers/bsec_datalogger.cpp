@@ -60,7 +60,19 @@ demoRetCode bsecDataLogger::begin(const String& configName)
 	_bsecConfigName = configName;
 	if (retCode >= EDK_OK)
 	{
+		retCode = sdWriter::begin();
+	}
+	if (retCode >= EDK_OK)
+	{
+		/* the writer task owns the log file while it has jobs */
+		sdWriter::sync();
+		if (_logFile)
+		{
+			commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+			_logFile.close();
+		}
 		retCode = createBsecFile();
+		_writeStatus = retCode;
 	}
 	return retCode;
 }
@@ -81,6 +93,7 @@ demoRetCode bsecDataLogger::createBsecFile()
 	
 	if (retCode == EDK_OK)
 	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
 		File logFile = SD.open(_bsecFileName, FILE_WRITE);
 		if (!logFile)
 		{
@@ -89,145 +102,45 @@ demoRetCode bsecDataLogger::createBsecFile()
 		else 
 		{
 			String base64ConfigStr = base64::encode(configStr, BSEC_MAX_PROPERTY_BLOB_SIZE);
+			/* the header is collected and written in chunks */
+			logHeaderWriter header(logFile);
 			
-			logFile.println("{");
-			logFile.println("    \"bsecBase64ConfigString\": \"" + base64ConfigStr + "\",");
-			logFile.println("    \"bsecDataHeader\":");
-			logFile.println("\t{");
-			logFile.println("\t    \"counterPowerOnOff\": 1,");
-			logFile.println("\t    \"seedPowerOnOff\": \"" + utils::getFileSeed() + "\",");
-			logFile.println("\t    \"counterFileLimit\": " + String(_fileCounter) + ",");
-			logFile.println("\t    \"dateCreated\": \"" + String(utils::getRtc().now().unixtime()) + "\",");
-			logFile.println("\t    \"dateCreated_ISO\": \"" + utils::getRtc().now().timestamp() + "+00:00\",");
-			logFile.println("\t    \"firmwareVersion\": \"" + String(FIRMWARE_VERSION) + "\",");
-			logFile.println("\t    \"boardId\": \"" + macStr + "\"");
-			logFile.println("\t},");
-			logFile.println("    \"bsecDataBody\":");
-			logFile.println("\t{");
-			logFile.println("\t    \"dataColumns\": [");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Sensor Index\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"sensorIndex\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Sensor ID\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"sensorId\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Time Since PowerOn\",");
-			logFile.println("\t\t    \"unit\": \"Milliseconds\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"timeSincePowerOn\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Real time clock\",");
-			logFile.println("\t\t    \"unit\": \"Unix Timestamp: seconds since Jan 01 1970. (UTC); 0 = missing\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"realTimeClock\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Temperature\",");
-			logFile.println("\t\t    \"unit\": \"DegreesClecius\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"temperature\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Pressure\",");
-			logFile.println("\t\t    \"unit\": \"Hectopascals\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"pressure\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Relative Humidity\",");
-			logFile.println("\t\t    \"unit\": \"Percent\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"relativeHumidity\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Resistance Gassensor\",");
-			logFile.println("\t\t    \"unit\": \"Ohms\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"resistance_gassensor\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Heater Profile Step Index\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"heater_profile_step_index\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Scanning enabled\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"scanning_enabled\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Label Tag\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"label_tag\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Error Code\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"error_code\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Gas estimate 1\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"gas_estimate_1\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Gas estimate 2\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"gas_estimate_2\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Gas estimate 3\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"gas_estimate_3\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Gas estimate 4\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"gas_estimate_4\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"Gas estimate accuracy\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"gas_estimate_accuracy\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"IAQ\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"float\",");
-			logFile.println("\t\t    \"key\": \"iaq\"");
-			logFile.println("\t\t},");
-			logFile.println("\t\t{");
-			logFile.println("\t\t    \"name\": \"IAQ accuracy\",");
-			logFile.println("\t\t    \"unit\": \"\",");
-			logFile.println("\t\t    \"format\": \"integer\",");
-			logFile.println("\t\t    \"key\": \"iaqAccuracy\"");
-			logFile.println("\t\t}");
-			logFile.println("\t    ],");
+			header.println("{");
+			header.print("    \"bsecBase64ConfigString\": \"");
+			header.print(base64ConfigStr);
+			header.println("\",");
+			header.println("    \"bsecDataHeader\":");
+			header.println("\t{");
+			header.println("\t    \"counterPowerOnOff\": 1,");
+			header.print("\t    \"seedPowerOnOff\": \"");
+			header.print(utils::getFileSeed());
+			header.println("\",");
+			header.print("\t    \"counterFileLimit\": ");
+			header.print(_fileCounter);
+			header.println(",");
+			header.print("\t    \"dateCreated\": \"");
+			header.print(utils::getUnixTime());
+			header.println("\",");
+			header.print("\t    \"dateCreated_ISO\": \"");
+			header.print(DateTime(utils::getUnixTime()).timestamp());
+			header.println("+00:00\",");
+			header.println("\t    \"firmwareVersion\": \"" FIRMWARE_VERSION "\",");
+			header.print("\t    \"boardId\": \"");
+			header.print(macStr);
+			header.println("\"");
+			header.println("\t},");
+			header.println("    \"bsecDataBody\":");
+			header.println("\t{");
+			logSchema::writeColumns(header, bsecLogColumns, BSEC_LOG_COLUMN_COUNT);
 			
 			/* data block */
-			logFile.println("\t    \"dataBlock\": [");
+			header.println("\t    \"dataBlock\": [");
 			/* save position in file, where to write the first data set */
-			_bsecDataPos = logFile.position();
-			logFile.println("\t    ]");
-			logFile.println("\t}");
-			logFile.println("}");
+			_bsecDataPos = header.position();
+			header.println("\t    ]");
+			header.println("\t}");
+			header.println("}");
+			header.flush();
 			
 			/* close log file */
 			logFile.close();
@@ -244,100 +157,200 @@ demoRetCode bsecDataLogger::createBsecFile()
  */
 demoRetCode bsecDataLogger::writeBsecOutput(SensorIoData buffData[], uint8_t buffSize)
 {
-	demoRetCode retCode = EDK_OK;
-	File logFile = SD.open(_bsecFileName, FILE_WRITE);;
+	demoRetCode retCode = _writeStatus;
+	unsigned long startPos = _bsecDataPos;
 	
-	if (_fileCounter && logFile)
+	if (!_fileCounter)
+	{
+		retCode = EDK_DATALOGGER_LOG_FILE_ERROR;
+	}
+	else if (buffData == NULL)
 	{
-		if (buffData != NULL) 
+		retCode = EDK_BUFFER_DATA_ERROR;
+	}
+	else
+	{
+		/* backpressure: waits for the card when all buffers are queued */
+		uint8_t* data = sdWriter::acquire();
+		sdWriterBuffer rows(data);
+		
+		for (uint8_t j = 0; (data != nullptr) && (j < buffSize); j++)
 		{
-			/* set writing position to end of data block */
-			logFile.seek(_bsecDataPos);
+			if (rows.available() < BSEC_LOG_ROW_MAX_LEN)
+			{
+				submitRows(rows);
+				data = sdWriter::acquire();
+				if (data == nullptr)
+				{
+					break;
+				}
+				rows = sdWriterBuffer(data);
+			}
 			
-			for (uint8_t j = 0; j < buffSize; j++)
+			if (!_firstLine)
+			{
+				rows.println(",");
+			}		
+			rows.print("\t\t[");
+			/* the columns in the order of the dataColumns header */
+			for (size_t i = 0; i < BSEC_LOG_COLUMN_COUNT; i++)
 			{
-				float gasSignal[4] = {NAN, NAN, NAN, NAN}, iaqSignal = NAN; 
-				uint8_t iaqAccuracy = 0xFF, gasAccuracy = 0xFF; 
-				
-				for (uint8_t i = 0; ((buffData[j].outputs).output != nullptr) && (i < (buffData[j].outputs).nOutputs); i++) 
+				if (i)
 				{
-					const bsec_output_t& output = (buffData[j].outputs).output[i];
-					switch (output.sensor_id) 
+					rows.print(",");
+				}
+				switch (bsecLogColumns[i].field)
+				{
+					case LOG_FIELD_SENSOR_INDEX:
+						rows.print(buffData[j].sensorNum);
+					break;
+					case LOG_FIELD_SENSOR_ID:
+						rows.print(buffData[j].sensorId);
+					break;
+					case LOG_FIELD_TIME_SINCE_POWER_ON:
+						rows.print((unsigned long long)(buffData[j].tickUs / 1000));
+					break;
+					case LOG_FIELD_REAL_TIME_CLOCK:
+						rows.print(utils::getUnixTime(buffData[j].tickUs));
+					break;
+					case LOG_FIELD_TEMPERATURE:
+						rows.print(buffData[j].temperature);
+					break;
+					case LOG_FIELD_PRESSURE:
+						rows.print(buffData[j].pressure * .01f);
+					break;
+					case LOG_FIELD_HUMIDITY:
+						rows.print(buffData[j].humidity);
+					break;
+					case LOG_FIELD_GAS_RESISTANCE:
+						rows.print(buffData[j].gasResistance);
+					break;
+					case LOG_FIELD_GAS_INDEX:
+						rows.print(buffData[j].gasIndex);
+					break;
+					case LOG_FIELD_SCANNING_ENABLED:
+						rows.print(buffData[j].sensorMode == BME68X_PARALLEL_MODE);
+					break;
+					case LOG_FIELD_LABEL:
+						rows.print(buffData[j].label);
+					break;
+					case LOG_FIELD_ERROR_CODE:
+						rows.print((int)buffData[j].code);
+					break;
+					case LOG_FIELD_GAS_ESTIMATE_1:
+					case LOG_FIELD_GAS_ESTIMATE_2:
+					case LOG_FIELD_GAS_ESTIMATE_3:
+					case LOG_FIELD_GAS_ESTIMATE_4:
 					{
-						case BSEC_OUTPUT_GAS_ESTIMATE_1:
-						case BSEC_OUTPUT_GAS_ESTIMATE_2:
-						case BSEC_OUTPUT_GAS_ESTIMATE_3:
-						case BSEC_OUTPUT_GAS_ESTIMATE_4:
-							gasSignal[output.sensor_id - BSEC_OUTPUT_GAS_ESTIMATE_1] = output.signal;
-							gasAccuracy = (output.accuracy > gasAccuracy) ? gasAccuracy : output.accuracy;
-						break;
-						case BSEC_OUTPUT_IAQ:
-							iaqSignal = output.signal;
-							iaqAccuracy = output.accuracy;
-						break;
-						default:
-						break;
+						float gasEstimate = buffData[j].gasEstimate[bsecLogColumns[i].field - LOG_FIELD_GAS_ESTIMATE_1];
+						(!isnan(gasEstimate)) ? rows.print(gasEstimate) : rows.print("null");
 					}
+					break;
+					case LOG_FIELD_GAS_ESTIMATE_ACCURACY:
+						(buffData[j].gasAccuracy != 0xFF) ? rows.print(buffData[j].gasAccuracy) : rows.print("null");
+					break;
+					case LOG_FIELD_IAQ:
+						(!isnan(buffData[j].iaq)) ? rows.print(buffData[j].iaq) : rows.print("null");
+					break;
+					case LOG_FIELD_IAQ_ACCURACY:
+						(buffData[j].iaqAccuracy != 0xFF) ? rows.print(buffData[j].iaqAccuracy) : rows.print("null");
+					break;
+					default:
+						rows.print("null");
+					break;
 				}
-				
-				if (!_firstLine)
-				{
-					logFile.println(",");
-				}		
-				logFile.print("\t\t[");
-				logFile.print(buffData[j].sensorNum);
-				logFile.print(",");
-				logFile.print(buffData[j].sensorId);
-				logFile.print(",");
-				logFile.print(buffData[j].timeSincePowerOn);
-				logFile.print(",");
-				logFile.print(buffData[j].rtcTsp);
-				logFile.print(",");
-				logFile.print((buffData[j].inputData).temperature);
-				logFile.print(",");
-				logFile.print((buffData[j].inputData).pressure * .01f);
-				logFile.print(",");
-				logFile.print((buffData[j].inputData).humidity);
-				logFile.print(",");
-				logFile.print((buffData[j].inputData).gas_resistance);
-				logFile.print(",");
-				logFile.print((buffData[j].inputData).gas_index);
-				logFile.print(",");
-				logFile.print(buffData[j].sensorMode == BME68X_PARALLEL_MODE);
-				logFile.print(",");
-				logFile.print(buffData[j].label);
-				logFile.print(",");
-				logFile.print(buffData[j].code);
-				logFile.print(",");
-				(!isnan(gasSignal[0])) ? logFile.print(gasSignal[0]) : logFile.print("null");
-				logFile.print(",");
-				(!isnan(gasSignal[1])) ? logFile.print(gasSignal[1]) : logFile.print("null");
-				logFile.print(",");
-				(!isnan(gasSignal[2])) ? logFile.print(gasSignal[2]) : logFile.print("null");
-				logFile.print(",");
-				(!isnan(gasSignal[3])) ? logFile.print(gasSignal[3]) : logFile.print("null");
-				logFile.print(",");
-				(gasAccuracy != 0xFF) ? logFile.print(gasAccuracy) : logFile.print("null");
-				logFile.print(",");
-				(!isnan(iaqSignal)) ? logFile.print(iaqSignal) : logFile.print("null");
-				logFile.print(",");
-				(iaqAccuracy != 0xFF) ? logFile.print(iaqAccuracy) : logFile.print("null");
-				logFile.print("]");
-				
-				_bsecDataPos = logFile.position();
-				_firstLine = false;
 			}
-			logFile.println(END_OF_FILE);
+			rows.print("]");
+			
+			_firstLine = false;
+		}
+		
+		if (data != nullptr)
+		{
+			submitRows(rows);
 		}
 		else
 		{
-			retCode = EDK_BUFFER_DATA_ERROR;
+			/* the outputs not yet formatted are lost, the file stays consistent */
+			sdWriter::drop(0);
+			retCode = EDK_DATALOGGER_DATA_DROP_WARNING;
 		}
-		logFile.close();
 	}
-	else 
+	_commit.committed(_bsecDataPos - startPos);
+    return retCode;	
+}
+
+/*!
+ * @brief This function hands the formatted rows to the SD writer task
+ */
+void bsecDataLogger::submitRows(const sdWriterBuffer& rows)
+{
+	sdWriteJob job;
+	job.write = writeJob;
+	job.context = this;
+	job.data = rows.data();
+	job.len = rows.length();
+	job.offset = _bsecDataPos;
+	job.flags = 0;
+	
+	_bsecDataPos += rows.length();
+	sdWriter::submit(job);
+}
+
+/*!
+ * @brief This function writes the rows of a job and the footer to the log file, in the SD writer task
+ */
+void bsecDataLogger::writeJob(const sdWriteJob& job)
+{
+	bsecDataLogger* logger = (bsecDataLogger*) job.context;
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	
+	if (!logger->_logFile)
 	{
-		retCode = EDK_DATALOGGER_LOG_FILE_ERROR;
+		logger->_logFile = SD.open(logger->_bsecFileName, BSEC_LOG_FILE_UPDATE);
 	}
-    return retCode;	
+	if (!logger->_logFile)
+	{
+		logger->_writeStatus = EDK_DATALOGGER_LOG_FILE_ERROR;
+		return;
+	}
+	
+	/* the footer is overwritten by the next rows */
+	logger->_logFile.seek(job.offset);
+	logger->_logFile.write(job.data, job.len);
+	logger->_logFile.println(END_OF_FILE);
+	logger->_logFile.flush();
+}
+
+/*!
+ * @brief This function accounts one output added to the buffer of the caller
+ */
+void bsecDataLogger::addPending(gasLabel label)
+{
+	/* the size of the text row is only known once it is written, the buffered record is counted instead */
+	_commit.add(sizeof(SensorIoData), (int)label);
+}
+
+/*!
+ * @brief This function checks whether the flush policy requires writing the buffered outputs
+ */
+bool bsecDataLogger::isFlushDue(gasLabel label) const
+{
+	return _commit.isDue((int)label);
+}
+
+/*!
+ * @brief This function sets the flush policy
+ */
+void bsecDataLogger::setFlushPolicy(const logFlushPolicy& policy)
+{
+	_commit.setPolicy(policy);
+}
+
+/*!
+ * @brief This function prints the flush statistics
+ */
+void bsecDataLogger::printFlushStats(Print& out) const
+{
+	_commit.printStats(out, "bsec log");
 }
@@ -50,6 +50,16 @@
 #include "utils.h"
 #include "demo_app.h"
 #include "label_provider.h"
+#include "group_commit.h"
+#include "sd_writer.h"
+#include "log_schema.h"
+#include "bsec_record.h"
+#include "raw_record.h"
+
+/* Space kept free in a writer buffer for one more row */
+#define BSEC_LOG_ROW_MAX_LEN 			384
+/* Mode opening the log file for update, its header is kept */
+#define BSEC_LOG_FILE_UPDATE 			"r+"
 
 /*!
  * @brief Class library that holds functionality of the bsec datalogger
@@ -61,6 +71,12 @@ private:
 	unsigned long _bsecDataPos = 0;
     int _fileCounter = 0;
 	bool _firstLine = false;
+	/* owned by the SD writer task once started, opened by the first write job */
+	File _logFile;
+	/* result of the last write job */
+	volatile demoRetCode _writeStatus = EDK_OK;
+	/* decides when the buffered outputs are committed */
+	groupCommit _commit;
 	
 	/*!
 	 * @brief : This function creates a bsec output file
@@ -68,41 +84,24 @@ private:
      * @return  bosch error code
 	 */
 	demoRetCode createBsecFile();
+	
+	/*!
+	 * @brief : This function hands the formatted rows to the SD writer task and advances the data position
+	 * 
+	 * @param[in] rows : writer buffer holding the rows
+	 */
+	void submitRows(const sdWriterBuffer& rows);
+	
+	/*!
+	 * @brief : This function writes the rows of a job and the footer to the log file, it runs in the SD writer task
+	 * 
+	 * @param[in] job : write job, its offset is the file position of the rows
+	 */
+	static void writeJob(const sdWriteJob& job);
 
 public:
-/*!
- * @brief structure which comprises sensor input and output data to write into SD card
- */
-    typedef struct
-    {
-		/*! sensor number */
-    	uint8_t sensorNum;
-    
-    	/*! sensor Index */
-		uint32_t sensorId;
-    
-  		/*! sensor mode */
-		uint8_t sensorMode;
-    
-    	/*! bme68x data registers data */
-		bme68x_data inputData;
-	    
-    	/*! bsec output structure*/
-    	bsecOutputs outputs;
-    
-		/*! gas label */
-    	gasLabel label;
-	
-    	/*! return code */
-    	demoRetCode code;
-		
-		/*! time since power on */
-    	uint32_t timeSincePowerOn;
-		
-		/*! rtc time */
-		uint32_t rtcTsp; 
-		
-	} SensorIoData;
+	/* record of a bsec output, filled in place in the output ring */
+	typedef bsecOutputRecord SensorIoData;
 	
 	/*!
      * @brief :The constructor of the bsec_datalogger class
@@ -120,15 +119,46 @@ public:
     demoRetCode begin(const String& configName);
 
 	/*!
-	 * @brief : This function writes the block of bsec output to the current log file.
+	 * @brief : This function formats the block of bsec output and hands it to the SD writer task,
+	 *			which writes it to the current log file. The block is dropped if the card falls behind.
 	 * 
 	 * @param[in] buffData : array of structure SensorIoData
      * @param[in] buffSize : size of a buffer
      * 
-	 * @return bosch error code
+	 * @return bosch error code of the last write, EDK_DATALOGGER_DATA_DROP_WARNING if data was dropped
 	 */
 	
     demoRetCode writeBsecOutput(SensorIoData buffData[], uint8_t buffSize);
+	
+	/*!
+	 * @brief : This function accounts one output added to the buffer of the caller
+	 * 
+	 * @param[in] label : class label of the output
+	 */
+	void addPending(gasLabel label);
+	
+	/*!
+	 * @brief : This function checks whether the flush policy requires writing the buffered outputs
+	 * 
+	 * @param[in] label : class label of the next output, or the current label
+	 * 
+	 * @return true if the buffered outputs are to be written
+	 */
+	bool isFlushDue(gasLabel label) const;
+	
+	/*!
+	 * @brief : This function sets the flush policy
+	 * 
+	 * @param[in] policy : flush policy
+	 */
+	void setFlushPolicy(const logFlushPolicy& policy);
+	
+	/*!
+	 * @brief : This function prints the flush statistics
+	 * 
+	 * @param[in] out : output stream
+	 */
+	void printFlushStats(Print& out) const;
 };
 
 #endif
@@ -0,0 +1,221 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	bsec_record.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Record of a BSEC output, filled in place by the BSEC callback and written by the bsec datalogger
+ * 
+ * 
+ */
+
+#ifndef BSEC_RECORD_H
+#define BSEC_RECORD_H
+
+#include <stdint.h>
+#include <math.h>
+
+#ifdef ARDUINO
+#include <bsec2.h>
+#else
+/* Host stand-ins of the BSEC2 library types a record is filled from, for the host tests */
+#define BSEC_NUMBER_OUTPUTS 			18
+#define BSEC_OUTPUT_IAQ 				1
+#define BSEC_OUTPUT_GAS_ESTIMATE_1 		22
+#define BSEC_OUTPUT_GAS_ESTIMATE_2 		23
+#define BSEC_OUTPUT_GAS_ESTIMATE_3 		24
+#define BSEC_OUTPUT_GAS_ESTIMATE_4 		25
+
+struct bme68x_data
+{
+	uint8_t status;
+	uint8_t gas_index;
+	uint8_t meas_index;
+	uint8_t res_heat;
+	uint8_t idac;
+	uint8_t gas_wait;
+	float temperature;
+	float pressure;
+	float humidity;
+	float gas_resistance;
+};
+
+struct bsec_output_t
+{
+	int64_t time_stamp;
+	float signal;
+	uint8_t signal_dimensions;
+	uint8_t sensor_id;
+	uint8_t accuracy;
+};
+
+struct bsecOutputs
+{
+	bsec_output_t output[BSEC_NUMBER_OUTPUTS];
+	uint8_t nOutputs;
+};
+#endif
+
+/*!
+ * @brief Fields of a bsec output written to the log file, only those: the BSEC callback fills them in place
+ *		  in the output ring, the logging task formats them
+ */
+struct bsecOutputRecord
+{
+	/*! sensor number */
+	uint8_t sensorNum;
+	
+	/*! sensor Index */
+	uint32_t sensorId;
+	
+	/*! sensor mode */
+	uint8_t sensorMode;
+	
+	/*! bme68x data processed by bsec, pressure in pascals */
+	float temperature;
+	float pressure;
+	float humidity;
+	float gasResistance;
+	uint8_t gasIndex;
+	
+	/*! bsec gas estimates, NaN if not an output */
+	float gasEstimate[4];
+	
+	/*! lowest accuracy of the gas estimates, 0xFF if none */
+	uint8_t gasAccuracy;
+	
+	/*! bsec iaq, NaN if not an output */
+	float iaq;
+	
+	/*! iaq accuracy, 0xFF if none */
+	uint8_t iaqAccuracy;
+	
+	/*! gas label */
+	uint8_t label;
+	
+	/*! return code */
+	int8_t code;
+	
+	/*! esp_timer time of the output, the time since power on and the RTC time are derived from it when written */
+	uint64_t tickUs;
+};
+
+/*!
+ * @brief : Class library filling the bsec output records
+ */
+class bsecRecord
+{
+public:
+	/*!
+	 * @brief : This function records the fields of a bsec output written to the log file, without the
+	 *			sensor, label, code and time stamp fields
+	 * 
+	 * @param[out] data 	: record to fill
+	 * @param[in] input 	: bme68x data processed by bsec
+	 * @param[in] outputs 	: bsec outputs
+	 */
+	static inline void setOutputs(bsecOutputRecord& data, const bme68x_data& input, const bsecOutputs& outputs)
+	{
+		data.temperature = input.temperature;
+		data.pressure = input.pressure;
+		data.humidity = input.humidity;
+		data.gasResistance = input.gas_resistance;
+		data.gasIndex = input.gas_index;
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			data.gasEstimate[i] = NAN;
+		}
+		data.gasAccuracy = 0xFF;
+		data.iaq = NAN;
+		data.iaqAccuracy = 0xFF;
+		
+		for (uint8_t i = 0; (i < outputs.nOutputs) && (i < BSEC_NUMBER_OUTPUTS); i++) 
+		{
+			const bsec_output_t& output = outputs.output[i];
+			switch (output.sensor_id) 
+			{
+				case BSEC_OUTPUT_GAS_ESTIMATE_1:
+				case BSEC_OUTPUT_GAS_ESTIMATE_2:
+				case BSEC_OUTPUT_GAS_ESTIMATE_3:
+				case BSEC_OUTPUT_GAS_ESTIMATE_4:
+					data.gasEstimate[output.sensor_id - BSEC_OUTPUT_GAS_ESTIMATE_1] = output.signal;
+					data.gasAccuracy = (output.accuracy > data.gasAccuracy) ? data.gasAccuracy : output.accuracy;
+				break;
+				case BSEC_OUTPUT_IAQ:
+					data.iaq = output.signal;
+					data.iaqAccuracy = output.accuracy;
+				break;
+				default:
+				break;
+			}
+		}
+	}
+	
+	/*!
+	 * @brief : This function fills a record in place in the output ring, the steps of the BSEC callback.
+	 *			A full ring drops the outputs, counted as overflow by the ring.
+	 * 
+	 * @param[inout] ring 	: output ring, a spscRing of bsec output records
+	 * @param[in] num 		: sensor number
+	 * @param[in] sensorId 	: sensor id
+	 * @param[in] sensorMode: sensor mode
+	 * @param[in] label 	: gas label
+	 * @param[in] code 		: return code
+	 * @param[in] tickUs 	: esp_timer time of the output
+	 * @param[in] input 	: bme68x data processed by bsec
+	 * @param[in] outputs 	: bsec outputs
+	 * 
+	 * @return true if the record was committed
+	 */
+	template <typename RING>
+	static inline bool push(RING& ring, uint8_t num, uint32_t sensorId, uint8_t sensorMode, uint8_t label, int8_t code,
+							uint64_t tickUs, const bme68x_data& input, const bsecOutputs& outputs)
+	{
+		bsecOutputRecord* data = ring.reserve();
+		if (data == nullptr)
+		{
+			return false;
+		}
+		data->sensorNum = num;
+		data->sensorId = sensorId;
+		data->sensorMode = sensorMode;
+		data->label = label;
+		data->code = code;
+		data->tickUs = tickUs;
+		setOutputs(*data, input, outputs);
+		ring.commit();
+		return true;
+	}
+};
+
+#endif
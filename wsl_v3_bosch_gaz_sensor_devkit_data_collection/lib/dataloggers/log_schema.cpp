@@ -0,0 +1,96 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	log_schema.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Column schema of the bme68x and bsec log files
+ * 
+ * 
+ */
+
+#include "log_schema.h"
+
+/*!
+ * @brief The constructor of the logHeaderWriter class
+ */
+logHeaderWriter::logHeaderWriter(File& file) : _file(file), _len(0), _position(file.position())
+{}
+
+/*!
+ * @brief This function collects one byte
+ */
+size_t logHeaderWriter::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+/*!
+ * @brief This function collects a buffer, full chunks are written to the file
+ */
+size_t logHeaderWriter::write(const uint8_t* buffer, size_t size)
+{
+	size_t written = 0;
+	
+	while (written < size)
+	{
+		size_t len = LOG_HEADER_CHUNK_SIZE - _len;
+		if (len > (size - written))
+		{
+			len = size - written;
+		}
+		memcpy(&_chunk[_len], &buffer[written], len);
+		_len += len;
+		written += len;
+		
+		if (_len == LOG_HEADER_CHUNK_SIZE)
+		{
+			flush();
+		}
+	}
+	_position += size;
+	return size;
+}
+
+/*!
+ * @brief This function writes the collected bytes to the file
+ */
+void logHeaderWriter::flush()
+{
+	if (_len)
+	{
+		_file.write(_chunk, _len);
+		_len = 0;
+	}
+}
+
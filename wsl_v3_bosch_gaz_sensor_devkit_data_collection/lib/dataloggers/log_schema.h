@@ -0,0 +1,216 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	log_schema.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Column schema of the bme68x and bsec log files
+ * 
+ * 
+ */
+
+#ifndef LOG_SCHEMA_H
+#define LOG_SCHEMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include "Arduino.h"
+#include <FS.h>
+#endif
+
+/* Size of the chunks the log file header is written in. The header starts at the beginning of the file
+ * and embeds the whole configuration file, which is streamed line by line and has no upper bound, so it
+ * is not built in one buffer: that would take a heap block of the configuration size on each rotation,
+ * or more than the 6 kB stack of the SD writer task. One chunk is one SD card sector, so each full chunk
+ * is a single aligned sector write, which FatFs passes to the card without copying it in its sector cache */
+#define LOG_HEADER_CHUNK_SIZE 			512
+
+/*!
+ * @brief Enumeration for the values a log row is made of
+ */
+enum logField
+{
+	LOG_FIELD_SENSOR_INDEX,
+	LOG_FIELD_SENSOR_ID,
+	LOG_FIELD_TIME_SINCE_POWER_ON,
+	LOG_FIELD_REAL_TIME_CLOCK,
+	LOG_FIELD_TEMPERATURE,
+	LOG_FIELD_PRESSURE,
+	LOG_FIELD_HUMIDITY,
+	LOG_FIELD_GAS_RESISTANCE,
+	LOG_FIELD_GAS_INDEX,
+	LOG_FIELD_SCANNING_ENABLED,
+	LOG_FIELD_LABEL,
+	LOG_FIELD_ERROR_CODE,
+	LOG_FIELD_GAS_ESTIMATE_1,
+	LOG_FIELD_GAS_ESTIMATE_2,
+	LOG_FIELD_GAS_ESTIMATE_3,
+	LOG_FIELD_GAS_ESTIMATE_4,
+	LOG_FIELD_GAS_ESTIMATE_ACCURACY,
+	LOG_FIELD_IAQ,
+	LOG_FIELD_IAQ_ACCURACY
+};
+
+/*!
+ * @brief Structure of a log column, as described in the dataColumns header and written in each row
+ */
+struct logColumn
+{
+	logField field;
+	const char* name;
+	const char* unit;
+	const char* format;
+	const char* key;
+};
+
+/* Columns of the .bmerawdata dataBlock rows, also the fields of a .bmerawbin record */
+constexpr logColumn bme68xLogColumns[] = {
+	{LOG_FIELD_SENSOR_INDEX, "Sensor Index", "", "integer", "sensor_index"},
+	{LOG_FIELD_SENSOR_ID, "Sensor ID", "", "integer", "sensorId"},
+	{LOG_FIELD_TIME_SINCE_POWER_ON, "Time Since PowerOn", "Milliseconds", "integer", "timestamp_since_poweron"},
+	{LOG_FIELD_REAL_TIME_CLOCK, "Real time clock", "Unix Timestamp: seconds since Jan 01 1970. (UTC); 0 = missing", "integer", "real_time_clock"},
+	{LOG_FIELD_TEMPERATURE, "Temperature", "DegreesClecius", "float", "temperature"},
+	{LOG_FIELD_PRESSURE, "Pressure", "Hectopascals", "float", "pressure"},
+	{LOG_FIELD_HUMIDITY, "Relative Humidity", "Percent", "float", "relative_humidity"},
+	{LOG_FIELD_GAS_RESISTANCE, "Resistance Gassensor", "Ohms", "float", "resistance_gassensor"},
+	{LOG_FIELD_GAS_INDEX, "Heater Profile Step Index", "", "integer", "heater_profile_step_index"},
+	{LOG_FIELD_SCANNING_ENABLED, "Scanning enabled", "", "integer", "scanning_enabled"},
+	{LOG_FIELD_LABEL, "Label Tag", "", "integer", "label_tag"},
+	{LOG_FIELD_ERROR_CODE, "Error Code", "", "integer", "error_code"}
+};
+constexpr size_t BME68X_LOG_COLUMN_COUNT = sizeof(bme68xLogColumns) / sizeof(bme68xLogColumns[0]);
+
+/* Columns of the .bsecdata dataBlock rows */
+constexpr logColumn bsecLogColumns[] = {
+	{LOG_FIELD_SENSOR_INDEX, "Sensor Index", "", "integer", "sensorIndex"},
+	{LOG_FIELD_SENSOR_ID, "Sensor ID", "", "integer", "sensorId"},
+	{LOG_FIELD_TIME_SINCE_POWER_ON, "Time Since PowerOn", "Milliseconds", "integer", "timeSincePowerOn"},
+	{LOG_FIELD_REAL_TIME_CLOCK, "Real time clock", "Unix Timestamp: seconds since Jan 01 1970. (UTC); 0 = missing", "integer", "realTimeClock"},
+	{LOG_FIELD_TEMPERATURE, "Temperature", "DegreesClecius", "float", "temperature"},
+	{LOG_FIELD_PRESSURE, "Pressure", "Hectopascals", "float", "pressure"},
+	{LOG_FIELD_HUMIDITY, "Relative Humidity", "Percent", "float", "relativeHumidity"},
+	{LOG_FIELD_GAS_RESISTANCE, "Resistance Gassensor", "Ohms", "float", "resistance_gassensor"},
+	{LOG_FIELD_GAS_INDEX, "Heater Profile Step Index", "", "integer", "heater_profile_step_index"},
+	{LOG_FIELD_SCANNING_ENABLED, "Scanning enabled", "", "integer", "scanning_enabled"},
+	{LOG_FIELD_LABEL, "Label Tag", "", "integer", "label_tag"},
+	{LOG_FIELD_ERROR_CODE, "Error Code", "", "integer", "error_code"},
+	{LOG_FIELD_GAS_ESTIMATE_1, "Gas estimate 1", "", "float", "gas_estimate_1"},
+	{LOG_FIELD_GAS_ESTIMATE_2, "Gas estimate 2", "", "float", "gas_estimate_2"},
+	{LOG_FIELD_GAS_ESTIMATE_3, "Gas estimate 3", "", "float", "gas_estimate_3"},
+	{LOG_FIELD_GAS_ESTIMATE_4, "Gas estimate 4", "", "float", "gas_estimate_4"},
+	{LOG_FIELD_GAS_ESTIMATE_ACCURACY, "Gas estimate accuracy", "", "integer", "gas_estimate_accuracy"},
+	{LOG_FIELD_IAQ, "IAQ", "", "float", "iaq"},
+	{LOG_FIELD_IAQ_ACCURACY, "IAQ accuracy", "", "integer", "iaqAccuracy"}
+};
+constexpr size_t BSEC_LOG_COLUMN_COUNT = sizeof(bsecLogColumns) / sizeof(bsecLogColumns[0]);
+
+#ifdef ARDUINO
+/*!
+ * @brief : Print adapter collecting the header of a log file in chunks, so that it is written
+ *			in a few large writes instead of one per line
+ */
+class logHeaderWriter : public Print
+{
+private:
+	File& _file;
+	uint8_t _chunk[LOG_HEADER_CHUNK_SIZE];
+	size_t _len;
+	size_t _position;
+	
+public:
+	/*!
+	 * @brief : The constructor of the logHeaderWriter class, the header starts at the current file position
+	 * 
+	 * @param[in] file : log file
+	 */
+	logHeaderWriter(File& file);
+	
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buffer, size_t size) override;
+	
+	/*!
+	 * @brief : This function writes the collected bytes to the file
+	 */
+	void flush();
+	
+	/*!
+	 * @brief : This function retrieves the file position of the next byte, including the collected bytes
+	 */
+	inline size_t position() const
+	{
+		return _position;
+	}
+};
+#endif
+
+/*!
+ * @brief : Class library that writes the dataColumns header of a log file from its column schema
+ */
+class logSchema
+{
+public:
+	/*!
+	 * @brief : This function writes the "dataColumns" member describing the given columns
+	 * 
+	 * @param[in] out 		: output stream, a Print on target
+	 * @param[in] columns 	: column schema
+	 * @param[in] count 	: number of columns
+	 */
+	template <typename OUT>
+	static void writeColumns(OUT& out, const logColumn* columns, size_t count)
+	{
+		out.println("\t    \"dataColumns\": [");
+		for (size_t i = 0; i < count; i++)
+		{
+			out.println("\t\t{");
+			out.print("\t\t    \"name\": \"");
+			out.print(columns[i].name);
+			out.println("\",");
+			out.print("\t\t    \"unit\": \"");
+			out.print(columns[i].unit);
+			out.println("\",");
+			out.print("\t\t    \"format\": \"");
+			out.print(columns[i].format);
+			out.println("\",");
+			out.print("\t\t    \"key\": \"");
+			out.print(columns[i].key);
+			out.println("\"");
+			out.println(((i + 1) < count) ? "\t\t}," : "\t\t}");
+		}
+		out.println("\t    ],");
+	}
+};
+
+#endif
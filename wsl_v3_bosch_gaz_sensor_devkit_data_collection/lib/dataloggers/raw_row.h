@@ -0,0 +1,130 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	raw_row.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Text of the .bmerawdata dataBlock rows, written from the binary record of each row
+ * 
+ * 
+ */
+
+#ifndef RAW_ROW_H
+#define RAW_ROW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "text_format.h"
+#include "log_schema.h"
+#include "raw_record.h"
+
+/*!
+ * @brief : Class library that formats the .bmerawdata dataBlock row of a binary record. The datalogger writes its
+ *			Json rows with it, and bmerawbin_convert.py prints the .bmerawbin and .bmerawz records the same way.
+ *			Free of any platform dependency, so that it also builds on the host.
+ */
+class rawRow
+{
+public:
+	/*!
+	 * @brief : This function appends the row of a record, the columns in the order of the dataColumns header.
+	 *			The caller ensures BME68X_LOG_ROW_MAX_LEN bytes of space.
+	 *
+	 * @param[inout] buffer 		: character buffer
+	 * @param[inout] len 			: running length of the buffer
+	 * @param[in] size 				: size of the buffer
+	 * @param[in] record 			: record of the row
+	 * @param[in] timeSincePowerOn 	: time since power on (ms), replaces the 32 bit one of the record
+	 */
+	static inline void appendText(char* buffer, size_t& len, size_t size, const bme68xRawBinRecord& record, uint64_t timeSincePowerOn)
+	{
+		bool hasSensor = (record.sensorIndex != BME68X_RAWBIN_NULL);
+		bool hasData = (record.gasIndex != BME68X_RAWBIN_NULL);
+		uint8_t mode = record.modeLabel & 0x0F;
+		
+		textFormat::append(buffer, len, "\t\t[");
+		for (size_t i = 0; i < BME68X_LOG_COLUMN_COUNT; i++)
+		{
+			if (i)
+			{
+				buffer[len++] = ',';
+			}
+			switch (bme68xLogColumns[i].field)
+			{
+				case LOG_FIELD_SENSOR_INDEX:
+					hasSensor ? textFormat::appendInt(buffer, len, record.sensorIndex) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_SENSOR_ID:
+					/* signed, as the .bmerawdata files always printed it */
+					hasSensor ? textFormat::appendInt(buffer, len, (int32_t)record.sensorId) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_TIME_SINCE_POWER_ON:
+					textFormat::appendUInt64(buffer, len, timeSincePowerOn);
+				break;
+				case LOG_FIELD_REAL_TIME_CLOCK:
+					textFormat::appendUInt(buffer, len, record.rtcTsp);
+				break;
+				case LOG_FIELD_TEMPERATURE:
+					hasData ? textFormat::appendFloat(buffer, len, size, record.temperature) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_PRESSURE:
+					hasData ? textFormat::appendFloat(buffer, len, size, record.pressure) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_HUMIDITY:
+					hasData ? textFormat::appendFloat(buffer, len, size, record.humidity) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_GAS_RESISTANCE:
+					hasData ? textFormat::appendFloat(buffer, len, size, record.gasResistance) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_GAS_INDEX:
+					hasData ? textFormat::appendInt(buffer, len, record.gasIndex) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_SCANNING_ENABLED:
+					(mode != BME68X_RAWBIN_MODE_NULL) ? textFormat::appendInt(buffer, len, mode) : textFormat::append(buffer, len, "null");
+				break;
+				case LOG_FIELD_LABEL:
+					textFormat::appendInt(buffer, len, record.modeLabel >> 4);
+				break;
+				case LOG_FIELD_ERROR_CODE:
+					textFormat::appendInt(buffer, len, record.code);
+				break;
+				default:
+					textFormat::append(buffer, len, "null");
+				break;
+			}
+		}
+		buffer[len++] = ']';
+	}
+};
+
+#endif /* RAW_ROW_H */
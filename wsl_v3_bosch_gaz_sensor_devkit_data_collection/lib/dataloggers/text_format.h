@@ -0,0 +1,170 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	text_format.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Allocation free number formatting of the Json log rows
+ * 
+ * 
+ */
+
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <math.h>
+
+/*!
+ * @brief : Functions appending text and numbers to a character buffer at a running length, without heap
+ *			allocation and without the locale and stream state of printf. Free of any platform dependency,
+ *			so that it also builds on the host. The caller ensures the space.
+ */
+class textFormat
+{
+public:
+	/*!
+	 * @brief : This function appends a string
+	 *
+	 * @param[inout] buffer : character buffer
+	 * @param[inout] len 	: running length of the buffer
+	 * @param[in] str 		: zero terminated string
+	 */
+	static inline void append(char* buffer, size_t& len, const char* str)
+	{
+		while (*str)
+		{
+			buffer[len++] = *str++;
+		}
+	}
+	
+	/*!
+	 * @brief : This function appends an unsigned integer in decimal
+	 */
+	static inline void appendUInt(char* buffer, size_t& len, uint32_t value)
+	{
+		char digits[10];
+		uint8_t nbDigits = 0;
+		
+		do
+		{
+			digits[nbDigits++] = '0' + (value % 10);
+			value /= 10;
+		} while (value);
+		
+		while (nbDigits)
+		{
+			buffer[len++] = digits[--nbDigits];
+		}
+	}
+	
+	/*!
+	 * @brief : This function appends a 64 bit unsigned integer in decimal, the 32 bit divisions below 2^32
+	 */
+	static inline void appendUInt64(char* buffer, size_t& len, uint64_t value)
+	{
+		if (value <= UINT32_MAX)
+		{
+			appendUInt(buffer, len, (uint32_t)value);
+			return;
+		}
+		
+		char digits[20];
+		uint8_t nbDigits = 0;
+		
+		do
+		{
+			digits[nbDigits++] = '0' + (value % 10);
+			value /= 10;
+		} while (value);
+		
+		while (nbDigits)
+		{
+			buffer[len++] = digits[--nbDigits];
+		}
+	}
+	
+	/*!
+	 * @brief : This function appends a signed integer in decimal
+	 */
+	static inline void appendInt(char* buffer, size_t& len, int32_t value)
+	{
+		if (value < 0)
+		{
+			buffer[len++] = '-';
+			/* unsigned negation also covers INT32_MIN */
+			appendUInt(buffer, len, 0u - (uint32_t)value);
+		}
+		else
+		{
+			appendUInt(buffer, len, (uint32_t)value);
+		}
+	}
+	
+	/*!
+	 * @brief : This function appends a float with 6 decimals, same text as printf("%.6f")
+	 *
+	 * @param[inout] buffer : character buffer
+	 * @param[inout] len 	: running length of the buffer
+	 * @param[in] size 		: size of the buffer, bounds the slow path
+	 * @param[in] value 	: value to append
+	 */
+	static inline void appendFloat(char* buffer, size_t& len, size_t size, float value)
+	{
+		/* below 1e9 the value times 1e6 is exact in a double (24 + 14 significant bits), rounding it to an
+		   integer with ties to even gives the digits printf prints; anything else takes the slow path */
+		if (!isfinite(value) || (fabsf(value) >= 1e9f))
+		{
+			len += snprintf(&buffer[len], size - len, "%.6f", (double)value);
+			return;
+		}
+		
+		if (signbit(value))
+		{
+			buffer[len++] = '-';
+		}
+		uint64_t scaled = (uint64_t)nearbyint(fabs((double)value) * 1e6);
+		uint32_t fraction = (uint32_t)(scaled % 1000000);
+		
+		appendUInt(buffer, len, (uint32_t)(scaled / 1000000));
+		buffer[len++] = '.';
+		for (uint32_t div = 100000; div; div /= 10)
+		{
+			buffer[len++] = '0' + (fraction / div) % 10;
+		}
+	}
+};
+
+#endif /* TEXT_FORMAT_H */
@@ -0,0 +1,270 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	bsec_manager.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	BSEC manager, running one BSEC instance per sensor
+ * 
+ * 
+ */
+
+#include "bsec_manager.h"
+#include "utils.h"
+
+uint8_t 		bsecManager::_arena[NUM_BME68X_UNITS][BSEC_INSTANCE_SIZE];
+
+/* gas estimates of the scanning mode and the signals they are computed from */
+static bsecSensor bsecSubscription[] = {
+	BSEC_OUTPUT_GAS_ESTIMATE_1,
+	BSEC_OUTPUT_GAS_ESTIMATE_2,
+	BSEC_OUTPUT_GAS_ESTIMATE_3,
+	BSEC_OUTPUT_GAS_ESTIMATE_4,
+	BSEC_OUTPUT_RAW_TEMPERATURE,
+	BSEC_OUTPUT_RAW_PRESSURE,
+	BSEC_OUTPUT_RAW_HUMIDITY,
+	BSEC_OUTPUT_RAW_GAS,
+	BSEC_OUTPUT_RAW_GAS_INDEX
+};
+
+/*!
+ * @brief This function starts a BSEC instance on each sensor
+ */
+demoRetCode bsecManager::begin(sensorManager& sensorMgr, const uint8_t* config, bsecManagerCallback callback)
+{
+	demoRetCode retCode = EDK_OK;
+	
+	/* Bsec2 brings up each sensor with its own driver, the sensor manager only provides the communication */
+	sensorMgr.setupComm();
+	_callback = callback;
+	_nbInstances = 0;
+	for (uint8_t i = 0; (i < NUM_BME68X_UNITS) && (retCode == EDK_OK); i++)
+	{
+		_comm[i] = sensorMgr.getComm(i);
+		if (_comm[i] == nullptr)
+		{
+			retCode = EDK_SENSOR_MANAGER_SENSOR_INDEX_ERROR;
+			break;
+		}
+		/* each instance keeps its state in its own arena, none is shared */
+		_bsec[i].allocateMemory(_arena[i]);
+		memset(&_settings[i], 0, sizeof(_settings[i]));
+		_opMode[i] = BME68X_SLEEP_MODE;
+		
+		commMuxBeginSession(*_comm[i]);
+		if (!_bsec[i].begin(BME68X_SPI_INTF, commMuxRead, commMuxWrite, commMuxDelay, _comm[i]))
+		{
+			retCode = EDK_BSEC_INIT_ERROR;
+		}
+		else if ((config != nullptr) && !_bsec[i].setConfig(config))
+		{
+			retCode = EDK_BSEC_SET_CONFIG_ERROR;
+		}
+		else if (!_bsec[i].updateSubscription(bsecSubscription, ARRAY_LEN(bsecSubscription), BSEC_SAMPLE_RATE_SCAN))
+		{
+			retCode = EDK_BSEC_UPDATE_SUBSCRIPTION_ERROR;
+		}
+		else
+		{
+			_sensorId[i] = _bsec[i].sensor.getUniqueId();
+			_nbInstances++;
+		}
+		commMuxEndSession();
+	}
+	if (retCode == EDK_OK)
+	{
+		utils::setBootPhase(BOOT_PHASE_SENSORS_INITIALIZED);
+	}
+	return retCode;
+}
+
+/*!
+ * @brief This function runs the BSEC instances whose sensor is due
+ */
+demoRetCode bsecManager::run()
+{
+	demoRetCode retCode = EDK_OK;
+	
+	for (uint8_t i = 0; i < _nbInstances; i++)
+	{
+		int64_t timeNs = (int64_t)utils::getTickUs() * 1000;
+		/* an instance that is not due is skipped without taking the bus */
+		if (timeNs < _settings[i].next_call)
+		{
+			continue;
+		}
+		if (bsec_sensor_control_m(_arena[i], timeNs, &_settings[i]) < BSEC_OK)
+		{
+			retCode = EDK_BSEC_RUN_ERROR;
+			continue;
+		}
+		
+		bme68x_data fields[BSEC_MAX_FIELDS];
+		uint8_t nbFields = 0;
+		
+		commMuxBeginSession(*_comm[i]);
+		bool ok = configureSensor(i);
+		if (ok && _settings[i].trigger_measurement && (_settings[i].op_mode != BME68X_SLEEP_MODE) && _bsec[i].sensor.fetchData())
+		{
+			uint8_t nbLeft;
+			do
+			{
+				nbLeft = _bsec[i].sensor.getData(fields[nbFields++]);
+			} while (nbLeft && (nbFields < BSEC_MAX_FIELDS));
+		}
+		commMuxEndSession();
+		
+		/* the processing and the callback run without the bus */
+		for (uint8_t j = 0; ok && (j < nbFields); j++)
+		{
+			if (fields[j].status & BME68X_GASM_VALID_MSK)
+			{
+				ok = processData(i, timeNs, fields[j]);
+			}
+		}
+		if (!ok)
+		{
+			retCode = EDK_BSEC_RUN_ERROR;
+		}
+	}
+	return retCode;
+}
+
+/*!
+ * @brief This function applies the sensor settings requested by an instance
+ */
+bool bsecManager::configureSensor(uint8_t num)
+{
+	bsec_bme_settings_t& settings = _settings[num];
+	Bme68x& sensor = _bsec[num].sensor;
+	
+	switch (settings.op_mode)
+	{
+		case BME68X_FORCED_MODE:
+			sensor.setTPH(settings.temperature_oversampling, settings.pressure_oversampling, settings.humidity_oversampling);
+			sensor.setHeaterProf(settings.heater_temperature, settings.heater_duration);
+			sensor.setOpMode(BME68X_FORCED_MODE);
+		break;
+		case BME68X_PARALLEL_MODE:
+			/* the parallel mode keeps running once configured */
+			if (_opMode[num] != BME68X_PARALLEL_MODE)
+			{
+				sensor.setTPH(settings.temperature_oversampling, settings.pressure_oversampling, settings.humidity_oversampling);
+				uint16_t sharedHeaterDur = BSEC_TOTAL_HEAT_DUR - (sensor.getMeasDur(BME68X_PARALLEL_MODE) / INT64_C(1000));
+				sensor.setHeaterProf(settings.heater_temperature_profile, settings.heater_duration_profile, sharedHeaterDur,
+									 settings.heater_profile_len);
+				sensor.setOpMode(BME68X_PARALLEL_MODE);
+			}
+		break;
+		default:
+			if (_opMode[num] != BME68X_SLEEP_MODE)
+			{
+				sensor.setOpMode(BME68X_SLEEP_MODE);
+			}
+		break;
+	}
+	if (sensor.checkStatus() == BME68X_ERROR)
+	{
+		return false;
+	}
+	_opMode[num] = settings.op_mode;
+	return true;
+}
+
+/*!
+ * @brief This function processes one data field in an instance
+ */
+bool bsecManager::processData(uint8_t num, int64_t timeNs, const bme68x_data& data)
+{
+	const bsec_bme_settings_t& settings = _settings[num];
+	bsec_input_t inputs[BSEC_MAX_PHYSICAL_SENSOR];
+	uint8_t nbInputs = 0;
+	/* the inputs BSEC requested, in the order of the Bsec2 library; no temperature offset is applied */
+	const struct
+	{
+		uint8_t id;
+		float signal;
+		bool valid;
+	} signals[] = {
+		{BSEC_INPUT_HEATSOURCE, 0.0f, true},
+		{BSEC_INPUT_TEMPERATURE, data.temperature, true},
+		{BSEC_INPUT_HUMIDITY, data.humidity, true},
+		{BSEC_INPUT_PRESSURE, data.pressure, true},
+		{BSEC_INPUT_GASRESISTOR, data.gas_resistance, (data.status & BME68X_GASM_VALID_MSK) != 0},
+		{BSEC_INPUT_PROFILE_PART, (_opMode[num] == BME68X_FORCED_MODE) ? 0.0f : (float)data.gas_index, (data.status & BME68X_GASM_VALID_MSK) != 0}
+	};
+	
+	for (const auto& signal : signals)
+	{
+		if (BSEC_CHECK_INPUT(settings.process_data, signal.id) && signal.valid)
+		{
+			inputs[nbInputs].sensor_id = signal.id;
+			inputs[nbInputs].signal = signal.signal;
+			inputs[nbInputs].signal_dimensions = 1;
+			inputs[nbInputs].time_stamp = timeNs;
+			nbInputs++;
+		}
+	}
+	if (nbInputs == 0)
+	{
+		return true;
+	}
+	
+	_outputs.nOutputs = BSEC_NUMBER_OUTPUTS;
+	if (bsec_do_steps_m(_arena[num], inputs, nbInputs, _outputs.output, &_outputs.nOutputs) != BSEC_OK)
+	{
+		return false;
+	}
+	if (_callback != nullptr)
+	{
+		_callback(num, _sensorId[num], _opMode[num], data, _outputs);
+	}
+	return true;
+}
+
+/*!
+ * @brief This function retrieves the state of an instance
+ */
+bool bsecManager::getState(uint8_t num, uint8_t state[BSEC_MAX_STATE_BLOB_SIZE])
+{
+	/* the state is serialized from the instance memory, without bus access */
+	return (num < _nbInstances) && _bsec[num].getState(state);
+}
+
+/*!
+ * @brief This function restores the state of an instance
+ */
+bool bsecManager::setState(uint8_t num, uint8_t state[BSEC_MAX_STATE_BLOB_SIZE])
+{
+	return (num < _nbInstances) && _bsec[num].setState(state);
+}
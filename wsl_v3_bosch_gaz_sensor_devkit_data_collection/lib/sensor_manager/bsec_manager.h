@@ -0,0 +1,184 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	bsec_manager.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Header file for the BSEC manager, running one BSEC instance per sensor
+ * 
+ * 
+ */
+
+#ifndef BSEC_MANAGER_H
+#define BSEC_MANAGER_H
+
+/* Include of Arduino Core */
+#include <Arduino.h>
+#include <bsec2.h>
+#include "demo_app.h"
+#include "commMux.h"
+#include "sensor_manager.h"
+
+/* Interval at which the BSEC instances are polled, BSEC decides itself when a sensor is due */
+#define BSEC_POLL_INTERVAL_MS 			10
+/* Data fields of one measurement in parallel mode */
+#define BSEC_MAX_FIELDS 				3
+
+/*!
+ * @brief : Callback receiving the outputs of one BSEC instance
+ * 
+ * @param[in] num 			: sensor number
+ * @param[in] sensorId 		: unique id of the sensor
+ * @param[in] sensorMode 	: operation mode the instance runs the sensor in
+ * @param[in] input 		: bme68x data processed by BSEC
+ * @param[in] outputs 		: BSEC outputs
+ */
+typedef void (*bsecManagerCallback)(uint8_t num, uint32_t sensorId, uint8_t sensorMode, const bme68x_data& input, const bsecOutputs& outputs);
+
+/*!
+ * @brief : Class library that runs one BSEC instance on each bme688 sensor of the board.
+ *			The Bsec2 objects bring up and configure the instances, the sensor control and processing
+ *			are driven here through the instance memory, so that the bus is only held for the sensor accesses.
+ */
+class bsecManager
+{
+private:
+	Bsec2 						_bsec[NUM_BME68X_UNITS];
+	/* instance memory of each BSEC instance, the library keeps its whole state there */
+	static uint8_t 				_arena[NUM_BME68X_UNITS][BSEC_INSTANCE_SIZE];
+	commMux* 					_comm[NUM_BME68X_UNITS];
+	/* sensor settings requested by each instance, next_call tells when it is due */
+	bsec_bme_settings_t 		_settings[NUM_BME68X_UNITS];
+	uint8_t 					_opMode[NUM_BME68X_UNITS];
+	uint32_t 					_sensorId[NUM_BME68X_UNITS];
+	uint8_t 					_nbInstances = 0;
+	bsecManagerCallback 		_callback = nullptr;
+	/* outputs of the last processed field, passed to the callback */
+	bsecOutputs 				_outputs;
+	
+	/*!
+	 * @brief : This function applies the sensor settings requested by an instance, the caller holds its session
+	 * 
+	 * @param[in] num : instance number
+	 * 
+	 * @return  true on success
+	 */
+	bool configureSensor(uint8_t num);
+	
+	/*!
+	 * @brief : This function processes one data field in an instance and passes the outputs to the callback
+	 * 
+	 * @param[in] num 		: instance number
+	 * @param[in] timeNs 	: time stamp of the sensor control call
+	 * @param[in] data 		: data field
+	 * 
+	 * @return  true on success
+	 */
+	bool processData(uint8_t num, int64_t timeNs, const bme68x_data& data);
+	
+public:
+	/*!
+	 * @brief : This function starts a BSEC instance on each sensor, which brings up the sensor
+	 * 
+	 * @param[in] sensorMgr : sensor manager providing the communication setup of the sensors
+	 * @param[in] config 	: BSEC configuration string, the library default if nullptr
+	 * @param[in] callback 	: callback receiving the outputs
+     * 
+     * @return  bosch error code
+	 */
+	demoRetCode begin(sensorManager& sensorMgr, const uint8_t* config, bsecManagerCallback callback);
+	
+	/*!
+	 * @brief : This function runs the BSEC instances whose sensor is due, the outputs are passed to the callback.
+	 *			The bus is taken for the sensor accesses of a due instance only, not while BSEC processes the data.
+	 * 
+     * @return  bosch error code
+	 */
+	demoRetCode run();
+	
+	/*!
+	 * @brief : This function retrieves the state of an instance, call it from the task running the instances
+	 * 
+	 * @param[in] num 		: instance number
+	 * @param[out] state 	: serialized state
+	 * 
+	 * @return  true on success
+	 */
+	bool getState(uint8_t num, uint8_t state[BSEC_MAX_STATE_BLOB_SIZE]);
+	
+	/*!
+	 * @brief : This function restores the state of an instance, valid only with the configuration it was retrieved with
+	 * 
+	 * @param[in] num 	: instance number
+	 * @param[in] state : serialized state
+	 * 
+	 * @return  true on success
+	 */
+	bool setState(uint8_t num, uint8_t state[BSEC_MAX_STATE_BLOB_SIZE]);
+	
+	/*!
+	 * @brief : This function retrieves the number of running BSEC instances
+	 * 
+     * @return  number of instances
+	 */
+	uint8_t getInstanceCount() const
+	{
+		return _nbInstances;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the unique id of the sensor an instance runs on
+	 * 
+	 * @param[in] num : instance number
+	 * 
+     * @return  sensor id, 0 for an instance not running
+	 */
+	uint32_t getSensorId(uint8_t num) const
+	{
+		return (num < _nbInstances) ? _sensorId[num] : 0;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the status of the last Bsec2 call of an instance, getState and setState included
+	 * 
+	 * @param[in] num : instance number
+	 * 
+     * @return  BSEC library return code
+	 */
+	int32_t getStatus(uint8_t num) const
+	{
+		return (num < _nbInstances) ? (int32_t)_bsec[num].status : 0;
+	}
+};
+
+#endif
@@ -0,0 +1,379 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	    profile_table.cpp
+ * @date	    17 October 2026
+ * @version		1.5.5
+ * 
+ * @brief    	compiled heater profile table
+ *
+ * 
+ */
+
+/* own header include */
+#include "profile_table.h"
+#include "utils.h"
+
+/*!
+ * @brief This function calculates the 32 bit FNV-1a hash of a buffer
+ */
+uint32_t profileTable::hash(const uint8_t* data, size_t len, uint32_t hash)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		hash ^= data[i];
+		hash *= UINT32_C(0x01000193);
+	}
+	return hash;
+}
+
+/*!
+ * @brief This function retrieves the cache filename of a configuration file
+ */
+String profileTable::getCacheName(const String& configName)
+{
+	String cacheName = configName;
+	if (cacheName.endsWith(BME68X_CONFIG_FILE_EXT))
+	{
+		cacheName.remove(cacheName.length() - strlen(BME68X_CONFIG_FILE_EXT));
+	}
+	if (!cacheName.startsWith("/"))
+	{
+		cacheName = "/" + cacheName;
+	}
+	return cacheName + BME68X_PROFILE_CACHE_FILE_EXT;
+}
+
+/*!
+ * @brief This function adds a heater profile to the table, unless an identical one is already present
+ */
+demoRetCode profileTable::addHeater(bme68xProfileTable& table, JsonVariant profileJson, uint8_t& index)
+{
+	bme68xHeaterTable heater;
+	JsonArray vectors = profileJson["temperatureTimeVectors"].as<JsonArray>();
+	
+	if (vectors.size() > PROFILE_TABLE_MAX_STEPS)
+	{
+		return EDK_SENSOR_MANAGER_JSON_FORMAT_ERROR;
+	}
+	memset(&heater, 0, sizeof(heater));
+	heater.length = vectors.size();
+	for (uint8_t i = 0; i < heater.length; i++)
+	{
+		heater.temperature[i] = vectors[i][0].as<uint16_t>();
+		heater.duration[i] = vectors[i][1].as<uint16_t>();
+	}
+	
+	for (index = 0; index < table.nbHeaters; index++)
+	{
+		if (memcmp(&table.heaters[index], &heater, sizeof(heater)) == 0)
+		{
+			return EDK_OK;
+		}
+	}
+	if (table.nbHeaters >= PROFILE_TABLE_MAX_ENTRIES)
+	{
+		return EDK_SENSOR_MANAGER_JSON_FORMAT_ERROR;
+	}
+	table.heaters[table.nbHeaters++] = heater;
+	return EDK_OK;
+}
+
+/*!
+ * @brief This function adds a duty cycle profile to the table, unless an identical one is already present
+ */
+demoRetCode profileTable::addDutyCycle(bme68xProfileTable& table, JsonVariant profileJson, uint8_t& index)
+{
+	bme68xDutyCycleTable dutyCycle;
+	
+	dutyCycle.nbScanningCycles = profileJson["numberScanningCycles"].as<uint8_t>();
+	dutyCycle.nbSleepingCycles = profileJson["numberSleepingCycles"].as<uint8_t>();
+	
+	for (index = 0; index < table.nbDutyCycles; index++)
+	{
+		if ((table.dutyCycles[index].nbScanningCycles == dutyCycle.nbScanningCycles) &&
+			(table.dutyCycles[index].nbSleepingCycles == dutyCycle.nbSleepingCycles))
+		{
+			return EDK_OK;
+		}
+	}
+	if (table.nbDutyCycles >= PROFILE_TABLE_MAX_ENTRIES)
+	{
+		return EDK_SENSOR_MANAGER_JSON_FORMAT_ERROR;
+	}
+	table.dutyCycles[table.nbDutyCycles++] = dutyCycle;
+	return EDK_OK;
+}
+
+/*!
+ * @brief This function compiles the Json configuration into the table
+ */
+demoRetCode profileTable::compile(JsonDocument& configDoc, bme68xProfileTable& table)
+{
+	demoRetCode retCode = EDK_OK;
+	JsonArray heaterProfilesJson = configDoc["configBody"]["heaterProfiles"].as<JsonArray>();
+	JsonArray dutyCycleProfilesJson = configDoc["configBody"]["dutyCycleProfiles"].as<JsonArray>();
+	JsonArray sensorConfigurations = configDoc["configBody"]["sensorConfigurations"].as<JsonArray>();
+	JsonVariant dataLoggingJson = configDoc["configBody"]["dataLogging"];
+	
+	/* the flush policy is optional, missing keys keep the defaults */
+	table.flushPolicy.maxBytes = dataLoggingJson["flushBytes"] | LOG_FLUSH_DEFAULT_BYTES;
+	table.flushPolicy.maxDelayMs = dataLoggingJson["flushIntervalMs"] | LOG_FLUSH_DEFAULT_DELAY_MS;
+	table.flushPolicy.onLabelChange = dataLoggingJson["flushOnLabelChange"] | LOG_FLUSH_DEFAULT_ON_LABEL;
+	
+	/* only the profiles referenced by a sensor are compiled */
+	for (JsonVariant sensorConfig : sensorConfigurations)
+	{
+		if (table.nbSensors >= PROFILE_TABLE_MAX_ENTRIES)
+		{
+			return EDK_SENSOR_MANAGER_SENSOR_INDEX_ERROR;
+		}
+		bme68xSensorTable& sensor = table.sensors[table.nbSensors];
+		String heaterProfileStr = sensorConfig["heaterProfile"].as<String>();
+		String dutyCycleStr = sensorConfig["dutyCycleProfile"].as<String>();
+		bool heaterFound = false, dutyCycleFound = false;
+		
+		sensor.sensorIndex = sensorConfig["sensorIndex"].as<uint8_t>();
+		
+		for (JsonVariant heaterProfileJson : heaterProfilesJson)
+		{
+			if (heaterProfileStr == heaterProfileJson["id"].as<String>())
+			{
+				retCode = addHeater(table, heaterProfileJson, sensor.heaterIndex);
+				heaterFound = true;
+				break;
+			}
+		}
+		if (retCode != EDK_OK)
+		{
+			return retCode;
+		}
+		
+		for (JsonVariant dutyCycleProfileJson : dutyCycleProfilesJson)
+		{
+			if (dutyCycleStr == dutyCycleProfileJson["id"].as<String>())
+			{
+				retCode = addDutyCycle(table, dutyCycleProfileJson, sensor.dutyCycleIndex);
+				dutyCycleFound = true;
+				break;
+			}
+		}
+		if (retCode != EDK_OK)
+		{
+			return retCode;
+		}
+		
+		if (!heaterFound || !dutyCycleFound)
+		{
+			return EDK_SENSOR_MANAGER_JSON_FORMAT_ERROR;
+		}
+		table.nbSensors++;
+	}
+	return retCode;
+}
+
+/*!
+ * @brief This function parses and compiles the configuration
+ */
+demoRetCode profileTable::parse(const char* config, size_t len, bme68xProfileTable& table)
+{
+	/* keeps only the members needed to configure the sensors */
+	StaticJsonDocument<384> filter;
+	filter["configBody"]["heaterProfiles"][0]["id"] = true;
+	filter["configBody"]["heaterProfiles"][0]["temperatureTimeVectors"] = true;
+	filter["configBody"]["dutyCycleProfiles"][0]["id"] = true;
+	filter["configBody"]["dutyCycleProfiles"][0]["numberScanningCycles"] = true;
+	filter["configBody"]["dutyCycleProfiles"][0]["numberSleepingCycles"] = true;
+	filter["configBody"]["sensorConfigurations"][0]["sensorIndex"] = true;
+	filter["configBody"]["sensorConfigurations"][0]["heaterProfile"] = true;
+	filter["configBody"]["sensorConfigurations"][0]["dutyCycleProfile"] = true;
+	filter["configBody"]["dataLogging"] = true;
+	
+	/* the document grows with the configuration and is released once it is compiled */
+	for (size_t docSize = PROFILE_JSON_DOC_SIZE; docSize <= PROFILE_JSON_DOC_MAX_SIZE; docSize *= 2)
+	{
+		DynamicJsonDocument configDoc(docSize);
+		
+		DeserializationError error = deserializeJson(configDoc, config, len, DeserializationOption::Filter(filter));
+		if (error == DeserializationError::NoMemory)
+		{
+			continue;
+		}
+		if (error)
+		{
+			Serial.println(error.c_str());
+			return EDK_SENSOR_MANAGER_JSON_DESERIAL_ERROR;
+		}
+		return compile(configDoc, table);
+	}
+	return EDK_SENSOR_MANAGER_JSON_DESERIAL_ERROR;
+}
+
+/*!
+ * @brief This function reads the configuration file to memory
+ */
+char* profileTable::readConfig(const String& configName, size_t& len)
+{
+	char* config = nullptr;
+	File configFile;
+	
+	len = 0;
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		configFile = SD.open(configName, FILE_READ);
+		if (configFile)
+		{
+			len = configFile.size();
+			config = (char*) malloc(len + 1);
+		}
+	}
+	if (config == nullptr)
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		configFile.close();
+		return nullptr;
+	}
+	
+	size_t pos = 0;
+	while (pos < len)
+	{
+		size_t chunk = ((len - pos) < PROFILE_READ_CHUNK_SIZE) ? (len - pos) : PROFILE_READ_CHUNK_SIZE;
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		size_t read = configFile.read((uint8_t*)&config[pos], chunk);
+		if (read == 0)
+		{
+			break;
+		}
+		pos += read;
+	}
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		configFile.close();
+	}
+	
+	len = pos;
+	config[len] = '\0';
+	return config;
+}
+
+/*!
+ * @brief This function reads a cached table
+ */
+bool profileTable::loadCache(const String& cacheName, uint32_t configHash, bme68xProfileTable& table)
+{
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	File cacheFile = SD.open(cacheName, FILE_READ);
+	if (!cacheFile)
+	{
+		return false;
+	}
+	
+	size_t len = cacheFile.read((uint8_t*)&table, sizeof(table));
+	cacheFile.close();
+	
+	return (len == sizeof(table)) &&
+		   (table.magic == PROFILE_TABLE_MAGIC) &&
+		   (table.version == PROFILE_TABLE_VERSION) &&
+		   (table.size == sizeof(table)) &&
+		   (table.configHash == configHash) &&
+		   (table.checksum == hash((const uint8_t*)&table, offsetof(bme68xProfileTable, checksum))) &&
+		   (table.nbSensors <= PROFILE_TABLE_MAX_ENTRIES);
+}
+
+/*!
+ * @brief This function writes the table to the cache file
+ */
+void profileTable::storeCache(const String& cacheName, const bme68xProfileTable& table)
+{
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	File cacheFile = SD.open(cacheName, FILE_WRITE);
+	if (cacheFile)
+	{
+		/* a failed write is detected by the size or checksum check on the next boot */
+		(void) cacheFile.write((const uint8_t*)&table, sizeof(table));
+		cacheFile.close();
+	}
+}
+
+/*!
+ * @brief This function loads the profile table of the configuration file
+ */
+demoRetCode profileTable::load(const String& configName, bme68xProfileTable& table)
+{
+	demoRetCode retCode;
+	size_t len;
+	
+	char* config = readConfig(configName, len);
+	if (config == nullptr)
+	{
+		return EDK_SENSOR_MANAGER_CONFIG_FILE_ERROR;
+	}
+	
+	uint32_t configHash = hash((const uint8_t*)config, len);
+	String cacheName = getCacheName(configName);
+	
+	if (loadCache(cacheName, configHash, table))
+	{
+		free(config);
+		return EDK_OK;
+	}
+	
+	memset(&table, 0, sizeof(table));
+	retCode = parse(config, len, table);
+	free(config);
+	if (retCode != EDK_OK)
+	{
+		return retCode;
+	}
+	
+	table.magic = PROFILE_TABLE_MAGIC;
+	table.version = PROFILE_TABLE_VERSION;
+	table.size = sizeof(table);
+	table.configHash = configHash;
+	table.checksum = hash((const uint8_t*)&table, offsetof(bme68xProfileTable, checksum));
+	storeCache(cacheName, table);
+	return EDK_OK;
+}
+
+/*!
+ * @brief This function loads the flush policy of the configuration file
+ */
+demoRetCode profileTable::loadFlushPolicy(const String& configName, logFlushPolicy& policy)
+{
+	bme68xProfileTable table;
+	demoRetCode retCode = load(configName, table);
+	if (retCode == EDK_OK)
+	{
+		policy = table.flushPolicy;
+	}
+	return retCode;
+}
@@ -0,0 +1,238 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	profile_table.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Header file for the compiled heater profile table
+ * 
+ * 
+ */
+
+#ifndef PROFILE_TABLE_H
+#define PROFILE_TABLE_H
+
+/* Include of Arduino Core */
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <FS.h>
+#include "demo_app.h"
+#include "group_commit.h"
+
+/* Maximum number of sensors, heater profiles and duty cycle profiles in a table */
+#define PROFILE_TABLE_MAX_ENTRIES		8
+#define PROFILE_TABLE_MAX_STEPS			10
+/* "BMEP", identifies a profile table cache file */
+#define PROFILE_TABLE_MAGIC				UINT32_C(0x504D4542)
+/* Increment on any change of bme68xProfileTable */
+#define PROFILE_TABLE_VERSION			UINT16_C(2)
+/* Initial and maximum size of the Json document used to compile the configuration */
+#define PROFILE_JSON_DOC_SIZE 			5000
+#define PROFILE_JSON_DOC_MAX_SIZE 		65536
+/* Size of the chunks the configuration file is read in */
+#define PROFILE_READ_CHUNK_SIZE 		512
+
+/*!
+ * @brief Structure of a compiled heater profile
+ */
+struct bme68xHeaterTable
+{
+	uint16_t temperature[PROFILE_TABLE_MAX_STEPS];
+	uint16_t duration[PROFILE_TABLE_MAX_STEPS];
+	uint8_t length;
+};
+
+/*!
+ * @brief Structure of a compiled duty cycle profile
+ */
+struct bme68xDutyCycleTable
+{
+	uint8_t nbScanningCycles;
+	uint8_t nbSleepingCycles;
+};
+
+/*!
+ * @brief Structure of a compiled sensor configuration, referencing its profiles by index
+ */
+struct bme68xSensorTable
+{
+	uint8_t sensorIndex;
+	uint8_t heaterIndex;
+	uint8_t dutyCycleIndex;
+};
+
+/*!
+ * @brief Compiled sensor configuration, identical profiles are stored once
+ */
+struct bme68xProfileTable
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t size;
+	uint32_t configHash;
+	uint8_t nbHeaters;
+	uint8_t nbDutyCycles;
+	uint8_t nbSensors;
+	bme68xHeaterTable heaters[PROFILE_TABLE_MAX_ENTRIES];
+	bme68xDutyCycleTable dutyCycles[PROFILE_TABLE_MAX_ENTRIES];
+	bme68xSensorTable sensors[PROFILE_TABLE_MAX_ENTRIES];
+	logFlushPolicy flushPolicy;
+	/* FNV-1a hash of all the preceding bytes */
+	uint32_t checksum;
+};
+
+/*!
+ * @brief : Class library that compiles the .bmeconfig file into a profile table and caches it on the SD card
+ */
+class profileTable
+{
+private:
+	/*!
+	 * @brief : This function adds a heater profile to the table, unless an identical one is already present
+	 * 
+	 * @param[in,out] table 	: profile table
+	 * @param[in] profileJson 	: heater profile Json object
+	 * @param[out] index 		: index of the profile in the table
+     * 
+     * @return  error code
+	 */
+	static demoRetCode addHeater(bme68xProfileTable& table, JsonVariant profileJson, uint8_t& index);
+	
+	/*!
+	 * @brief : This function adds a duty cycle profile to the table, unless an identical one is already present
+	 * 
+	 * @param[in,out] table 	: profile table
+	 * @param[in] profileJson 	: duty cycle profile Json object
+	 * @param[out] index 		: index of the profile in the table
+     * 
+     * @return  error code
+	 */
+	static demoRetCode addDutyCycle(bme68xProfileTable& table, JsonVariant profileJson, uint8_t& index);
+	
+	/*!
+	 * @brief : This function compiles the Json configuration into the table
+	 * 
+	 * @param[in] configDoc : parsed configuration
+	 * @param[out] table 	: profile table
+     * 
+     * @return  error code
+	 */
+	static demoRetCode compile(JsonDocument& configDoc, bme68xProfileTable& table);
+	
+	/*!
+	 * @brief : This function parses and compiles the configuration
+	 * 
+	 * @param[in] config 	: configuration file content
+	 * @param[in] len 		: length of the configuration
+	 * @param[out] table 	: profile table
+     * 
+     * @return  error code
+	 */
+	static demoRetCode parse(const char* config, size_t len, bme68xProfileTable& table);
+	
+	/*!
+	 * @brief : This function reads the configuration file to memory, one bus transaction per chunk,
+	 *			so that the sensors can use the bus while the file is read
+	 * 
+	 * @param[in] configName 	: sensor configuration filename
+	 * @param[out] len 			: length of the configuration
+     * 
+     * @return  the allocated configuration content, to be released with free(), nullptr on error
+	 */
+	static char* readConfig(const String& configName, size_t& len);
+	
+	/*!
+	 * @brief : This function reads a cached table, valid only if it was compiled from a configuration with the given hash
+	 * 
+	 * @param[in] cacheName 	: cache filename
+	 * @param[in] configHash 	: hash of the configuration file
+	 * @param[out] table 		: profile table
+     * 
+     * @return  true if a valid table was read
+	 */
+	static bool loadCache(const String& cacheName, uint32_t configHash, bme68xProfileTable& table);
+	
+	/*!
+	 * @brief : This function writes the table to the cache file
+	 * 
+	 * @param[in] cacheName : cache filename
+	 * @param[in] table 	: profile table
+	 */
+	static void storeCache(const String& cacheName, const bme68xProfileTable& table);
+	
+public:
+	/*!
+	 * @brief : This function calculates the 32 bit FNV-1a hash of a buffer
+	 * 
+	 * @param[in] data 	: data buffer
+	 * @param[in] len 	: length of the buffer
+	 * @param[in] hash 	: hash of the preceding data, to hash data in chunks
+     * 
+     * @return  hash value
+	 */
+	static uint32_t hash(const uint8_t* data, size_t len, uint32_t hash = UINT32_C(0x811C9DC5));
+	
+	/*!
+	 * @brief : This function loads the profile table of the configuration file. The table is read from the
+	 *			cache file next to the configuration if it matches, otherwise it is compiled and the cache is updated.
+	 *			The storage bus is only held while accessing the SD card.
+	 * 
+	 * @param[in] configName 	: sensor configuration filename
+	 * @param[out] table 		: profile table
+     * 
+     * @return  error code
+	 */
+	static demoRetCode load(const String& configName, bme68xProfileTable& table);
+	
+	/*!
+	 * @brief : This function loads the flush policy of the "dataLogging" object of the configuration file,
+	 *			from the cached table when it matches
+	 * 
+	 * @param[in] configName 	: sensor configuration filename
+	 * @param[out] policy 		: flush policy, the defaults for the missing keys
+     * 
+     * @return  error code
+	 */
+	static demoRetCode loadFlushPolicy(const String& configName, logFlushPolicy& policy);
+	
+	/*!
+	 * @brief : This function retrieves the cache filename of a configuration file
+	 * 
+	 * @param[in] configName : sensor configuration filename
+     * 
+     * @return  cache filename
+	 */
+	static String getCacheName(const String& configName);
+};
+
+#endif
@@ -43,6 +43,8 @@
 #include "sensor_manager.h"
 
 bme68xSensor 	sensorManager::_sensors[NUM_BME68X_UNITS];
+sensorScheduler<NUM_BME68X_UNITS> sensorManager::_scheduler;
+TaskHandle_t 	sensorManager::_waitingTask = nullptr;
 commMux commSetup[NUM_BME68X_UNITS];
 
 /*!
@@ -50,6 +52,46 @@ commMux commSetup[NUM_BME68X_UNITS];
  */
 sensorManager::sensorManager()
 {
+	_bringUpTasks = 0;
+	_flushPolicy.maxBytes = LOG_FLUSH_DEFAULT_BYTES;
+	_flushPolicy.maxDelayMs = LOG_FLUSH_DEFAULT_DELAY_MS;
+	_flushPolicy.onLabelChange = LOG_FLUSH_DEFAULT_ON_LABEL;
+}
+
+/*!
+ * @brief This function blocks the calling task until the next sensor is due
+ */
+bool sensorManager::waitForSensor(uint32_t maxWaitMs)
+{
+	uint64_t timeStamp = utils::getTickUs();
+	uint64_t wakeUpTime = getNextWakeUpTime();
+	
+	if (wakeUpTime > timeStamp)
+	{
+		uint64_t waitUs = wakeUpTime - timeStamp;
+		if (waitUs > (uint64_t)maxWaitMs * 1000)
+		{
+			waitUs = (uint64_t)maxWaitMs * 1000;
+		}
+		
+		_waitingTask = xTaskGetCurrentTaskHandle();
+		/* rounded up to whole ticks, so that the sensor is due on return */
+		(void) ulTaskNotifyTake(pdTRUE, (TickType_t) ((waitUs + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000)));
+		_waitingTask = nullptr;
+	}
+	return getNextWakeUpTime() <= utils::getTickUs();
+}
+
+/*!
+ * @brief This function wakes up a task blocked in waitForSensor()
+ */
+void sensorManager::notify()
+{
+	TaskHandle_t task = _waitingTask;
+	if (task != nullptr)
+	{
+		xTaskNotifyGive(task);
+	}
 }
 
 /*!
@@ -70,52 +112,87 @@ int8_t sensorManager::initializeSensor(uint8_t sensorNumber, uint32_t& sensorId)
     return bme68xRslt;
 }
 
+/*!
+ * @brief This function starts the initialization of all sensors
+ */
+void sensorManager::startBringUp()
+{
+	TaskHandle_t parent = xTaskGetCurrentTaskHandle();
+	UBaseType_t priority = uxTaskPriorityGet(NULL);
+	char taskName[] = "bme68xUp0";
+	
+	_bringUpTasks = 0;
+	for (uint8_t i = 0; i < NUM_BME68X_UNITS; i++)
+	{
+		bme68xBringUpJob& job = _bringUp[i];
+		job.manager = this;
+		job.parent = parent;
+		job.sensorNumber = i;
+		job.rslt = BME68X_OK;
+		
+		taskName[sizeof(taskName) - 2] = '0' + i;
+		if (xTaskCreate(bringUpTask, taskName, BRING_UP_TASK_STACK_SIZE, &job, priority, NULL) == pdPASS)
+		{
+			_bringUpTasks++;
+		}
+		else
+		{
+			/* out of memory, initialize the sensor in place */
+			job.rslt = initializeSensor(i, _sensors[i].id);
+		}
+	}
+}
+
+/*!
+ * @brief This function waits for the initialization of all sensors
+ */
+void sensorManager::waitBringUp()
+{
+	/* each task gives one notification when done */
+	while (_bringUpTasks)
+	{
+		(void) ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+		_bringUpTasks--;
+	}
+}
+
+/*!
+ * @brief This function is the task initializing one sensor
+ */
+void sensorManager::bringUpTask(void* arg)
+{
+	bme68xBringUpJob* job = (bme68xBringUpJob*) arg;
+	
+	job->rslt = job->manager->initializeSensor(job->sensorNumber, _sensors[job->sensorNumber].id);
+	xTaskNotifyGive(job->parent);
+	vTaskDelete(NULL);
+}
+
 /*!
  * @brief This function configures the heater settings of the sensor
  */
-int8_t sensorManager::setHeaterProfile(const String& heaterProfileStr, const String& dutyCycleStr, bme68xHeaterProfile& heaterProfile, uint8_t sensorNumber)
+int8_t sensorManager::setHeaterProfile(const bme68xHeaterTable& heater, const bme68xDutyCycleTable& dutyCycle, bme68xHeaterProfile& heaterProfile, uint8_t sensorNumber)
 {
-    /* get heater profiles from parsed object */
-    JsonArray heaterProfilesJson = _configDoc["configBody"]["heaterProfiles"].as<JsonArray>();
-    /* iterate over all heater profiles */
-    for (JsonVariant _heaterProfileJson: heaterProfilesJson)
-    {
-        /* compare with profile of given sensor */
-        if (heaterProfileStr == _heaterProfileJson["id"].as<String>())
-        {
-            /* on match, save heater temperature and duration vectors */
-            heaterProfile.length = _heaterProfileJson["temperatureTimeVectors"].size();
-            for (int i = 0; i < heaterProfile.length; i++)
-            {
-                heaterProfile.temperature[i] = _heaterProfileJson["temperatureTimeVectors"][i][0].as<uint16_t>();
-                heaterProfile.duration[i] = _heaterProfileJson["temperatureTimeVectors"][i][1].as<uint16_t>();
-            }
-            break;
-        }
-    }
+	/* save heater temperature and duration vectors */
+	memset(heaterProfile.temperature, 0, sizeof(heaterProfile.temperature));
+	memset(heaterProfile.duration, 0, sizeof(heaterProfile.duration));
+	heaterProfile.length = heater.length;
+	for (uint8_t i = 0; i < heater.length; i++)
+	{
+		heaterProfile.temperature[i] = heater.temperature[i];
+		heaterProfile.duration[i] = heater.duration[i];
+	}
+	
+	/* save duty cycle information to the sensor profile */
+	heaterProfile.nbRepetitions = dutyCycle.nbScanningCycles;
+	
+	uint64_t sleepDuration = 0;
+	for (uint8_t i = 0; i < heater.length; i++)
+	{
+		sleepDuration += (uint64_t)heater.duration[i] * HEATER_TIME_BASE;
+	}
+	heaterProfile.sleepDuration = dutyCycle.nbSleepingCycles * sleepDuration;
 	
-	/* get duty cycle profiles from parsed object */
-    JsonArray dutyCycleProfilesJson = _configDoc["configBody"]["dutyCycleProfiles"].as<JsonArray>();
-    /* iterate over all duty cycle profiles */
-    for (JsonVariant _dutyCycleProfileJson : dutyCycleProfilesJson)
-    {
-        /* compare with profile of the given sensor */
-        if (dutyCycleStr == _dutyCycleProfileJson["id"].as<String>())
-        {
-            /* on match, save duty cycle information to the sensor profile */
-            heaterProfile.nbRepetitions = _dutyCycleProfileJson["numberScanningCycles"].as<uint8_t>();
-            heaterProfile.sleepDuration = _dutyCycleProfileJson["numberSleepingCycles"].as<uint8_t>();
-			
-			uint64_t sleepDuration = 0;
-			for (uint16_t dur : heaterProfile.duration)
-			{
-				sleepDuration += (uint64_t)dur * HEATER_TIME_BASE;
-			}
-			heaterProfile.sleepDuration *= sleepDuration;
-			
-            break;
-        }
-    }
 	return configureSensor(heaterProfile, sensorNumber);
 }
 
@@ -124,18 +201,22 @@ int8_t sensorManager::setHeaterProfile(const String& heaterProfileStr, const Str
  */
 int8_t sensorManager::configureSensor(bme68xHeaterProfile& heaterProfile, uint8_t sensorNumber)
 {
+	/* keep the sensor selected for the whole configuration burst */
+	commMuxBeginSession(commSetup[sensorNumber]);
+
     bme68xSensors[sensorNumber].setTPH();
 	int8_t bme68xRslt = bme68xSensors[sensorNumber].status;
-	if (bme68xRslt != BME68X_OK)
+	if (bme68xRslt == BME68X_OK)
 	{
-		return bme68xRslt;
+		/* getMeasDur() returns Measurement duration in micro sec. to convert to milli sec. '/ INT64_C(1000)' */
+		uint32_t shared_heatr_dur = HEATER_TIME_BASE - (bme68xSensors[sensorNumber].getMeasDur(BME68X_PARALLEL_MODE) / INT64_C(1000));
+		/* sets the heater configuration of the sensor */
+		bme68xSensors[sensorNumber].setHeaterProf(heaterProfile.temperature, heaterProfile.duration, shared_heatr_dur, heaterProfile.length);
+		bme68xRslt = bme68xSensors[sensorNumber].status;
 	}
 
-	/* getMeasDur() returns Measurement duration in micro sec. to convert to milli sec. '/ INT64_C(1000)' */
-	uint32_t shared_heatr_dur = HEATER_TIME_BASE - (bme68xSensors[sensorNumber].getMeasDur(BME68X_PARALLEL_MODE) / INT64_C(1000));
-	/* sets the heater configuration of the sensor */
-	bme68xSensors[sensorNumber].setHeaterProf(heaterProfile.temperature, heaterProfile.duration, shared_heatr_dur, heaterProfile.length);
-	return bme68xSensors[sensorNumber].status;
+	commMuxEndSession();
+	return bme68xRslt;
 }
 
 /*!
@@ -143,41 +224,31 @@ int8_t sensorManager::configureSensor(bme68xHeaterProfile& heaterProfile, uint8_
  */
 demoRetCode sensorManager::initializeAllSensors()
 {
-	int8_t bme68xRslt = BME68X_OK;
-
-	if (utils::hspi == NULL){
-		utils::hspi = new SPIClass(HSPI);
-		utils::hspi->begin(HSPI_SCLK, HSPI_MISO, HSPI_MOSI, HSPI_SS);
-		pinMode(PIN_SD_CS, OUTPUT);
-	}	
-
-	commMuxBegin(Wire, *utils::hspi);
+	setupComm();
+	for (uint8_t i = 0; i < NUM_BME68X_UNITS; i++)
+	{
+		_sensors[i].i2cMask = ((0x01 << i) ^ 0xFF);//TODO
+	}
+	
+	startBringUp();
+	waitBringUp();
+	utils::setBootPhase(BOOT_PHASE_SENSORS_INITIALIZED);
 	
 	for (uint8_t i = 0; i < NUM_BME68X_UNITS; i++)
 	{
-		bme68xSensor* sensor = getSensor(i);
-		/* Communication interface set for all the 8 sensors */
-		commSetup[i] = commMuxSetConfig(Wire, *utils::hspi, i, commSetup[i]);
-		if (sensor != nullptr)
+		if (_bringUp[i].rslt != BME68X_OK)
 		{
-			sensor->i2cMask = ((0x01 << i) ^ 0xFF);//TODO
-			bme68xRslt = initializeSensor(i, sensor->id);
-			if (bme68xRslt != BME68X_OK)
-			{
-				return EDK_BME68X_DRIVER_ERROR;
-			}
+			return EDK_BME68X_DRIVER_ERROR;
 		}
 	}
 	return EDK_OK;
 }
 
 /*!
- * @brief This function configures the sensor manager using the provided config file
+ * @brief This function sets up the communication of all sensors without initializing them
  */
-demoRetCode sensorManager::begin(const String& configName)
+void sensorManager::setupComm()
 {
-	int8_t bme68xRslt = BME68X_OK;
-
 	if (utils::hspi == NULL){
 		utils::hspi = new SPIClass(HSPI);
 		utils::hspi->begin(HSPI_SCLK, HSPI_MISO, HSPI_MOSI, HSPI_SS);
@@ -190,42 +261,57 @@ demoRetCode sensorManager::begin(const String& configName)
 	{
 		commSetup[i] = commMuxSetConfig(Wire, *utils::hspi, i, commSetup[i]);
 	}
+}
 
-	/* open config file */
-	File configFile = SD.open(configName, FILE_READ);
-    if (configFile)
-    {
-        /* read in configuration and parse to JSON object */
-        DeserializationError error = deserializeJson(_configDoc, configFile);
-        /* close config file */
-        configFile.close();
-		if (error) 
-        {
-            Serial.println(error.c_str());
-			return EDK_SENSOR_MANAGER_JSON_DESERIAL_ERROR;
-        }
-    }
-    else
-    {
-		return EDK_SENSOR_MANAGER_CONFIG_FILE_ERROR;
-    }
-	
+/*!
+ * @brief This function retrieves the communication setup of a sensor
+ */
+commMux* sensorManager::getComm(uint8_t num)
+{
+	return (num < NUM_BME68X_UNITS) ? &commSetup[num] : nullptr;
+}
+
+/*!
+ * @brief This function configures the sensor manager using the provided config file
+ */
+demoRetCode sensorManager::begin(const String& configName)
+{
+	int8_t bme68xRslt = BME68X_OK;
+
+	setupComm();
 	memset(_sensors, 0, sizeof(_sensors));
+	_scheduler.clear();
+	
+	/* all sensors are reset while the configuration is loaded */
+	startBringUp();
+
+	/* load the compiled configuration, the Json document only lives while compiling it */
+	bme68xProfileTable table;
+	demoRetCode retCode = profileTable::load(configName, table);
+	if (retCode == EDK_OK)
+	{
+		_flushPolicy = table.flushPolicy;
+		utils::setBootPhase(BOOT_PHASE_CONFIG_LOADED);
+	}
+	
+	waitBringUp();
+	utils::setBootPhase(BOOT_PHASE_SENSORS_INITIALIZED);
+	if (retCode != EDK_OK)
+	{
+		return retCode;
+	}
 
-    JsonArray devicefigurations = _configDoc["configBody"]["sensorConfigurations"].as<JsonArray>();
-    for (JsonVariant devicefig : devicefigurations)
+    for (uint8_t i = 0; i < table.nbSensors; i++)
     {
-        /* save config information to sensor profile */
-        uint8_t sensorNumber = devicefig["sensorIndex"].as<uint8_t>();
+		const bme68xSensorTable& sensorTable = table.sensors[i];
+        uint8_t sensorNumber = sensorTable.sensorIndex;
 
 		bme68xSensor* sensor = getSensor(sensorNumber);
-		if(sensor == nullptr)
+		if ((sensor == nullptr) || (sensorTable.heaterIndex >= table.nbHeaters) ||
+			(sensorTable.dutyCycleIndex >= table.nbDutyCycles))
 		{
 			return EDK_SENSOR_MANAGER_SENSOR_INDEX_ERROR;
 		}
-
-        String heaterProfileStr = devicefig["heaterProfile"].as<String>();
-        String dutyCycleStr = devicefig["dutyCycleProfile"].as<String>();
         
 		sensor->isConfigured = false;
 		sensor->wakeUpTime = 0;
@@ -234,29 +320,52 @@ demoRetCode sensorManager::begin(const String& configName)
 		sensor->nextGasIndex = 0;
         sensor->i2cMask = ((0x01 << sensorNumber) ^ 0xFF);
 		
-        /* initialize the sensor */
-        bme68xRslt = initializeSensor(sensorNumber, sensor->id);
+        /* result of the sensor initialization */
+        bme68xRslt = _bringUp[sensorNumber].rslt;
 		if (bme68xRslt != BME68X_OK)
 		{
 			return EDK_BME68X_DRIVER_ERROR;
 		}		
 
         /* set the heater profile */
-        bme68xRslt = setHeaterProfile(heaterProfileStr, dutyCycleStr, sensor->heaterProfile, sensorNumber);
+        bme68xRslt = setHeaterProfile(table.heaters[sensorTable.heaterIndex], table.dutyCycles[sensorTable.dutyCycleIndex],
+																					sensor->heaterProfile, sensorNumber);
 		if (bme68xRslt != BME68X_OK)
 		{
 			return EDK_BME68X_DRIVER_ERROR;
 		}	
 		
 		sensor->isConfigured = true;
+		_scheduler.schedule(sensorNumber, sensor->wakeUpTime, false);
     }
+	utils::setBootPhase(BOOT_PHASE_SENSORS_CONFIGURED);
 	return EDK_OK;
 }
 
+/*!
+ * @brief This function prints the bus transaction counters of all sensors
+ */
+void sensorManager::printBusStats(Print& out)
+{
+	for (uint8_t i = 0; i < NUM_BME68X_UNITS; i++)
+	{
+		commMuxPrintStats(out, commSetup[i], i);
+	}
+	commMuxPrintBusStats(out);
+}
+
 /*!
  * @brief This function retrieves the selected sensor data
  */
 demoRetCode sensorManager::collectData(uint8_t num, bme68x_data* data[3])
+{
+	return collectData(num, data, utils::getTickUs());
+}
+
+/*!
+ * @brief This function retrieves the selected sensor data at the given time
+ */
+demoRetCode sensorManager::collectData(uint8_t num, bme68x_data* data[3], uint64_t timeStamp)
 {
 	demoRetCode retCode = EDK_OK;
 	int8_t bme68xRslt = BME68X_OK;
@@ -269,9 +378,11 @@ demoRetCode sensorManager::collectData(uint8_t num, bme68x_data* data[3])
 		return EDK_SENSOR_MANAGER_SENSOR_INDEX_ERROR;
 	}
 	
-	uint64_t timeStamp = utils::getTickMs();
 	if (sensor->isConfigured && (timeStamp >= sensor->wakeUpTime))
 	{
+		/* keep the sensor selected for the whole register burst */
+		commMuxBeginSession(commSetup[num]);
+
 		/* Wake up the sensor if necessary */
 		if (sensor->mode == BME68X_SLEEP_MODE)
 		{
@@ -279,7 +390,7 @@ demoRetCode sensorManager::collectData(uint8_t num, bme68x_data* data[3])
 			bme68xSensors[num].setOpMode(BME68X_PARALLEL_MODE);
 			bme68xRslt = bme68xSensors[num].status;
 			sensor->nextGasIndex = 0;
-			sensor->wakeUpTime = timeStamp + GAS_WAIT_SHARED;
+			sensor->wakeUpTime = timeStamp + GAS_WAIT_SHARED_US;
 		}
 		else
 		{
@@ -315,22 +426,25 @@ demoRetCode sensorManager::collectData(uint8_t num, bme68x_data* data[3])
 						{
 							sensor->cyclePos = 0; 
 							sensor->mode = BME68X_SLEEP_MODE;
-							sensor->wakeUpTime = utils::getTickMs() + sensor->heaterProfile.sleepDuration;
+							sensor->wakeUpTime = timeStamp + sensor->heaterProfile.sleepDuration * 1000;
 							bme68xSensors[num].setOpMode(BME68X_SLEEP_MODE);
 							bme68xRslt = bme68xSensors[num].status;
 							break;
 						}
 					}
-					sensor->wakeUpTime = timeStamp + GAS_WAIT_SHARED;
+					sensor->wakeUpTime = timeStamp + GAS_WAIT_SHARED_US;
 				}
 			}
 			
 			if (data[0] == nullptr)
 			{
-				sensor->wakeUpTime = timeStamp + GAS_WAIT_SHARED;
+				sensor->wakeUpTime = timeStamp + GAS_WAIT_SHARED_US;
 			}
 		}
 		
+		commMuxEndSession();
+		_scheduler.schedule(num, sensor->wakeUpTime, sensor->mode == BME68X_PARALLEL_MODE);
+
 		if (bme68xRslt < BME68X_OK)
 		{
 			retCode = EDK_BME68X_DRIVER_ERROR;
@@ -339,3 +453,66 @@ demoRetCode sensorManager::collectData(uint8_t num, bme68x_data* data[3])
 	return retCode;
 }
 
+
+/*!
+ * @brief This function appends a sample to the batch
+ */
+void sensorManager::addSample(bme68xSampleBatch& batch, uint8_t num, const bme68x_data* data, demoRetCode code)
+{
+	if (batch.count >= SAMPLE_BATCH_SIZE)
+	{
+		return;
+	}
+	
+	bme68xSample& sample = batch.samples[batch.count++];
+	sample.sensorNum = num;
+	sample.sensorId = _sensors[num].id;
+	sample.mode = _sensors[num].mode;
+	sample.code = code;
+	sample.hasData = (data != nullptr);
+	if (data != nullptr)
+	{
+		sample.data = *data;
+	}
+}
+
+/*!
+ * @brief This function retrieves the data of all sensors due at the same time in one pass
+ */
+demoRetCode sensorManager::collectBatch(bme68xSampleBatch& batch)
+{
+	static_assert(SAMPLE_BATCH_SIZE >= (NUM_BME68X_UNITS * 3), "a batch must hold 3 fields of every sensor");
+	
+	demoRetCode retCode = EDK_OK;
+	
+	batch.tickUs = utils::getTickUs();
+	batch.count = 0;
+	
+	/* the due sensors leave the schedule before the first one is collected, so that a sensor
+	   rescheduled at the batch time, e.g. without sleep duration, is visited once */
+	(void) _scheduler.visitDue(batch.tickUs, [&](uint8_t num)
+	{
+		bme68x_data* data[3];
+		demoRetCode code = collectData(num, data, batch.tickUs);
+		
+		if (code < EDK_OK)
+		{
+			addSample(batch, num, nullptr, code);
+			if (retCode >= EDK_OK)
+			{
+				retCode = code;
+			}
+		}
+		else
+		{
+			for (const auto fieldData : data)
+			{
+				if (fieldData != nullptr)
+				{
+					addSample(batch, num, fieldData, code);
+				}
+			}
+		}
+	});
+	return retCode;
+}
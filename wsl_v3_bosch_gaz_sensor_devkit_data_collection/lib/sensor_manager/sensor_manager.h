@@ -52,6 +52,10 @@
 #include "demo_app.h"
 #include <bme68xLibrary.h>
 #include "commMux.h"
+#include "profile_table.h"
+#include "sensor_scheduler.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 /* I2C-Expander masks */
 #define I2C_EXPANDER_ADDR 				0x20
@@ -63,8 +67,20 @@
 #define HEATER_TIME_BASE				140
 #define MAX_HEATER_DURATION				200
 #define GAS_WAIT_SHARED					UINT8_C(140)
-/* Size of Json document in bytes */
-#define JSON_DOC_SIZE 					5000
+#define GAS_WAIT_SHARED_US				(GAS_WAIT_SHARED * UINT64_C(1000))
+/* Stack size of the tasks initializing the sensors in parallel */
+#define BRING_UP_TASK_STACK_SIZE		4096
+
+/*!
+ * @brief Structure holding the initialization of one sensor in its own task
+ */
+struct bme68xBringUpJob
+{
+	class sensorManager* manager;
+	TaskHandle_t parent;
+	uint8_t sensorNumber;
+	int8_t rslt;
+};
 
 /*!
  * @brief : Class library that holds the functionality of the sensor manager
@@ -75,8 +91,13 @@ private:
 	static bme68xSensor 		_sensors[NUM_BME68X_UNITS];
 	Bme68x 						bme68xSensors[NUM_BME68X_UNITS];
 	bme68x_data 				_fieldData[3];
-
-	StaticJsonDocument<JSON_DOC_SIZE>	_configDoc;
+	bme68xBringUpJob 			_bringUp[NUM_BME68X_UNITS];
+	uint8_t 					_bringUpTasks;
+	logFlushPolicy 				_flushPolicy;
+	
+	/* min-heap of the configured sensors, ordered by wake up time */
+	static sensorScheduler<NUM_BME68X_UNITS> _scheduler;
+	static TaskHandle_t 		_waitingTask;
 	
 	/*!
 	 * @brief : This function initializes the given BME688 sensor
@@ -87,17 +108,35 @@ private:
      * @return 0 on success, lessthan zero otherwise
 	 */
 	int8_t initializeSensor(uint8_t sensorNumber, uint32_t& sensorId);
+	
+	/*!
+	 * @brief : This function starts the initialization of all sensors, one task per sensor, so that the
+	 *			soft reset and start-up delays of the sensors overlap each other and the caller's work
+	 */
+	void startBringUp();
+	
+	/*!
+	 * @brief : This function waits for the initialization of all sensors started by startBringUp()
+	 */
+	void waitBringUp();
+	
+	/*!
+	 * @brief : This function is the task initializing one sensor
+	 * 
+	 * @param[in] arg : Pointer to the bring-up job of the sensor
+	 */
+	static void bringUpTask(void* arg);
 	/*!
 	 * @brief : This function configures the heater settings of the sensor
 	 * 
-	 * @param[in] heaterProfileStr 	: The heater profile string id
-	 * @param[in] dutyCycleStr 		: The duty cycle string id
-	 * @param[in] heaterProfile 	: The heater profile structure
-	 * @param[in] sensorNumber 		: The sensor number
+	 * @param[in] heater 		: The compiled heater profile
+	 * @param[in] dutyCycle 	: The compiled duty cycle profile
+	 * @param[in] heaterProfile : The heater profile structure
+	 * @param[in] sensorNumber 	: The sensor number
      * 
      * @return  bme68x return code
 	 */
-	int8_t setHeaterProfile(const String& heaterProfileStr, const String& dutyCycleStr, bme68xHeaterProfile& heaterProfile, uint8_t sensorNumber);
+	int8_t setHeaterProfile(const bme68xHeaterTable& heater, const bme68xDutyCycleTable& dutyCycle, bme68xHeaterProfile& heaterProfile, uint8_t sensorNumber);
 	
 	/*!
 	 * @brief : This function configures the bme688 sensor
@@ -108,7 +147,33 @@ private:
      * @return  bme68x return code
 	 */
 	int8_t configureSensor(bme68xHeaterProfile& heaterProfile, uint8_t sensorNumber);
+	
+	/*!
+	 * @brief : This function retrieves the selected sensor data at the given time.
+	 * 
+	 * @param[in] num 		: Sensor number
+	 * @param[in] data 		: Pointer to sensor data if it is available, else nullptr
+	 * @param[in] timeStamp	: Current tick in microseconds
+     * 
+     * @return  error code
+	 */
+	demoRetCode collectData(uint8_t num, bme68x_data* data[3], uint64_t timeStamp);
+	
+	/*!
+	 * @brief : This function appends a sample to the batch
+	 */
+	static void addSample(bme68xSampleBatch& batch, uint8_t num, const bme68x_data* data, demoRetCode code);
 public:
+	/*!
+	 * @brief : This function retrieves the flush policy of the dataloggers, read from the configuration file.
+     * 
+     * @return  flush policy
+	 */
+	inline const logFlushPolicy& getFlushPolicy() const
+	{
+		return _flushPolicy;
+	};
+	
 	/*!
 	 * @brief : This function retrieves the selected sensor.
 	 * 
@@ -127,46 +192,55 @@ public:
 	};
 	
 	/*!
-	 * @brief : This function selects next readable bme688 sensor in given operation mode
+	 * @brief : This function schedules the next readable bme688 sensor
 	 * 
-	 * @param[inout] num	: Reference to the sensor number
-	 * @param[in] mode		: The sensor operation mode
+	 * @param[out] num : Reference to the sensor number
      * 
-     * @return  True if available
+     * @return  True if a sensor is due
 	 */
-	static inline bool selectNextSensor(uint64_t& wakeUpTime, uint8_t& num, uint8_t mode)
+	static inline bool scheduleSensor(uint8_t& num)
 	{
-		num = (uint8_t)0xFF;
-		for (uint8_t i = 0; i < NUM_BME68X_UNITS; i++)
-		{
-			if ((_sensors[i].mode == mode) && (_sensors[i].wakeUpTime < wakeUpTime))
-			{
-				wakeUpTime = _sensors[i].wakeUpTime;
-				num = i;
-			}
-		}
-		
-		if (num < NUM_BME68X_UNITS)
-		{
-			return true;
-		}
-		return false;
-	}
+		return scheduleSensor(num, utils::getTickUs());
+	};
 	
 	/*!
-	 * @brief : This function schedules the next readable bme688 sensor
+	 * @brief : This function schedules the next bme688 sensor readable at the given time
 	 * 
-	 * @param[inout] num : Reference to the sensor number
+	 * @param[out] num 		: Reference to the sensor number
+	 * @param[in] timeStamp	: Tick in microseconds
      * 
-     * @return  True if available
+     * @return  True if a sensor is due
 	 */
-	static inline bool scheduleSensor(uint8_t& num)
+	static inline bool scheduleSensor(uint8_t& num, uint64_t timeStamp)
 	{
-		uint64_t wakeUpTime = utils::getTickMs() + 20;
-		return (selectNextSensor(wakeUpTime, num, BME68X_PARALLEL_MODE) || selectNextSensor(wakeUpTime, num, BME68X_SLEEP_MODE));
-		return true;
+		return _scheduler.peekDue(num, timeStamp);
 	};
 	
+	/*!
+	 * @brief : This function retrieves the wake up time of the next due sensor
+	 * 
+     * @return  Wake up time in microseconds, UINT64_MAX if no sensor is scheduled
+	 */
+	static inline uint64_t getNextWakeUpTime()
+	{
+		return _scheduler.getNextWakeUpTime();
+	};
+	
+	/*!
+	 * @brief : This function blocks the calling task until the next sensor is due, the timeout elapses
+	 *			or notify() is called
+	 * 
+	 * @param[in] maxWaitMs : Upper bound of the waiting time in milliseconds
+     * 
+     * @return  True if a sensor is due
+	 */
+	static bool waitForSensor(uint32_t maxWaitMs);
+	
+	/*!
+	 * @brief : This function wakes up a task blocked in waitForSensor()
+	 */
+	static void notify();
+	
     /*!
      * @brief : The constructor of the sensorManager class
      *        	Creates an instance of the class
@@ -179,6 +253,21 @@ public:
      */
 	demoRetCode initializeAllSensors();
 	
+	/*!
+	 * @brief : This function sets up the communication of all sensors without initializing them,
+	 *			for a library bringing up the sensors itself
+	 */
+	static void setupComm();
+	
+	/*!
+	 * @brief : This function retrieves the communication setup of a sensor, to drive it from another library
+	 * 
+	 * @param[in] num : Sensor number
+     * 
+     * @return  Pointer to the communication setup, nullptr if the sensor number is out of range
+	 */
+	static commMux* getComm(uint8_t num);
+	
 	/*!
 	 * @brief : This function configures the sensor manager using the provided config file.
 	 * 
@@ -197,6 +286,23 @@ public:
      * @return  error code
 	 */
     demoRetCode collectData(uint8_t num, bme68x_data* data[3]);
+	
+	/*!
+	 * @brief : This function retrieves the data of all sensors due at the same time in one pass.
+	 *			All samples share the batch time stamp.
+	 * 
+	 * @param[out] batch : Batch receiving the samples, overwritten on each call
+     * 
+     * @return  EDK_OK, or the first error reported by a sensor
+	 */
+	demoRetCode collectBatch(bme68xSampleBatch& batch);
+	
+	/*!
+	 * @brief : This function prints the bus transaction counters of all sensors and the bus contention statistics.
+	 * 
+	 * @param[in] out : output stream, e.g. Serial
+	 */
+	void printBusStats(Print& out);
 };
 
 #endif
\ No newline at end of file
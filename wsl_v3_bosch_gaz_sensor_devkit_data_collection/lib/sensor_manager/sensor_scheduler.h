@@ -0,0 +1,272 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	sensor_scheduler.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Wake up schedule of the sensors, a binary min-heap ordered by wake up time
+ * 
+ * 
+ */
+
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*!
+ * @brief : Min-heap of the scheduled sensors, ordered by wake up time. Sensors in the middle of a heater
+ *			profile go first on equal wake up times, then the lower sensor number. Free of any platform
+ *			dependency, so that it also builds on the host.
+ */
+template <uint8_t CAPACITY>
+class sensorScheduler
+{
+private:
+	/* marks a sensor that is not part of the heap */
+	static const uint8_t POS_NONE = 0xFF;
+	
+	uint64_t 	_wakeUpTime[CAPACITY];
+	bool 		_inProfile[CAPACITY];
+	uint8_t 	_heap[CAPACITY];
+	uint8_t 	_pos[CAPACITY];
+	uint8_t 	_size;
+	
+	/*!
+	 * @brief : This function compares two heap entries
+	 * 
+	 * @param[in] a : heap position of the first sensor
+	 * @param[in] b : heap position of the second sensor
+     * 
+     * @return  true if the first sensor is due before the second
+	 */
+	bool before(uint8_t a, uint8_t b) const
+	{
+		uint8_t numA = _heap[a], numB = _heap[b];
+		
+		if (_wakeUpTime[numA] != _wakeUpTime[numB])
+		{
+			return _wakeUpTime[numA] < _wakeUpTime[numB];
+		}
+		if (_inProfile[numA] != _inProfile[numB])
+		{
+			return _inProfile[numA];
+		}
+		return numA < numB;
+	}
+	
+	/*!
+	 * @brief : This function swaps two heap entries
+	 */
+	void swap(uint8_t a, uint8_t b)
+	{
+		uint8_t num = _heap[a];
+		
+		_heap[a] = _heap[b];
+		_heap[b] = num;
+		_pos[_heap[a]] = a;
+		_pos[_heap[b]] = b;
+	}
+	
+	/*!
+	 * @brief : This function restores the heap order around a position
+	 */
+	void sift(uint8_t pos)
+	{
+		while ((pos > 0) && before(pos, (pos - 1) / 2))
+		{
+			swap(pos, (pos - 1) / 2);
+			pos = (pos - 1) / 2;
+		}
+		for (;;)
+		{
+			uint8_t first = pos;
+			uint8_t left = 2 * pos + 1, right = 2 * pos + 2;
+			
+			if ((left < _size) && before(left, first))
+			{
+				first = left;
+			}
+			if ((right < _size) && before(right, first))
+			{
+				first = right;
+			}
+			if (first == pos)
+			{
+				break;
+			}
+			swap(pos, first);
+			pos = first;
+		}
+	}
+	
+	/*!
+	 * @brief : This function takes the first sensor out of the heap
+	 */
+	uint8_t pop()
+	{
+		uint8_t num = _heap[0];
+		
+		swap(0, --_size);
+		_pos[num] = POS_NONE;
+		if (_size)
+		{
+			sift(0);
+		}
+		return num;
+	}
+public:
+	sensorScheduler()
+	{
+		clear();
+	}
+	
+	/*!
+	 * @brief : This function removes all sensors from the schedule
+	 */
+	void clear()
+	{
+		for (uint8_t i = 0; i < CAPACITY; i++)
+		{
+			_pos[i] = POS_NONE;
+			_wakeUpTime[i] = 0;
+			_inProfile[i] = false;
+		}
+		_size = 0;
+	}
+	
+	/*!
+	 * @brief : This function adds a sensor to the schedule, or moves it if it is already scheduled
+	 * 
+	 * @param[in] num 			: Sensor number
+	 * @param[in] wakeUpTime 	: Tick in microseconds the sensor is due at
+	 * @param[in] inProfile 	: true while the sensor runs a heater profile
+	 */
+	void schedule(uint8_t num, uint64_t wakeUpTime, bool inProfile)
+	{
+		if (num >= CAPACITY)
+		{
+			return;
+		}
+		_wakeUpTime[num] = wakeUpTime;
+		_inProfile[num] = inProfile;
+		if (!isScheduled(num))
+		{
+			_heap[_size] = num;
+			_pos[num] = _size++;
+		}
+		sift(_pos[num]);
+	}
+	
+	/*!
+	 * @brief : This function tells whether a sensor is part of the schedule
+	 */
+	bool isScheduled(uint8_t num) const
+	{
+		return (num < CAPACITY) && (_pos[num] != POS_NONE);
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of scheduled sensors
+	 */
+	uint8_t size() const
+	{
+		return _size;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the first sensor due at the given time, without removing it
+	 * 
+	 * @param[out] num 		: Reference to the sensor number
+	 * @param[in] timeStamp	: Tick in microseconds
+     * 
+     * @return  True if a sensor is due
+	 */
+	bool peekDue(uint8_t& num, uint64_t timeStamp) const
+	{
+		if (_size && (_wakeUpTime[_heap[0]] <= timeStamp))
+		{
+			num = _heap[0];
+			return true;
+		}
+		return false;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the wake up time of the next due sensor
+	 * 
+     * @return  Wake up time in microseconds, UINT64_MAX if no sensor is scheduled
+	 */
+	uint64_t getNextWakeUpTime() const
+	{
+		return _size ? _wakeUpTime[_heap[0]] : UINT64_MAX;
+	}
+	
+	/*!
+	 * @brief : This function visits every sensor due at the given time exactly once, in schedule order.
+	 *			The due sensors are taken out of the heap before the first visit, so that a sensor the
+	 *			visitor reschedules at or before the time stamp waits for the next pass. A sensor the visitor
+	 *			does not reschedule goes back with its former wake up time.
+	 * 
+	 * @param[in] timeStamp	: Tick in microseconds
+	 * @param[in] visit 	: Callable taking the sensor number
+     * 
+     * @return  Number of visited sensors
+	 */
+	template <typename Visitor>
+	uint8_t visitDue(uint64_t timeStamp, Visitor visit)
+	{
+		uint8_t due[CAPACITY];
+		uint8_t count = 0;
+		
+		while (_size && (_wakeUpTime[_heap[0]] <= timeStamp))
+		{
+			due[count++] = pop();
+		}
+		for (uint8_t i = 0; i < count; i++)
+		{
+			visit(due[i]);
+		}
+		for (uint8_t i = 0; i < count; i++)
+		{
+			if (!isScheduled(due[i]))
+			{
+				schedule(due[i], _wakeUpTime[due[i]], _inProfile[due[i]]);
+			}
+		}
+		return count;
+	}
+};
+
+#endif /* SENSOR_SCHEDULER_H */
@@ -0,0 +1,256 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	bsec_state_store.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	BSEC state snapshots, kept on the SD card across power cycles
+ * 
+ * 
+ */
+
+#include "bsec_state_store.h"
+#ifdef ARDUINO
+#include "utils.h"
+#endif
+
+/*!
+ * @brief This function updates the maximum of a duration
+ */
+void bsecStateStore::updateMax(uint32_t& maxUs, uint64_t startUs)
+{
+	uint32_t durationUs = (uint32_t)(_clockUs() - startUs);
+	if (durationUs > maxUs)
+	{
+		maxUs = durationUs;
+	}
+}
+
+/*!
+ * @brief This function completes the header and CRC of a snapshot
+ */
+void bsecStateStore::seal(bsecStateSnapshot& snapshot, uint32_t seq, uint32_t configHash)
+{
+	snapshot.magic = BSEC_STATE_MAGIC;
+	snapshot.version = BSEC_STATE_VERSION;
+	snapshot.size = sizeof(snapshot);
+	snapshot.seq = seq;
+	snapshot.configHash = configHash;
+	snapshot.crc = storageCrc::crc32((const uint8_t*)&snapshot, offsetof(bsecStateSnapshot, crc));
+}
+
+/*!
+ * @brief This function checks a snapshot read from a slot
+ */
+bool bsecStateStore::isValid(const bsecStateSnapshot& snapshot, size_t len, uint32_t configHash)
+{
+	return (len == sizeof(snapshot)) &&
+		   (snapshot.magic == BSEC_STATE_MAGIC) &&
+		   (snapshot.version == BSEC_STATE_VERSION) &&
+		   (snapshot.size == sizeof(snapshot)) &&
+		   (snapshot.configHash == configHash) &&
+		   (snapshot.crc == storageCrc::crc32((const uint8_t*)&snapshot, offsetof(bsecStateSnapshot, crc))) &&
+		   (snapshot.nbInstances <= NUM_BME68X_UNITS);
+}
+
+/*!
+ * @brief This function reads a slot
+ */
+bool bsecStateStore::readSlot(uint8_t slot, bsecStateSnapshot& snapshot)
+{
+	return isValid(snapshot, _readSlot(this, slot, (uint8_t*)&snapshot, sizeof(snapshot)), _configHash);
+}
+
+/*!
+ * @brief This function resets the store and reads the latest valid snapshot
+ */
+bool bsecStateStore::loadLatest(const uint8_t* config, uint8_t nbInstances)
+{
+	int8_t latestSlot = -1;
+	
+	_configHash = (config != nullptr) ? storageCrc::crc32(config, BSEC_MAX_PROPERTY_BLOB_SIZE) : 0;
+	_seq = 0;
+	_nextSlot = 0;
+	_nbCaptured = 0;
+	_nbRestored = 0;
+	_nbInstances = nbInstances;
+	_nbMismatched = 0;
+	_pending.store(false, std::memory_order_relaxed);
+	
+	for (uint8_t slot = 0; slot < BSEC_STATE_SLOT_COUNT; slot++)
+	{
+		if (readSlot(slot, _snapshot) && ((latestSlot < 0) || (_snapshot.seq > _seq)))
+		{
+			latestSlot = slot;
+			_seq = _snapshot.seq;
+		}
+	}
+	
+	if ((latestSlot >= 0) && readSlot(latestSlot, _snapshot))
+	{
+		/* the next snapshot overwrites the other slot */
+		_nextSlot = (latestSlot + 1) % BSEC_STATE_SLOT_COUNT;
+		return true;
+	}
+	return false;
+}
+
+/*!
+ * @brief This function writes the complete snapshot to the older slot
+ */
+bool bsecStateStore::save()
+{
+	if (!isPending())
+	{
+		return true;
+	}
+	
+	uint64_t startUs = _clockUs();
+	
+	seal(_snapshot, _seq + 1, _configHash);
+	size_t written = _writeSlot(this, _nextSlot, (const uint8_t*)&_snapshot, sizeof(_snapshot));
+	updateMax(_saveMaxUs, startUs);
+	/* the next snapshot can be captured, a failed one is replaced at the next interval */
+	_pending.store(false, std::memory_order_release);
+	
+	if (written != sizeof(_snapshot))
+	{
+		/* the slot is detected as invalid by its size or CRC, the other one keeps the previous snapshot */
+		_saveErrors++;
+		return false;
+	}
+	_seq++;
+	_saves++;
+	_nextSlot = (_nextSlot + 1) % BSEC_STATE_SLOT_COUNT;
+	return true;
+}
+
+#ifdef ARDUINO
+/*!
+ * @brief This function retrieves the filename of a slot
+ */
+String bsecStateStore::getSlotName(uint8_t slot)
+{
+	return String("/bsec_state_") + (char)('a' + slot) + BSEC_STATE_FILE_EXT;
+}
+
+/*!
+ * @brief This function retrieves the esp_timer time
+ */
+uint64_t bsecStateStore::systemClockUs(void)
+{
+	return utils::getTickUs();
+}
+
+/*!
+ * @brief This function reads a slot file of the SD card
+ */
+size_t bsecStateStore::sdReadSlot(void* context, uint8_t slot, uint8_t* data, size_t len)
+{
+	(void) context;
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	File stateFile = SD.open(getSlotName(slot), FILE_READ);
+	if (!stateFile)
+	{
+		return 0;
+	}
+	
+	len = stateFile.read(data, len);
+	stateFile.close();
+	return len;
+}
+
+/*!
+ * @brief This function writes a slot file of the SD card
+ */
+size_t bsecStateStore::sdWriteSlot(void* context, uint8_t slot, const uint8_t* data, size_t len)
+{
+	bsecStateStore* store = (bsecStateStore*)context;
+	uint64_t busUs;
+	size_t written = 0;
+	File stateFile;
+	
+	/* the bus is only held for one file operation at a time, the sensors are accessed in between */
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		busUs = store->_clockUs();
+		stateFile = SD.open(getSlotName(slot), FILE_WRITE);
+		store->updateMax(store->_busMaxUs, busUs);
+	}
+	while (stateFile && (written < len))
+	{
+		size_t chunkLen = len - written;
+		chunkLen = (chunkLen > BSEC_STATE_WRITE_CHUNK_SIZE) ? BSEC_STATE_WRITE_CHUNK_SIZE : chunkLen;
+		
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		busUs = store->_clockUs();
+		size_t chunkWritten = stateFile.write(&data[written], chunkLen);
+		store->updateMax(store->_busMaxUs, busUs);
+		if (chunkWritten != chunkLen)
+		{
+			break;
+		}
+		written += chunkLen;
+	}
+	if (stateFile)
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		busUs = store->_clockUs();
+		stateFile.close();
+		store->updateMax(store->_busMaxUs, busUs);
+	}
+	return written;
+}
+
+/*!
+ * @brief This function prints the result of the restore
+ */
+void bsecStateStore::printRestore(Print& out) const
+{
+	out.printf("bsec state: %u/%u instances restored, %u on another sensor, %lu rejected by BSEC (status %ld)\n",
+		(unsigned) _nbRestored, (unsigned) _nbInstances, (unsigned) _nbMismatched, (unsigned long) _setStateErrors,
+		(long) _lastBsecStatus);
+}
+
+/*!
+ * @brief This function prints the snapshot statistics
+ */
+void bsecStateStore::printStats(Print& out) const
+{
+	out.printf("bsec state: %u/%u instances restored, %lu snapshots, %lu save errors, %lu getState errors, %lu setState errors, "
+		"last BSEC status %ld, capture %lu us, save %lu us, bus held %lu us at most\n",
+		(unsigned) _nbRestored, (unsigned) _nbInstances, (unsigned long) _saves, (unsigned long) _saveErrors,
+		(unsigned long) _getStateErrors, (unsigned long) _setStateErrors, (long) _lastBsecStatus,
+		(unsigned long) _captureMaxUs, (unsigned long) _saveMaxUs, (unsigned long) _busMaxUs);
+}
+#endif
@@ -0,0 +1,402 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	bsec_state_store.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Header file for the BSEC state snapshots, kept on the SD card across power cycles
+ * 
+ * 
+ */
+
+#ifndef BSEC_STATE_STORE_H
+#define BSEC_STATE_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#ifdef ARDUINO
+/* Include of Arduino Core */
+#include <Arduino.h>
+#include <bsec2.h>
+#include "sensor_manager.h"
+#else
+/* Host stand-ins of the sizes of the sensor manager and the BSEC2 library, for the host tests */
+#define NUM_BME68X_UNITS 				8
+#define BSEC_MAX_STATE_BLOB_SIZE 		221
+#define BSEC_MAX_PROPERTY_BLOB_SIZE 	2277
+#endif
+#include "storage_crc.h"
+
+/* "BSST", identifies a BSEC state snapshot file */
+#define BSEC_STATE_MAGIC 				UINT32_C(0x54535342)
+/* Increment on any change of bsecStateSnapshot */
+#define BSEC_STATE_VERSION 				UINT16_C(2)
+/* Two slots written alternately, a power loss during a write leaves the other one intact */
+#define BSEC_STATE_SLOT_COUNT 			2
+/* Interval between two snapshots, the accuracy of the BSEC outputs takes hours to build up */
+#define BSEC_STATE_SAVE_INTERVAL_US 	UINT64_C(1800000000)
+/* The bus is released between two chunks, so that a snapshot delays a sensor access by one chunk at most */
+#define BSEC_STATE_WRITE_CHUNK_SIZE 	512
+
+/*!
+ * @brief Structure of a snapshot file, the states of all BSEC instances
+ */
+struct bsecStateSnapshot
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t size;
+	/* incremented on each snapshot, the valid slot with the highest one is restored */
+	uint32_t seq;
+	/* CRC-32 of the BSEC configuration string the states were built with */
+	uint32_t configHash;
+	uint8_t nbInstances;
+	uint8_t reserved[3];
+	/* unique id of the sensor each state was built on, a state is only restored on the same sensor */
+	uint32_t sensorIds[NUM_BME68X_UNITS];
+	uint8_t states[NUM_BME68X_UNITS][BSEC_MAX_STATE_BLOB_SIZE];
+	/* CRC-32 of all the preceding bytes */
+	uint32_t crc;
+};
+
+/*!
+ * @brief : Reads a snapshot slot, a file of the SD card on the board
+ *
+ * @param[in] context 	: state store
+ * @param[in] slot 		: slot index
+ * @param[out] data 	: read bytes
+ * @param[in] len 		: bytes to read
+ *
+ * @return bytes read, 0 if the slot does not exist
+ */
+typedef size_t (*bsecStateReadFn)(void* context, uint8_t slot, uint8_t* data, size_t len);
+
+/*!
+ * @brief : Writes a snapshot slot, replacing its content
+ *
+ * @param[in] context 	: state store
+ * @param[in] slot 		: slot index
+ * @param[in] data 		: bytes to write
+ * @param[in] len 		: bytes to write
+ *
+ * @return bytes written, fewer on error
+ */
+typedef size_t (*bsecStateWriteFn)(void* context, uint8_t slot, const uint8_t* data, size_t len);
+
+/*!
+ * @brief : Time source of the snapshot interval and durations
+ *
+ * @return time in microseconds
+ */
+typedef uint64_t (*bsecStateClock)(void);
+
+/*!
+ * @brief : Class library that saves the states of the BSEC instances periodically and restores them on start up.
+ *			The BSEC task captures the states, another task writes them, so that the SD card never delays BSEC.
+ *			The BSEC manager is a template parameter of restore() and capture(), a stand-in in the host tests.
+ */
+class bsecStateStore
+{
+private:
+	bsecStateReadFn 			_readSlot;
+	bsecStateWriteFn 			_writeSlot;
+	bsecStateClock 				_clockUs;
+	bsecStateSnapshot 			_snapshot;
+	uint32_t 					_configHash = 0;
+	uint32_t 					_seq = 0;
+	uint8_t 					_nextSlot = 0;
+	uint8_t 					_nbCaptured = 0;
+	uint8_t 					_nbRestored = 0;
+	uint8_t 					_nbInstances = 0;
+	uint8_t 					_nbMismatched = 0;
+	uint64_t 					_lastCaptureUs = 0;
+	/* set by the capturing task once the snapshot is complete, cleared by the saving task once it is written */
+	std::atomic<bool> 			_pending;
+	
+	uint32_t 					_saves = 0;
+	uint32_t 					_saveErrors = 0;
+	uint32_t 					_getStateErrors = 0;
+	uint32_t 					_setStateErrors = 0;
+	int32_t 					_lastBsecStatus = 0;
+	uint32_t 					_captureMaxUs = 0;
+	uint32_t 					_saveMaxUs = 0;
+	uint32_t 					_busMaxUs = 0;
+	
+	/*!
+	 * @brief : This function reads a slot, valid only if it is complete and was built with the current configuration
+	 * 
+	 * @param[in] slot 			: slot index
+	 * @param[out] snapshot 	: snapshot read
+	 * 
+	 * @return  true if the slot is valid
+	 */
+	bool readSlot(uint8_t slot, bsecStateSnapshot& snapshot);
+	
+	/*!
+	 * @brief : This function resets the store and reads the latest valid snapshot
+	 * 
+	 * @param[in] config 		: BSEC configuration string, nullptr for the library default
+	 * @param[in] nbInstances 	: number of running instances
+	 * 
+	 * @return  true if a valid snapshot was read
+	 */
+	bool loadLatest(const uint8_t* config, uint8_t nbInstances);
+	
+	/*!
+	 * @brief : This function updates the maximum of a duration
+	 */
+	void updateMax(uint32_t& maxUs, uint64_t startUs);
+	
+#ifdef ARDUINO
+	/*!
+	 * @brief : This function retrieves the filename of a slot
+	 * 
+	 * @param[in] slot : slot index
+	 * 
+	 * @return  slot filename
+	 */
+	static String getSlotName(uint8_t slot);
+#endif
+	
+public:
+#ifdef ARDUINO
+	/*!
+	 * @brief : This function reads a slot file of the SD card
+	 */
+	static size_t sdReadSlot(void* context, uint8_t slot, uint8_t* data, size_t len);
+	
+	/*!
+	 * @brief : This function writes a slot file of the SD card, in chunks of BSEC_STATE_WRITE_CHUNK_SIZE
+	 */
+	static size_t sdWriteSlot(void* context, uint8_t slot, const uint8_t* data, size_t len);
+	
+	/*!
+	 * @brief : This function retrieves the esp_timer time
+	 */
+	static uint64_t systemClockUs(void);
+	
+	/*!
+	 * @brief : The constructor of the bsecStateStore class, with the slots on the SD card
+	 */
+	bsecStateStore() : bsecStateStore(sdReadSlot, sdWriteSlot, systemClockUs)
+	{
+	}
+#endif
+	
+	/*!
+	 * @brief : The constructor of the bsecStateStore class
+	 * 
+	 * @param[in] readSlot 	: reads a slot
+	 * @param[in] writeSlot : writes a slot
+	 * @param[in] clockUs 	: time source
+	 */
+	bsecStateStore(bsecStateReadFn readSlot, bsecStateWriteFn writeSlot, bsecStateClock clockUs) :
+		_readSlot(readSlot), _writeSlot(writeSlot), _clockUs(clockUs), _pending(false)
+	{
+	}
+	
+	/*!
+	 * @brief : This function completes the header and CRC of a snapshot
+	 * 
+	 * @param[inout] snapshot 	: snapshot, states, sensor ids and number of instances set
+	 * @param[in] seq 			: sequence number of the snapshot
+	 * @param[in] configHash 	: hash of the BSEC configuration string
+	 */
+	static void seal(bsecStateSnapshot& snapshot, uint32_t seq, uint32_t configHash);
+	
+	/*!
+	 * @brief : This function checks a snapshot read from a slot: length, magic, version, size, configuration and CRC
+	 * 
+	 * @param[in] snapshot 		: snapshot read
+	 * @param[in] len 			: bytes read
+	 * @param[in] configHash 	: hash of the BSEC configuration string
+	 * 
+	 * @return  true if the snapshot is valid
+	 */
+	static bool isValid(const bsecStateSnapshot& snapshot, size_t len, uint32_t configHash);
+	
+	/*!
+	 * @brief : This function restores the states of the latest valid snapshot, call it once the BSEC instances are started.
+	 *			Without a valid snapshot, the instances start from scratch, as does an instance whose sensor
+	 *			is not the one its state was built on.
+	 * 
+	 * @param[in] bsecMgr 	: BSEC manager running the instances
+	 * @param[in] config 	: BSEC configuration string the instances were started with, nullptr for the library default
+	 * 
+	 * @return  false if BSEC rejected a state
+	 */
+	template <typename MGR>
+	bool restore(MGR& bsecMgr, const uint8_t* config)
+	{
+		/* an invalid or missing snapshot is not an error, the instances just start from scratch */
+		if (loadLatest(config, bsecMgr.getInstanceCount()))
+		{
+			for (uint8_t i = 0; (i < _snapshot.nbInstances) && (i < _nbInstances); i++)
+			{
+				/* the state of another sensor would carry its baseline over, the instance starts from scratch */
+				if (_snapshot.sensorIds[i] != bsecMgr.getSensorId(i))
+				{
+					_nbMismatched++;
+				}
+				else if (bsecMgr.setState(i, _snapshot.states[i]))
+				{
+					_nbRestored++;
+				}
+				else
+				{
+					_setStateErrors++;
+					_lastBsecStatus = bsecMgr.getStatus(i);
+				}
+			}
+		}
+		memset(&_snapshot, 0, sizeof(_snapshot));
+		_lastCaptureUs = _clockUs();
+		return (_setStateErrors == 0);
+	}
+	
+	/*!
+	 * @brief : This function captures the state of one instance once a snapshot is due, call it from the task running BSEC
+	 * 
+	 * @param[in] bsecMgr : BSEC manager running the instances
+	 * 
+	 * @return  true once the snapshot is complete and waits to be saved
+	 */
+	template <typename MGR>
+	bool capture(MGR& bsecMgr)
+	{
+		uint8_t nbInstances = bsecMgr.getInstanceCount();
+		uint64_t startUs = _clockUs();
+		
+		if (isPending() || (nbInstances == 0) ||
+			((_nbCaptured == 0) && ((startUs - _lastCaptureUs) < BSEC_STATE_SAVE_INTERVAL_US)))
+		{
+			return false;
+		}
+		
+		/* one instance per call, the states are a few BSEC periods apart at most */
+		if (!bsecMgr.getState(_nbCaptured, _snapshot.states[_nbCaptured]))
+		{
+			/* the snapshot is dropped, the slots keep the previous one */
+			_getStateErrors++;
+			_lastBsecStatus = bsecMgr.getStatus(_nbCaptured);
+			_nbCaptured = 0;
+			_lastCaptureUs = startUs;
+			return false;
+		}
+		_snapshot.sensorIds[_nbCaptured] = bsecMgr.getSensorId(_nbCaptured);
+		updateMax(_captureMaxUs, startUs);
+		
+		if (++_nbCaptured < nbInstances)
+		{
+			return false;
+		}
+		_snapshot.nbInstances = nbInstances;
+		_nbCaptured = 0;
+		_lastCaptureUs = startUs;
+		_pending.store(true, std::memory_order_release);
+		return true;
+	}
+	
+	/*!
+	 * @brief : This function writes the complete snapshot to the older slot
+	 * 
+	 * @return  false if the write failed
+	 */
+	bool save();
+	
+	/*!
+	 * @brief : This function checks whether a complete snapshot waits to be saved
+	 * 
+	 * @return  true if a snapshot is pending
+	 */
+	bool isPending() const
+	{
+		return _pending.load(std::memory_order_acquire);
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of instances restored on start up
+	 * 
+	 * @return  number of instances
+	 */
+	uint8_t getRestoredCount() const
+	{
+		return _nbRestored;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of instances not restored on start up, their sensor was replaced
+	 * 
+	 * @return  number of instances
+	 */
+	uint8_t getMismatchedCount() const
+	{
+		return _nbMismatched;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of snapshots dropped on a getState failure
+	 */
+	uint32_t getGetStateErrors() const
+	{
+		return _getStateErrors;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of failed snapshot writes
+	 */
+	uint32_t getSaveErrors() const
+	{
+		return _saveErrors;
+	}
+	
+#ifdef ARDUINO
+	/*!
+	 * @brief : This function prints the result of the restore, the number of instances restored against the running ones
+	 * 
+	 * @param[in] out : output stream
+	 */
+	void printRestore(Print& out) const;
+	
+	/*!
+	 * @brief : This function prints the snapshot statistics, the getState and setState failures included
+	 * 
+	 * @param[in] out : output stream
+	 */
+	void printStats(Print& out) const;
+#endif
+};
+
+#endif
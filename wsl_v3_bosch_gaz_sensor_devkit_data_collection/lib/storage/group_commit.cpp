@@ -0,0 +1,167 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	group_commit.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Datalogger group commit policy
+ * 
+ * 
+ */
+
+#include "group_commit.h"
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+/* label value that never matches the label of a data row */
+#define NO_LABEL 	-1
+
+/*!
+ * @brief : This function retrieves the time since start up
+ */
+uint32_t groupCommit::systemClockMs(void)
+{
+#ifdef ARDUINO
+	return millis();
+#else
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*!
+ * @brief : The constructor of the groupCommit class, with the default policy
+ */
+groupCommit::groupCommit(groupCommitClock clockMs) : _clockMs(clockMs), _pendingBytes(0), _pendingSince(0),
+							 _pendingLabel(NO_LABEL), _flushes(0), _flushedBytes(0), _statsStart(0)
+{
+	_policy.maxBytes = LOG_FLUSH_DEFAULT_BYTES;
+	_policy.maxDelayMs = LOG_FLUSH_DEFAULT_DELAY_MS;
+	_policy.onLabelChange = LOG_FLUSH_DEFAULT_ON_LABEL;
+}
+
+/*!
+ * @brief : This function sets the flush policy
+ */
+void groupCommit::setPolicy(const logFlushPolicy& policy)
+{
+	_policy = policy;
+	_flushes = 0;
+	_flushedBytes = 0;
+	_statsStart = _clockMs();
+}
+
+/*!
+ * @brief : This function retrieves the flush policy
+ */
+const logFlushPolicy& groupCommit::getPolicy() const
+{
+	return _policy;
+}
+
+/*!
+ * @brief : This function accounts data added to the buffer of the datalogger
+ */
+void groupCommit::add(uint32_t bytes, int label)
+{
+	if (_pendingBytes == 0)
+	{
+		_pendingSince = _clockMs();
+	}
+	_pendingBytes += bytes;
+	_pendingLabel = label;
+}
+
+/*!
+ * @brief : This function checks whether the pending data has to be committed
+ */
+bool groupCommit::isDue(int label) const
+{
+	if (_pendingBytes == 0)
+	{
+		return false;
+	}
+	return (_pendingBytes >= _policy.maxBytes) ||
+		   ((uint32_t)(_clockMs() - _pendingSince) >= _policy.maxDelayMs) ||
+		   (_policy.onLabelChange && (label != _pendingLabel));
+}
+
+/*!
+ * @brief : This function accounts a flush of all pending data
+ */
+void groupCommit::committed(uint32_t bytes)
+{
+	if (bytes)
+	{
+		++_flushes;
+		_flushedBytes += bytes;
+	}
+	_pendingBytes = 0;
+}
+
+/*!
+ * @brief : This function retrieves the number of flushes since the policy was set
+ */
+uint32_t groupCommit::getFlushes() const
+{
+	return _flushes;
+}
+
+/*!
+ * @brief : This function retrieves the flushes per minute since the policy was set
+ */
+float groupCommit::getFlushesPerMinute() const
+{
+	uint32_t elapsedMs = _clockMs() - _statsStart;
+	return elapsedMs ? (_flushes * 60000.0f / elapsedMs) : 0.0f;
+}
+
+/*!
+ * @brief : This function retrieves the average bytes per flush
+ */
+uint32_t groupCommit::getAverageBytes() const
+{
+	return _flushes ? (uint32_t)(_flushedBytes / _flushes) : 0;
+}
+
+#ifdef ARDUINO
+/*!
+ * @brief : This function prints the flushes per minute and the average bytes per flush
+ */
+void groupCommit::printStats(Print& out, const char* name) const
+{
+	out.printf("%s flushes: %lu, %.1f/min, %lu bytes/flush on average\n", name, (unsigned long) getFlushes(),
+			   getFlushesPerMinute(), (unsigned long) getAverageBytes());
+}
+#endif
@@ -0,0 +1,169 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	group_commit.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Header file for the datalogger group commit policy
+ * 
+ * 
+ */
+
+#ifndef GROUP_COMMIT_H
+#define GROUP_COMMIT_H
+
+#include <stdint.h>
+#ifdef ARDUINO
+#include "Arduino.h"
+#endif
+
+/* Defaults of the flush policy, used for the keys missing in the configuration file */
+#define LOG_FLUSH_DEFAULT_BYTES 		2048
+#define LOG_FLUSH_DEFAULT_DELAY_MS 		1000
+#define LOG_FLUSH_DEFAULT_ON_LABEL 		true
+
+/*!
+ * @brief Structure to hold the flush policy of a datalogger, set from the "dataLogging" object of the configuration body.
+ *		  Buffered data is committed once any threshold is reached.
+ */
+struct logFlushPolicy
+{
+	/* pending bytes that trigger a flush */
+	uint32_t maxBytes;
+	/* durability bound: age in milliseconds of the oldest pending data that triggers a flush */
+	uint32_t maxDelayMs;
+	/* flush the pending data before data with a different label is added */
+	bool onLabelChange;
+};
+
+/*!
+ * @brief : Time source of the flush policy
+ *
+ * @return time in milliseconds, wrapping around
+ */
+typedef uint32_t (*groupCommitClock)(void);
+
+/*!
+ * @brief : Class library that decides when a datalogger commits its buffered data to the SD card,
+ *			and counts the flushes
+ */
+class groupCommit
+{
+private:
+	groupCommitClock _clockMs;
+	logFlushPolicy 	_policy;
+	uint32_t 		_pendingBytes;
+	uint32_t 		_pendingSince;
+	int 			_pendingLabel;
+	uint32_t 		_flushes;
+	uint64_t 		_flushedBytes;
+	uint32_t 		_statsStart;
+	
+public:
+	/*!
+	 * @brief : This function retrieves the time since start up, millis() on the board
+	 *
+	 * @return time in milliseconds
+	 */
+	static uint32_t systemClockMs(void);
+	
+	/*!
+	 * @brief : The constructor of the groupCommit class, with the default policy
+	 *
+	 * @param[in] clockMs : time source of the flush policy, the system clock by default
+	 */
+	explicit groupCommit(groupCommitClock clockMs = systemClockMs);
+	
+	/*!
+	 * @brief : This function sets the flush policy
+	 * 
+	 * @param[in] policy : flush policy
+	 */
+	void setPolicy(const logFlushPolicy& policy);
+	
+	/*!
+	 * @brief : This function retrieves the flush policy
+	 */
+	const logFlushPolicy& getPolicy() const;
+	
+	/*!
+	 * @brief : This function accounts data added to the buffer of the datalogger
+	 * 
+	 * @param[in] bytes : size of the data
+	 * @param[in] label : label of the data
+	 */
+	void add(uint32_t bytes, int label);
+	
+	/*!
+	 * @brief : This function checks whether the pending data has to be committed
+	 * 
+	 * @param[in] label : label of the data about to be added, or the current label
+	 *
+	 * @return true if data is pending and a threshold is reached
+	 */
+	bool isDue(int label) const;
+	
+	/*!
+	 * @brief : This function accounts a flush of all pending data
+	 * 
+	 * @param[in] bytes : bytes written to the SD card
+	 */
+	void committed(uint32_t bytes);
+	
+	/*!
+	 * @brief : This function retrieves the number of flushes since the policy was set
+	 */
+	uint32_t getFlushes() const;
+	
+	/*!
+	 * @brief : This function retrieves the flushes per minute since the policy was set
+	 */
+	float getFlushesPerMinute() const;
+	
+	/*!
+	 * @brief : This function retrieves the average bytes per flush
+	 */
+	uint32_t getAverageBytes() const;
+	
+#ifdef ARDUINO
+	/*!
+	 * @brief : This function prints the flushes per minute and the average bytes per flush
+	 * 
+	 * @param[in] out 	: output stream, e.g. Serial
+	 * @param[in] name 	: name of the datalogger
+	 */
+	void printStats(Print& out, const char* name) const;
+#endif
+};
+
+#endif
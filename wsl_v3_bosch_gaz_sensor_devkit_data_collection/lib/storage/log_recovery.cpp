@@ -0,0 +1,167 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	log_recovery.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Recovery of a log file left open by a power loss
+ * 
+ * 
+ */
+
+#include "log_recovery.h"
+#include "storage_crc.h"
+#include <string.h>
+#include <ctype.h>
+
+/*!
+ * @brief : This function finds the length of a log file from the write journal
+ */
+size_t logRecovery::checkJournal(logReadFn read, void* context, const bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS], size_t fileSize)
+{
+	size_t length = 0;
+	uint32_t checkedSeq = UINT32_MAX;
+	
+	/* from the latest write back, a torn write may have damaged the end of the previous one */
+	for (uint8_t n = 0; n < BME68X_LOG_JOURNAL_SLOTS; n++)
+	{
+		const bme68xJournalEntry* latest = nullptr;
+		for (uint8_t i = 0; i < BME68X_LOG_JOURNAL_SLOTS; i++)
+		{
+			if (journal[i].seq && (journal[i].seq < checkedSeq) && ((latest == nullptr) || (journal[i].seq > latest->seq)))
+			{
+				latest = &journal[i];
+			}
+		}
+		if (latest == nullptr)
+		{
+			break;
+		}
+		checkedSeq = latest->seq;
+		/* without an intact write, the file is kept up to the oldest write, which the later ones did not overwrite */
+		length = latest->start;
+		
+		if ((latest->start < latest->end) && (latest->end <= fileSize))
+		{
+			uint8_t chunk[LOG_RECOVERY_CHUNK_SIZE];
+			uint32_t crc = 0;
+			size_t pos = latest->start;
+			while (pos < latest->end)
+			{
+				size_t len = ((latest->end - pos) < sizeof(chunk)) ? (latest->end - pos) : sizeof(chunk);
+				if (read(context, pos, chunk, len) != len)
+				{
+					break;
+				}
+				crc = storageCrc::crc32(chunk, len, crc);
+				pos += len;
+			}
+			if ((pos == latest->end) && (crc == latest->crc))
+			{
+				length = latest->end;
+				break;
+			}
+		}
+	}
+	return length;
+}
+
+/*!
+ * @brief : This function finds the committed length of a log file
+ */
+size_t logRecovery::committedLength(logReadFn read, void* context, const bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS],
+									size_t committedLen, size_t fileSize)
+{
+	size_t journalLen = checkJournal(read, context, journal, fileSize);
+	/* the preallocated space after the committed length holds no rows, nor does a torn write */
+	if (journalLen)
+	{
+		committedLen = journalLen;
+	}
+	return (committedLen && (committedLen < fileSize)) ? committedLen : fileSize;
+}
+
+/*!
+ * @brief : This function cuts a .bmerawbin file to whole records
+ */
+size_t logRecovery::cutBinary(logReadFn read, void* context, size_t size)
+{
+	bme68xRawBinHeader binHeader;
+	if ((read(context, 0, (uint8_t*)&binHeader, sizeof(binHeader)) == sizeof(binHeader)) &&
+		(binHeader.recordSize != 0) && (binHeader.dataOffset != 0) && (binHeader.dataOffset <= size))
+	{
+		return binHeader.dataOffset + ((size - binHeader.dataOffset) / binHeader.recordSize) * binHeader.recordSize;
+	}
+	return size;
+}
+
+/*!
+ * @brief : This function cuts a .bmerawdata file after its last complete row
+ */
+size_t logRecovery::cutJson(logReadFn read, void* context, size_t size, bool& addFooter)
+{
+	/* only the tail is read, it holds the end of the last row or the start of the data block */
+	char tail[LOG_RECOVERY_TAIL_SIZE + 1];
+	size_t tailPos = (size > LOG_RECOVERY_TAIL_SIZE) ? (size - LOG_RECOVERY_TAIL_SIZE) : 0;
+	size_t tailLen = read(context, tailPos, (uint8_t*)tail, size - tailPos);
+	tail[tailLen] = '\0';
+	addFooter = false;
+	
+	if (strstr(tail, END_OF_FILE) != nullptr)
+	{
+		return size;
+	}
+	const char* dataBlock = strstr(tail, "\"dataBlock\": [");
+	const char* rowEnd = nullptr;
+	/* a complete row ends with the error code digits and a closing bracket */
+	for (size_t i = tailLen; i > 1; i--)
+	{
+		if ((tail[i - 1] == ']') && isdigit((unsigned char)tail[i - 2]))
+		{
+			rowEnd = &tail[i];
+			break;
+		}
+	}
+	if (rowEnd != nullptr && (dataBlock == nullptr || rowEnd > dataBlock))
+	{
+		addFooter = true;
+		return tailPos + (rowEnd - tail);
+	}
+	if (dataBlock != nullptr && strchr(dataBlock, '\n') != nullptr)
+	{
+		/* no row was written */
+		addFooter = true;
+		return tailPos + (strchr(dataBlock, '\n') + 1 - tail);
+	}
+	return size;
+}
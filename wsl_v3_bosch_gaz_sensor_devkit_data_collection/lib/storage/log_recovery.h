@@ -0,0 +1,143 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	log_recovery.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Recovery of a log file left open by a power loss: write journal check and cut of the incomplete end
+ * 
+ * 
+ */
+
+#ifndef LOG_RECOVERY_H
+#define LOG_RECOVERY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "raw_record.h"
+
+/* Journal entries kept in the open log marker, one per write, the oldest is overwritten */
+#define BME68X_LOG_JOURNAL_SLOTS 		8
+/* Bytes read from the end of a .bmerawdata file, at least the longest row */
+#define LOG_RECOVERY_TAIL_SIZE 			384
+/* Bytes read at once to check the CRC of a write */
+#define LOG_RECOVERY_CHUNK_SIZE 		512
+
+/*!
+ * @brief One write of the log file, recorded in the open log marker once written. On recovery the latest
+ *		  write whose CRC matches the file content gives the length of the log file, so a write torn by
+ *		  a power loss is cut off even if it overwrote the end of the previous one.
+ */
+struct __attribute__((packed)) bme68xJournalEntry
+{
+	/* 1 for the first write of a log file, 0 marks an unused entry */
+	uint32_t seq;
+	/* file positions of the written bytes */
+	uint32_t start;
+	uint32_t end;
+	/* CRC-32 of the written bytes */
+	uint32_t crc;
+};
+
+/*!
+ * @brief : Reads the log file being recovered, a File on the board, a buffer in the tests
+ *
+ * @param[in] context 	: log file
+ * @param[in] pos 		: file position
+ * @param[out] data 	: read bytes
+ * @param[in] len 		: bytes to read
+ *
+ * @return bytes read, fewer at the end of the file or on error
+ */
+typedef size_t (*logReadFn)(void* context, size_t pos, uint8_t* data, size_t len);
+
+/*!
+ * @brief : Class library that finds the valid length of a log file left open by a power loss
+ */
+class logRecovery
+{
+public:
+	/*!
+	 * @brief : This function finds the length of a log file from the write journal: the end of the latest write
+	 *			whose content is intact
+	 * 
+	 * @param[in] read 		: reads the log file
+	 * @param[in] context 	: log file
+	 * @param[in] journal 	: journal entries read from the open log marker
+	 * @param[in] fileSize 	: log file size
+	 * 
+	 * @return  log file length, 0 if the journal has no entries
+	 */
+	static size_t checkJournal(logReadFn read, void* context, const bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS], size_t fileSize);
+	
+	/*!
+	 * @brief : This function finds the committed length of a log file, from the journal, else from the length
+	 *			recorded by a marker without journal, else the file size
+	 * 
+	 * @param[in] read 			: reads the log file
+	 * @param[in] context 		: log file
+	 * @param[in] journal 		: journal entries read from the open log marker
+	 * @param[in] committedLen 	: committed length recorded in the open log marker, ignored if 0
+	 * @param[in] fileSize 		: log file size
+	 * 
+	 * @return  committed length, at most the file size
+	 */
+	static size_t committedLength(logReadFn read, void* context, const bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS],
+								  size_t committedLen, size_t fileSize);
+	
+	/*!
+	 * @brief : This function cuts a .bmerawbin file to whole records
+	 * 
+	 * @param[in] read 		: reads the log file
+	 * @param[in] context 	: log file
+	 * @param[in] size 		: committed length
+	 * 
+	 * @return  valid length, the committed length if the file header is invalid
+	 */
+	static size_t cutBinary(logReadFn read, void* context, size_t size);
+	
+	/*!
+	 * @brief : This function cuts a .bmerawdata file after its last complete row, or after the start of the
+	 *			data block if it has no row
+	 * 
+	 * @param[in] read 			: reads the log file
+	 * @param[in] context 		: log file
+	 * @param[in] size 			: committed length
+	 * @param[out] addFooter 	: true if the footer has to be written after the valid length
+	 * 
+	 * @return  valid length
+	 */
+	static size_t cutJson(logReadFn read, void* context, size_t size, bool& addFooter);
+};
+
+#endif
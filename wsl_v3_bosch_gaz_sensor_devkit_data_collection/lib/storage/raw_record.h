@@ -0,0 +1,106 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	raw_record.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Binary raw data record of the .bmerawbin log files, also the input of the .bmerawz encoder
+ * 
+ * 
+ */
+
+#ifndef RAW_RECORD_H
+#define RAW_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* File signature and layout version of the binary raw data format */
+#define BME68X_RAWBIN_MAGIC 			"BME68XRB"
+#define BME68X_RAWBIN_VERSION 			UINT16_C(1)
+/* File signature and layout version of the compressed raw data format */
+#define BME68X_RAWZ_MAGIC 				"BME68XRZ"
+/* 2: the time since power on is encoded on 64 bits, it wrapped after 49.7 days in version 1 */
+#define BME68X_RAWZ_VERSION 			UINT16_C(2)
+
+/* Records start on a sector boundary, a multiple of the record size */
+#define BME68X_RAWBIN_RECORD_SIZE 		32
+/* Marks a missing value in a one byte field of a binary record */
+#define BME68X_RAWBIN_NULL 				UINT8_C(0xFF)
+#define BME68X_RAWBIN_MODE_NULL 		UINT8_C(0x0F)
+
+/* Closes the data block of the Json log files, .bmerawdata and .bsecdata */
+#define END_OF_FILE						"\n\t    ]\n\t}\n}\n"
+
+/*!
+ * @brief One data row of a .bmerawbin file, same columns as the .bmerawdata dataBlock
+ */
+struct __attribute__((packed)) bme68xRawBinRecord
+{
+	/* low 32 bits of the time since power on, wraps after 49.7 days */
+	uint32_t timeSincePowerOn;
+	uint32_t rtcTsp;
+	uint32_t sensorId;
+	/* NaN if the sample has no data */
+	float temperature;
+	/* in hectopascals */
+	float pressure;
+	float humidity;
+	float gasResistance;
+	/* BME68X_RAWBIN_NULL if unknown, the sensor id is then invalid too */
+	uint8_t sensorIndex;
+	/* BME68X_RAWBIN_NULL if the sample has no data */
+	uint8_t gasIndex;
+	/* bits 0-3: scanning enabled, BME68X_RAWBIN_MODE_NULL if unknown; bits 4-7: label tag */
+	uint8_t modeLabel;
+	int8_t code;
+};
+
+/*!
+ * @brief Fixed header at the start of a .bmerawbin or .bmerawz file, followed by the Json header text
+ *		  (configuration, rawDataHeader and the dataColumns schema, with an empty dataBlock)
+ *		  padded with zeros up to dataOffset, where the records start. All fields are little endian.
+ *		  The record size of a .bmerawz file is 0, its records are encoded by the sampleEncoder.
+ */
+struct __attribute__((packed)) bme68xRawBinHeader
+{
+	char magic[8];
+	uint16_t version;
+	uint16_t recordSize;
+	uint32_t dataOffset;
+};
+
+static_assert(sizeof(bme68xRawBinHeader) == 16, "binary file header layout changed");
+static_assert(sizeof(bme68xRawBinRecord) == BME68X_RAWBIN_RECORD_SIZE, "binary record layout changed");
+
+#endif
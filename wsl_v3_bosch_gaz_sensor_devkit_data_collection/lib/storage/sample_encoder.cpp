@@ -0,0 +1,172 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	sample_encoder.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Delta and varint encoder of the .bmerawz raw data log files
+ * 
+ * 
+ */
+
+#include <string.h>
+#include "sample_encoder.h"
+#include "raw_record.h"
+
+/*!
+ * @brief The constructor of the sampleEncoder class
+ */
+sampleEncoder::sampleEncoder() : _blockLen(0)
+{}
+
+/*!
+ * @brief This function makes the next record start a new block
+ */
+void sampleEncoder::reset()
+{
+	_blockLen = 0;
+}
+
+/*!
+ * @brief This function writes an unsigned LEB128 varint
+ */
+size_t sampleEncoder::putVarint(uint8_t* out, uint64_t value)
+{
+	size_t len = 0;
+	
+	while (value >= 0x80)
+	{
+		out[len++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[len++] = (uint8_t)value;
+	return len;
+}
+
+/*!
+ * @brief This function writes a signed delta as zigzag varint
+ */
+size_t sampleEncoder::putDelta(uint8_t* out, uint32_t value, uint32_t previous)
+{
+	int32_t delta = (int32_t)(value - previous);
+	
+	return putVarint(out, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+}
+
+/*!
+ * @brief This function writes a signed 64 bit delta as zigzag varint
+ */
+size_t sampleEncoder::putDelta64(uint8_t* out, uint64_t value, uint64_t previous)
+{
+	int64_t delta = (int64_t)(value - previous);
+	
+	return putVarint(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+}
+
+/*!
+ * @brief This function encodes a record
+ */
+size_t sampleEncoder::encode(uint8_t* out, const bme68xRawBinRecord& record, uint64_t timeSincePowerOn)
+{
+	size_t len = 0;
+	
+	if (_blockLen == 0)
+	{
+		/* the state of a block only depends on its own records */
+		memcpy(out, RAWZ_BLOCK_SYNC, RAWZ_BLOCK_SYNC_LEN);
+		len = RAWZ_BLOCK_SYNC_LEN;
+		memset(_floatBits, 0, sizeof(_floatBits));
+		memset(_sensorIdValid, 0, sizeof(_sensorIdValid));
+		_timeSincePowerOn = 0;
+		_rtcTsp = 0;
+		_metaValid = false;
+	}
+	
+	bool hasSensor = (record.sensorIndex != BME68X_RAWBIN_NULL);
+	bool hasData = (record.gasIndex != BME68X_RAWBIN_NULL);
+	uint8_t slot = (hasSensor && (record.sensorIndex < RAWZ_MAX_SENSORS)) ? record.sensorIndex : RAWZ_MAX_SENSORS;
+	bool newId = hasSensor && !(_sensorIdValid[slot] && (_sensorId[slot] == record.sensorId));
+	bool newMeta = !(_metaValid && (_modeLabel == record.modeLabel) && (_code == record.code));
+	uint8_t tag = (hasSensor ? RAWZ_TAG_SENSOR : 0) | (newId ? RAWZ_TAG_SENSOR_ID : 0) | (hasData ? RAWZ_TAG_DATA : 0) |
+				  ((record.rtcTsp != _rtcTsp) ? RAWZ_TAG_RTC : 0) | (newMeta ? RAWZ_TAG_META : 0);
+	
+	out[len++] = tag;
+	if (hasSensor)
+	{
+		out[len++] = record.sensorIndex;
+	}
+	if (newId)
+	{
+		len += putVarint(&out[len], record.sensorId);
+		_sensorId[slot] = record.sensorId;
+		_sensorIdValid[slot] = true;
+	}
+	len += putDelta64(&out[len], timeSincePowerOn, _timeSincePowerOn);
+	_timeSincePowerOn = timeSincePowerOn;
+	if (tag & RAWZ_TAG_RTC)
+	{
+		len += putDelta(&out[len], record.rtcTsp, _rtcTsp);
+		_rtcTsp = record.rtcTsp;
+	}
+	if (hasData)
+	{
+		float values[4] = {record.temperature, record.pressure, record.humidity, record.gasResistance};
+		uint32_t unused[4] = {0, 0, 0, 0};
+		uint32_t* previous = (record.gasIndex < RAWZ_MAX_STEPS) ? _floatBits[slot][record.gasIndex] : unused;
+		
+		out[len++] = record.gasIndex;
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			uint32_t bits;
+			memcpy(&bits, &values[i], sizeof(bits));
+			len += putDelta(&out[len], bits, previous[i]);
+			previous[i] = bits;
+		}
+	}
+	if (newMeta)
+	{
+		out[len++] = record.modeLabel;
+		out[len++] = (uint8_t)record.code;
+		_modeLabel = record.modeLabel;
+		_code = record.code;
+		_metaValid = true;
+	}
+	
+	_blockLen += len;
+	if (_blockLen >= RAWZ_BLOCK_SIZE)
+	{
+		out[len++] = RAWZ_TAG_END_OF_BLOCK;
+		_blockLen = 0;
+	}
+	return len;
+}
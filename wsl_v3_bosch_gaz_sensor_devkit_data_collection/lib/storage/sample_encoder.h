@@ -0,0 +1,144 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	sample_encoder.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Header file for the delta and varint encoder of the .bmerawz raw data log files
+ * 
+ * 
+ */
+
+#ifndef SAMPLE_ENCODER_H
+#define SAMPLE_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Sensor slots of the encoder state, the last one for the rows without sensor */
+#define RAWZ_MAX_SENSORS 			8
+/* Heater profile steps with their own float state, larger gas indexes are encoded against 0 */
+#define RAWZ_MAX_STEPS 				10
+/* A block is closed once it holds that many bytes */
+#define RAWZ_BLOCK_SIZE 			8192
+/* Starts each block, the encoder state is reset there; its first byte is no valid tag, so a block
+   that was cut short, when buffered rows were dropped, ends at the next sync */
+#define RAWZ_BLOCK_SYNC 			"ZBLK"
+#define RAWZ_BLOCK_SYNC_LEN 		4
+/* Longest record: tag, sensor index, sensor id, 64 bit time since power on, RTC, gas index, 4 varints,
+   mode and label, code */
+#define RAWZ_RECORD_MAX_LEN 		(1 + 1 + 5 + 10 + 5 + 1 + 4 * 5 + 2)
+
+/* Record tag bits, telling which fields follow the tag */
+#define RAWZ_TAG_SENSOR 			UINT8_C(0x01)
+#define RAWZ_TAG_SENSOR_ID 			UINT8_C(0x02)
+#define RAWZ_TAG_DATA 				UINT8_C(0x04)
+#define RAWZ_TAG_RTC 				UINT8_C(0x08)
+#define RAWZ_TAG_META 				UINT8_C(0x10)
+/* Tag closing a block */
+#define RAWZ_TAG_END_OF_BLOCK 		UINT8_C(0x80)
+
+struct bme68xRawBinRecord;
+
+/*!
+ * @brief : Class library that encodes the raw data records into independently decodable blocks.
+ *
+ *			A block starts with RAWZ_BLOCK_SYNC and ends with RAWZ_TAG_END_OF_BLOCK, the next sync or the end of the file.
+ *			Each record is a tag byte followed by, in this order:
+ *			- the sensor index (RAWZ_TAG_SENSOR),
+ *			- the sensor id as varint, when it differs from the last one of the sensor (RAWZ_TAG_SENSOR_ID),
+ *			- the time since power on (64 bits), delta to the previous record, zigzag varint,
+ *			- the RTC time, delta to the previous record, zigzag varint, unless unchanged (RAWZ_TAG_RTC),
+ *			- the gas index and the temperature, pressure, humidity and gas resistance, each a zigzag varint
+ *			  of the delta of the IEEE-754 bit patterns to the last record of the same sensor and gas index (RAWZ_TAG_DATA),
+ *			- the mode and label byte and the code of the .bmerawbin record, unless unchanged (RAWZ_TAG_META).
+ *			The decoded floats are bit exact, so the rows print as in the .bmerawdata files.
+ */
+class sampleEncoder
+{
+private:
+	uint32_t _floatBits[RAWZ_MAX_SENSORS + 1][RAWZ_MAX_STEPS][4];
+	uint32_t _sensorId[RAWZ_MAX_SENSORS + 1];
+	bool _sensorIdValid[RAWZ_MAX_SENSORS + 1];
+	uint64_t _timeSincePowerOn;
+	uint32_t _rtcTsp;
+	uint8_t _modeLabel;
+	int8_t _code;
+	bool _metaValid;
+	size_t _blockLen;
+	
+	/*!
+	 * @brief : This function writes an unsigned LEB128 varint
+	 * 
+     * @return  number of bytes written
+	 */
+	static size_t putVarint(uint8_t* out, uint64_t value);
+	
+	/*!
+	 * @brief : This function writes a signed delta as zigzag varint
+	 * 
+     * @return  number of bytes written
+	 */
+	static size_t putDelta(uint8_t* out, uint32_t value, uint32_t previous);
+	
+	/*!
+	 * @brief : This function writes a signed 64 bit delta as zigzag varint
+	 * 
+     * @return  number of bytes written
+	 */
+	static size_t putDelta64(uint8_t* out, uint64_t value, uint64_t previous);
+	
+public:
+	/*!
+	 * @brief : The constructor of the sampleEncoder class
+	 */
+	sampleEncoder();
+	
+	/*!
+	 * @brief : This function makes the next record start a new block
+	 */
+	void reset();
+	
+	/*!
+	 * @brief : This function encodes a record, opening and closing the blocks as needed
+	 * 
+	 * @param[out] out 	: output, at least RAWZ_RECORD_MAX_LEN + RAWZ_BLOCK_SYNC_LEN + 1 bytes
+	 * @param[in] record : record to encode
+	 * @param[in] timeSincePowerOn : time since power on (ms), replaces the 32 bit one of the record
+     * 
+     * @return  number of bytes written
+	 */
+	size_t encode(uint8_t* out, const bme68xRawBinRecord& record, uint64_t timeSincePowerOn);
+};
+
+#endif
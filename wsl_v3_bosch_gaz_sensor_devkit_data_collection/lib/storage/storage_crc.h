@@ -0,0 +1,85 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	storage_crc.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	CRC-32 of the log files and snapshots, the ROM implementation on the board
+ * 
+ * 
+ */
+
+#ifndef STORAGE_CRC_H
+#define STORAGE_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef ARDUINO
+#include <rom/crc.h>
+#endif
+
+/*!
+ * @brief : Class library that computes the CRC-32 (IEEE 802.3) of the data written to the SD card
+ */
+class storageCrc
+{
+public:
+	/*!
+	 * @brief : This function calculates the CRC-32 of a buffer, table driven in the ROM on the board
+	 *
+	 * @param[in] data 	: data
+	 * @param[in] len 	: data length
+	 * @param[in] crc 	: CRC of the preceding data, to checksum data in chunks
+	 *
+	 * @return CRC-32
+	 */
+	static inline uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0)
+	{
+#ifdef ARDUINO
+		return crc32_le(crc, data, len);
+#else
+		crc = ~crc;
+		for (size_t i = 0; i < len; i++)
+		{
+			crc ^= data[i];
+			for (uint8_t bit = 0; bit < 8; bit++)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+			}
+		}
+		return ~crc;
+#endif
+	}
+};
+
+#endif
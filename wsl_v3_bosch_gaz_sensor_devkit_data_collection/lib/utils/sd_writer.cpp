@@ -0,0 +1,179 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	sd_writer.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Asynchronous SD card writer
+ * 
+ * 
+ */
+
+#include "sd_writer.h"
+
+uint8_t 				sdWriter::_buffers[SD_WRITER_BUFFER_COUNT][SD_WRITER_BUFFER_SIZE] __attribute__((aligned(4)));
+QueueHandle_t 			sdWriter::_freeQueue = nullptr;
+QueueHandle_t 			sdWriter::_jobQueue = nullptr;
+std::atomic<uint32_t> 	sdWriter::_pending(0);
+std::atomic<uint32_t> 	sdWriter::_jobs(0);
+std::atomic<uint32_t> 	sdWriter::_bytes(0);
+std::atomic<uint32_t> 	sdWriter::_drops(0);
+std::atomic<uint32_t> 	sdWriter::_dropBytes(0);
+std::atomic<uint32_t> 	sdWriter::_maxWriteMs(0);
+std::atomic<uint32_t> 	sdWriter::_highWater(0);
+
+/*!
+ * @brief This function creates the buffers and the writer task, once
+ */
+demoRetCode sdWriter::begin()
+{
+	if (_jobQueue != nullptr)
+	{
+		return EDK_OK;
+	}
+	
+	_freeQueue = xQueueCreate(SD_WRITER_BUFFER_COUNT, sizeof(uint8_t*));
+	_jobQueue = xQueueCreate(SD_WRITER_BUFFER_COUNT, sizeof(sdWriteJob));
+	if ((_freeQueue == nullptr) || (_jobQueue == nullptr))
+	{
+		return EDK_DATALOGGER_LOG_FILE_ERROR;
+	}
+	
+	for (uint8_t i = 0; i < SD_WRITER_BUFFER_COUNT; i++)
+	{
+		uint8_t* data = _buffers[i];
+		(void) xQueueSend(_freeQueue, &data, 0);
+	}
+	
+	if (xTaskCreatePinnedToCore(task, "sdWriter", SD_WRITER_TASK_STACK_SIZE, NULL, SD_WRITER_TASK_PRIORITY, NULL, SD_WRITER_CORE) != pdPASS)
+	{
+		return EDK_DATALOGGER_LOG_FILE_ERROR;
+	}
+	return EDK_OK;
+}
+
+/*!
+ * @brief This function takes a free buffer
+ */
+uint8_t* sdWriter::acquire(uint32_t timeoutMs)
+{
+	uint8_t* data = nullptr;
+	
+	if (_freeQueue != nullptr)
+	{
+		(void) xQueueReceive(_freeQueue, &data, pdMS_TO_TICKS(timeoutMs));
+	}
+	return data;
+}
+
+/*!
+ * @brief This function queues an acquired buffer to the writer task
+ */
+void sdWriter::submit(const sdWriteJob& job)
+{
+	uint32_t pending = ++_pending;
+	uint32_t highWater = _highWater.load();
+	
+	while ((pending > highWater) && !_highWater.compare_exchange_weak(highWater, pending))
+	{}
+	/* never waits, the job queue holds all buffers */
+	(void) xQueueSend(_jobQueue, &job, portMAX_DELAY);
+}
+
+/*!
+ * @brief This function returns an acquired buffer without writing it
+ */
+void sdWriter::release(uint8_t* data)
+{
+	(void) xQueueSend(_freeQueue, &data, 0);
+}
+
+/*!
+ * @brief This function accounts data dropped by a logger
+ */
+void sdWriter::drop(uint32_t bytes)
+{
+	++_drops;
+	_dropBytes += bytes;
+}
+
+/*!
+ * @brief This function waits until the writer task has written all submitted jobs
+ */
+void sdWriter::sync()
+{
+	while (_pending.load())
+	{
+		vTaskDelay(1);
+	}
+}
+
+/*!
+ * @brief The writer task
+ */
+void sdWriter::task(void* arg)
+{
+	(void) arg;
+	sdWriteJob job;
+	
+	for (;;)
+	{
+		if (xQueueReceive(_jobQueue, &job, portMAX_DELAY) != pdTRUE)
+		{
+			continue;
+		}
+		
+		uint32_t start = millis();
+		job.write(job);
+		uint32_t duration = millis() - start;
+		
+		if (duration > _maxWriteMs.load())
+		{
+			_maxWriteMs = duration;
+		}
+		++_jobs;
+		_bytes += job.len;
+		release(job.data);
+		--_pending;
+	}
+}
+
+/*!
+ * @brief This function prints the writer statistics
+ */
+void sdWriter::printStats(Print& out)
+{
+	out.printf("sd writer: %lu jobs, %lu bytes, longest write %lu ms, %lu/%u buffers queued at most, %lu drops (%lu bytes)\n",
+			   (unsigned long) _jobs.load(), (unsigned long) _bytes.load(), (unsigned long) _maxWriteMs.load(),
+			   (unsigned long) _highWater.load(), SD_WRITER_BUFFER_COUNT, (unsigned long) _drops.load(), (unsigned long) _dropBytes.load());
+}
@@ -0,0 +1,206 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	sd_writer.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Header file for the asynchronous SD card writer
+ * 
+ * 
+ */
+
+#ifndef SD_WRITER_H
+#define SD_WRITER_H
+
+#include "Arduino.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "demo_app.h"
+
+/* Buffers shared by all dataloggers: one being filled by each logger, the others queued or being written */
+#define SD_WRITER_BUFFER_COUNT 			4
+#define SD_WRITER_BUFFER_SIZE 			4096
+/* Backpressure: time a logger waits for a free buffer before its data is dropped */
+#define SD_WRITER_ACQUIRE_TIMEOUT_MS 	100
+/* The writer also creates the rotated log files, which copies the configuration line by line */
+#define SD_WRITER_TASK_STACK_SIZE 		6144
+/* Above the logging task on the same core, the writer mostly waits for the card */
+#define SD_WRITER_TASK_PRIORITY 		2
+#define SD_WRITER_CORE 					0
+
+struct sdWriteJob;
+
+/*!
+ * @brief Function run by the writer task to commit a job, it owns the file of its logger
+ */
+typedef void (*sdWriteFunction)(const sdWriteJob& job);
+
+/*!
+ * @brief Structure of a buffer handed to the writer task
+ */
+struct sdWriteJob
+{
+	sdWriteFunction write;
+	/* logger the job belongs to */
+	void* context;
+	uint8_t* data;
+	uint32_t len;
+	/* file position of the data, as defined by the logger */
+	uint32_t offset;
+	/* logger specific flags */
+	uint32_t flags;
+};
+
+/*!
+ * @brief : Print adapter filling a writer buffer, so that the rows can be formatted with the Print functions
+ */
+class sdWriterBuffer : public Print
+{
+private:
+	uint8_t* _data;
+	size_t _len;
+	
+public:
+	sdWriterBuffer(uint8_t* data) : _data(data), _len(0) {}
+	
+	size_t write(uint8_t c) override
+	{
+		return write(&c, 1);
+	}
+	
+	size_t write(const uint8_t* buffer, size_t size) override
+	{
+		if (size > (SD_WRITER_BUFFER_SIZE - _len))
+		{
+			size = SD_WRITER_BUFFER_SIZE - _len;
+		}
+		memcpy(&_data[_len], buffer, size);
+		_len += size;
+		return size;
+	}
+	
+	inline uint8_t* data() const
+	{
+		return _data;
+	}
+	
+	inline size_t length() const
+	{
+		return _len;
+	}
+	
+	inline size_t available() const
+	{
+		return SD_WRITER_BUFFER_SIZE - _len;
+	}
+};
+
+/*!
+ * @brief : Class library of the writer task, which commits the buffers of the dataloggers to the SD card
+ *			so that the SD latency does not block the acquisition
+ */
+class sdWriter
+{
+private:
+	/* word aligned, the SD driver transfers whole sectors from them without copying */
+	static uint8_t 					_buffers[SD_WRITER_BUFFER_COUNT][SD_WRITER_BUFFER_SIZE] __attribute__((aligned(4)));
+	static QueueHandle_t 			_freeQueue;
+	static QueueHandle_t 			_jobQueue;
+	/* jobs submitted and not yet written */
+	static std::atomic<uint32_t> 	_pending;
+	static std::atomic<uint32_t> 	_jobs;
+	static std::atomic<uint32_t> 	_bytes;
+	static std::atomic<uint32_t> 	_drops;
+	static std::atomic<uint32_t> 	_dropBytes;
+	static std::atomic<uint32_t> 	_maxWriteMs;
+	static std::atomic<uint32_t> 	_highWater;
+	
+	/*!
+	 * @brief : The writer task, it runs the jobs in submission order
+	 */
+	static void task(void* arg);
+	
+public:
+	/*!
+	 * @brief : This function creates the buffers and the writer task, once
+	 * 
+     * @return  bosch error code
+	 */
+	static demoRetCode begin();
+	
+	/*!
+	 * @brief : This function takes a free buffer of SD_WRITER_BUFFER_SIZE bytes, waiting for the card if none is free
+	 * 
+	 * @param[in] timeoutMs : longest wait in milliseconds
+	 * 
+     * @return  word aligned buffer, nullptr on timeout
+	 */
+	static uint8_t* acquire(uint32_t timeoutMs = SD_WRITER_ACQUIRE_TIMEOUT_MS);
+	
+	/*!
+	 * @brief : This function queues an acquired buffer to the writer task, which frees it once written
+	 * 
+	 * @param[in] job : job, its data points to the start of an acquired buffer
+	 */
+	static void submit(const sdWriteJob& job);
+	
+	/*!
+	 * @brief : This function returns an acquired buffer without writing it
+	 * 
+	 * @param[in] data : acquired buffer
+	 */
+	static void release(uint8_t* data);
+	
+	/*!
+	 * @brief : This function accounts data dropped by a logger because no buffer was free
+	 * 
+	 * @param[in] bytes : size of the dropped data, 0 if unknown
+	 */
+	static void drop(uint32_t bytes);
+	
+	/*!
+	 * @brief : This function waits until the writer task has written all submitted jobs
+	 */
+	static void sync();
+	
+	/*!
+	 * @brief : This function prints the writer statistics
+	 * 
+	 * @param[in] out : output stream
+	 */
+	static void printStats(Print& out);
+};
+
+#endif
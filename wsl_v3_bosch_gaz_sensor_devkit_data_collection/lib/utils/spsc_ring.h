@@ -0,0 +1,210 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	spsc_ring.h
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Lock-free single producer, single consumer ring buffer
+ * 
+ * 
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/*!
+ * @brief : Fixed capacity ring buffer, safe for exactly one producer and one consumer task running
+ *			concurrently, on the same or different cores. Items are copied in and out.
+ *
+ * @tparam T 		: item type, trivially copyable
+ * @tparam CAPACITY : number of items, a power of two
+ */
+template <typename T, uint32_t CAPACITY>
+class spscRing
+{
+	static_assert((CAPACITY >= 2) && ((CAPACITY & (CAPACITY - 1)) == 0), "CAPACITY must be a power of two");
+	
+private:
+	/* free running indexes, the slot is the index modulo the capacity */
+	std::atomic<uint32_t> 	_head;
+	std::atomic<uint32_t> 	_tail;
+	std::atomic<uint32_t> 	_overflows;
+	std::atomic<uint32_t> 	_highWater;
+	T 						_items[CAPACITY];
+	
+public:
+	/*!
+	 * @brief : The constructor of the spscRing class
+	 */
+	spscRing() : _head(0), _tail(0), _overflows(0), _highWater(0)
+	{
+	}
+	
+	/*!
+	 * @brief : This function appends an item, producer side only
+	 * 
+	 * @param[in] item : item to append
+	 *
+	 * @return true on success, false if the ring is full; the item is dropped and counted as overflow
+	 */
+	bool push(const T& item)
+	{
+		uint32_t head = _head.load(std::memory_order_relaxed);
+		uint32_t used = head - _tail.load(std::memory_order_acquire);
+		
+		if (used >= CAPACITY)
+		{
+			_overflows.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		_items[head & (CAPACITY - 1)] = item;
+		_head.store(head + 1, std::memory_order_release);
+		
+		if (used + 1 > _highWater.load(std::memory_order_relaxed))
+		{
+			_highWater.store(used + 1, std::memory_order_relaxed);
+		}
+		return true;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the free slot the next item is built in, producer side only.
+	 *			The item is appended by commit(), until then the ring is unchanged.
+	 *
+	 * @return pointer to the free slot, nullptr if the ring is full; the item is then counted as overflow
+	 */
+	T* reserve()
+	{
+		uint32_t head = _head.load(std::memory_order_relaxed);
+		
+		if ((head - _tail.load(std::memory_order_acquire)) >= CAPACITY)
+		{
+			_overflows.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		return &_items[head & (CAPACITY - 1)];
+	}
+	
+	/*!
+	 * @brief : This function appends the item built in the slot returned by reserve(), producer side only
+	 */
+	void commit()
+	{
+		uint32_t head = _head.load(std::memory_order_relaxed);
+		uint32_t used = head - _tail.load(std::memory_order_acquire);
+		
+		_head.store(head + 1, std::memory_order_release);
+		if (used + 1 > _highWater.load(std::memory_order_relaxed))
+		{
+			_highWater.store(used + 1, std::memory_order_relaxed);
+		}
+	}
+	
+	/*!
+	 * @brief : This function copies the oldest item without removing it, consumer side only
+	 * 
+	 * @param[out] item : oldest item
+	 *
+	 * @return true on success, false if the ring is empty
+	 */
+	bool peek(T& item) const
+	{
+		uint32_t tail = _tail.load(std::memory_order_relaxed);
+		
+		if (tail == _head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		item = _items[tail & (CAPACITY - 1)];
+		return true;
+	}
+	
+	/*!
+	 * @brief : This function removes the oldest item, consumer side only
+	 * 
+	 * @param[out] item : oldest item
+	 *
+	 * @return true on success, false if the ring is empty
+	 */
+	bool pop(T& item)
+	{
+		uint32_t tail = _tail.load(std::memory_order_relaxed);
+		
+		if (tail == _head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		item = _items[tail & (CAPACITY - 1)];
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of stored items, exact from either side,
+	 *			a snapshot from any other task
+	 */
+	uint32_t size() const
+	{
+		return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+	}
+	
+	/*!
+	 * @brief : This function retrieves the capacity of the ring
+	 */
+	static constexpr uint32_t capacity()
+	{
+		return CAPACITY;
+	}
+	
+	/*!
+	 * @brief : This function retrieves the number of items dropped because the ring was full
+	 */
+	uint32_t getOverflows() const
+	{
+		return _overflows.load(std::memory_order_relaxed);
+	}
+	
+	/*!
+	 * @brief : This function retrieves the highest number of items stored at once
+	 */
+	uint32_t getHighWater() const
+	{
+		return _highWater.load(std::memory_order_relaxed);
+	}
+};
+
+#endif
@@ -45,13 +45,15 @@
 /* own header include */
 #include "utils.h"
 #include <math.h>
+#include "storage_crc.h"
 
-uint64_t 	utils::_tickMs;
-uint64_t 	utils::_tickOverFlowCnt;
 // SDFS		utils::_sd = SD;
 SPIClass* 	utils::hspi = NULL;
 RTC_PCF8523 utils::_rtc;
 char 		utils::_fileSeed[DATA_LOG_FILE_SEED_SIZE];
+uint32_t 	utils::_bootPhaseMs[BOOT_PHASE_COUNT];
+clockParams utils::_clock = {0, 0, 0, 0, false};
+std::atomic<uint32_t> utils::_clockSeq(0);
 
 /*!
  * @brief This function creates the random alphanumeric file seed for the log file
@@ -83,7 +85,11 @@ demoRetCode utils::begin()
 		pinMode(PIN_SD_CS, OUTPUT);
 	}	
 	
-	if (!SD.begin(PIN_SD_CS, *utils::hspi, SPI_SPEED_COM))
+	commMuxLockBus(COMM_MUX_OWNER_STORAGE);
+	bool sdReady = SD.begin(PIN_SD_CS, *utils::hspi, SPI_SPEED_COM);
+	commMuxUnlockBus(COMM_MUX_OWNER_STORAGE);
+
+	if (!sdReady)
 	{
 		retCode = EDK_SD_CARD_INIT_ERROR;
 	}
@@ -97,6 +103,10 @@ demoRetCode utils::begin()
 		
 		retCode = EDK_DATALOGGER_RTC_ADJUST_WARNING;
 	}
+	if (sdReady)
+	{
+		syncClock();
+	}
 	randomSeed(analogRead(PIN_TO_GENARATE_RANDOM_SEED));
 	createFileSeed();
 
@@ -111,6 +121,166 @@ RTC_PCF8523& utils::getRtc()
 	return _rtc;
 }
 
+/*!
+ * @brief This function extrapolates the wall clock to an esp_timer time
+ */
+int64_t utils::extrapolateClock(const clockParams& clock, int64_t timerUs)
+{
+	int64_t elapsedUs = timerUs - clock.timerUs;
+	
+	return clock.baseUs + elapsedUs + (elapsedUs * clock.driftPpm) / 1000000;
+}
+
+/*!
+ * @brief This function reads the RTC and corrects the wall clock
+ */
+void utils::syncClock()
+{
+	int64_t rtcUs;
+	{
+		/* the RTC shares the Wire bus with the chip select expander */
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		rtcUs = (int64_t)_rtc.now().unixtime() * 1000000;
+	}
+	/* the single writer reads its own parameters without the sequence */
+	clockParams clock = _clock;
+	uint32_t seq = _clockSeq.load(std::memory_order_relaxed);
+	
+	_clockSeq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	/* read once the sequence is odd: a reader done with the previous parameters read the esp_timer before */
+	int64_t timerUs = esp_timer_get_time();
+	if (!clock.valid)
+	{
+		clock.baseUs = rtcUs;
+		clock.valid = true;
+	}
+	else
+	{
+		/* the RTC only has seconds: the clock is corrected once it leaves the second the RTC reads */
+		int64_t clockUs = extrapolateClock(clock, timerUs);
+		int64_t errorUs = 0;
+		if (clockUs < rtcUs)
+		{
+			errorUs = rtcUs - clockUs;
+		}
+		else if (clockUs >= (rtcUs + 1000000))
+		{
+			errorUs = (rtcUs + 999999) - clockUs;
+		}
+		/* a large error is an RTC adjustment, not a drift, the clock follows it even backwards */
+		int64_t elapsedUs = timerUs - clock.timerUs;
+		if ((errorUs <= -1000000) || (errorUs >= 1000000))
+		{
+			clock.floorUs = 0;
+		}
+		else
+		{
+			/* a backward correction holds the clock until it catches up */
+			clock.floorUs = (clockUs > clock.floorUs) ? clockUs : clock.floorUs;
+			if (elapsedUs > 0)
+			{
+				int64_t driftPpm = clock.driftPpm + (errorUs * 1000000) / elapsedUs;
+				driftPpm = (driftPpm > CLOCK_MAX_DRIFT_PPM) ? CLOCK_MAX_DRIFT_PPM : driftPpm;
+				driftPpm = (driftPpm < -CLOCK_MAX_DRIFT_PPM) ? -CLOCK_MAX_DRIFT_PPM : driftPpm;
+				clock.driftPpm = (int32_t)driftPpm;
+			}
+		}
+		clock.baseUs = clockUs + errorUs;
+	}
+	clock.timerUs = timerUs;
+	
+	volatile clockParams* published = &_clock;
+	published->baseUs = clock.baseUs;
+	published->timerUs = clock.timerUs;
+	published->driftPpm = clock.driftPpm;
+	published->floorUs = clock.floorUs;
+	published->valid = clock.valid;
+	_clockSeq.store(seq + 2, std::memory_order_release);
+}
+
+/*!
+ * @brief This function reads the RTC once CLOCK_RESYNC_INTERVAL_US passed since the last read
+ */
+void utils::serviceClock()
+{
+	if (!_clock.valid || ((esp_timer_get_time() - _clock.timerUs) >= (int64_t)CLOCK_RESYNC_INTERVAL_US))
+	{
+		syncClock();
+	}
+}
+
+/*!
+ * @brief This function reads the published clock parameters and the esp_timer time without a lock
+ */
+int64_t utils::readClock(clockParams& clock)
+{
+	const volatile clockParams* published = &_clock;
+	int64_t timerUs;
+	uint32_t seq;
+	
+	do
+	{
+		seq = _clockSeq.load(std::memory_order_acquire);
+		clock.baseUs = published->baseUs;
+		clock.timerUs = published->timerUs;
+		clock.driftPpm = published->driftPpm;
+		clock.floorUs = published->floorUs;
+		clock.valid = published->valid;
+		/* within the sequence, so that the next correction starts from a time at least as late */
+		timerUs = esp_timer_get_time();
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((seq & 1) || (seq != _clockSeq.load(std::memory_order_relaxed)));
+	
+	return timerUs;
+}
+
+/*!
+ * @brief This function converts an esp_timer time to the wall clock in microseconds
+ */
+uint64_t utils::clockAt(const clockParams& clock, int64_t timerUs)
+{
+	if (!clock.valid)
+	{
+		return 0;
+	}
+	int64_t clockUs = extrapolateClock(clock, timerUs);
+	/* the floor keeps the clock monotonic from the last correction on, earlier times are converted as they are */
+	if ((timerUs >= clock.timerUs) && (clockUs < clock.floorUs))
+	{
+		clockUs = clock.floorUs;
+	}
+	return (uint64_t)clockUs;
+}
+
+/*!
+ * @brief This function retrieves the wall clock in microseconds
+ */
+uint64_t utils::getUnixTimeUs()
+{
+	clockParams clock;
+	int64_t timerUs = readClock(clock);
+	return clockAt(clock, timerUs);
+}
+
+/*!
+ * @brief This function retrieves the wall clock in seconds
+ */
+uint32_t utils::getUnixTime()
+{
+	return (uint32_t)(getUnixTimeUs() / 1000000);
+}
+
+/*!
+ * @brief This function converts an esp_timer time stamp to the wall clock in seconds
+ */
+uint32_t utils::getUnixTime(uint64_t tickUs)
+{
+	clockParams clock;
+	(void) readClock(clock);
+	return (uint32_t)(clockAt(clock, (int64_t)tickUs) / 1000000);
+}
+
 /*!
  * @brief This function retrieves the created file seed
  */	
@@ -139,7 +309,7 @@ String utils::getMacAddress()
 String utils::getDateTime()
 {
 	char timeBuffer[20];
-	DateTime date = _rtc.now();
+	DateTime date(getUnixTime());
 	
 	sprintf(timeBuffer, "%d_%02d_%02d_%02d_%02d", date.year(), date.month(), date.day(), date.hour(), date.minute());
 	
@@ -151,6 +321,7 @@ String utils::getDateTime()
  */
 bool utils::getFileWithExtension(String& fName, const String& extension)
 {
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
 	File root = SD.open("/");
 	File file;
 	// char fileName[90];
@@ -185,11 +356,13 @@ demoRetCode utils::getBsecConfig(const String& fileName, uint8_t configStr[BSEC_
 {
 	demoRetCode retCode = EDK_OK;
 	uint32_t configStrLen;
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
 	
-	File configFile = SD.open(fileName, FILE_WRITE);
+	/* read only, opening for writing would truncate the file */
+	File configFile = SD.open(fileName, FILE_READ);
 	if (!configFile)
 	{
-		retCode = EDK_BSEC_CONFIG_STR_FILE_ERROR;
+		return EDK_BSEC_CONFIG_STR_FILE_ERROR;
 	}
 	configStrLen = configFile.size();
 	if (configStrLen != BSEC_MAX_PROPERTY_BLOB_SIZE)
@@ -200,19 +373,48 @@ demoRetCode utils::getBsecConfig(const String& fileName, uint8_t configStr[BSEC_
 	{
 		retCode = EDK_BSEC_CONFIG_STR_READ_ERROR;
 	}
+	configFile.close();
 	return retCode;
 }
 
 /*!
- * @brief This function returns the tick value (ms)
+ * @brief This function calculates the CRC-32 of a buffer
  */
-uint64_t utils::getTickMs(void)
+uint32_t utils::crc32(const uint8_t* data, size_t len, uint32_t crc)
 {
-	uint64_t timeMs = millis(); /* An overflow occurred */
-	if (_tickMs > timeMs) 
-	{ 
-		_tickOverFlowCnt++;
+	return storageCrc::crc32(data, len, crc);
+}
+
+/*!
+ * @brief This function records the time since power on at which a boot phase completed
+ */
+void utils::setBootPhase(bootPhase phase)
+{
+	if ((phase < BOOT_PHASE_COUNT) && (_bootPhaseMs[phase] == 0))
+	{
+		_bootPhaseMs[phase] = millis();
 	}
-	_tickMs = timeMs;
-	return timeMs + (_tickOverFlowCnt * INT64_C(0xFFFFFFFF));
+}
+
+/*!
+ * @brief This function retrieves the completion time of a boot phase
+ */
+uint32_t utils::getBootPhase(bootPhase phase)
+{
+	return (phase < BOOT_PHASE_COUNT) ? _bootPhaseMs[phase] : 0;
+}
+
+/*!
+ * @brief This function retrieves the name of a boot phase
+ */
+const char* utils::getBootPhaseName(bootPhase phase)
+{
+	static const char* const bootPhaseNames[BOOT_PHASE_COUNT] = {
+		"storageReady",
+		"configLoaded",
+		"sensorsInitialized",
+		"sensorsConfigured",
+		"firstSample"
+	};
+	return (phase < BOOT_PHASE_COUNT) ? bootPhaseNames[phase] : "";
 }
@@ -49,17 +49,24 @@
 #include <SD.h>
 #include <RTClib.h>
 #include "demo_app.h"
+#include "commMux.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <atomic>
 
 #define BME68X_RAWDATA_FILE_EXT 		".bmerawdata"
+#define BME68X_RAWBIN_FILE_EXT 			".bmerawbin"
+#define BME68X_RAWZ_FILE_EXT 			".bmerawz"
 #define BME68X_CONFIG_FILE_EXT 			".bmeconfig"
+#define BME68X_PROFILE_CACHE_FILE_EXT 	".bmecache"
 #define BSEC_DATA_FILE_EXT 				".bsecdata"
 #define BSEC_CONFIG_FILE_EXT 			".config"
+#define BSEC_STATE_FILE_EXT 			".bsecstate"
 #define FILE_SIZE_LIMIT 				311427059
 #define TIMEZONE						2.0
 #define DATA_LOG_FILE_SEED_SIZE 		17
 #define PIN_SD_CS 						34
 #define PIN_TO_GENARATE_RANDOM_SEED     3  // This pin must not be used by any other protocol or function
-#define END_OF_FILE						"\n\t    ]\n\t}\n}\n"
 
 #define HSPI_MISO   38
 #define HSPI_MOSI   33
@@ -67,16 +74,68 @@
 #define HSPI_SS	   -1	// All the connected slave on the h_spi bus will have manuel slave select control
 #define SPI_SPEED_COM	1000000
 
+/* The wall clock is read from the RTC at boot and then at this interval by the logging task, extrapolated from
+   the esp_timer in between */
+#define CLOCK_RESYNC_INTERVAL_US 		UINT64_C(600000000)
+/* Limit of the frequency correction of the esp_timer against the RTC */
+#define CLOCK_MAX_DRIFT_PPM 			500
+
 #define I2C_SDA 40
 #define I2C_SCL 41 
 
+/*!
+ * @brief Wall clock parameters published at each RTC read
+ */
+struct clockParams
+{
+	/* unix time and esp_timer time at the last RTC read */
+	int64_t baseUs;
+	int64_t timerUs;
+	/* frequency correction of the esp_timer */
+	int32_t driftPpm;
+	/* latest time served before the last correction, the clock does not go below it */
+	int64_t floorUs;
+	bool valid;
+};
+
 class utils
 {
 private:
-	static uint64_t 	_tickMs;
-	static uint64_t 	_tickOverFlowCnt;
 	static RTC_PCF8523 	_rtc;
 	static char 		_fileSeed[DATA_LOG_FILE_SEED_SIZE];
+	static uint32_t 	_bootPhaseMs[BOOT_PHASE_COUNT];
+	/* wall clock, written by syncClock only; odd sequence while it is written, the readers then retry */
+	static clockParams 	_clock;
+	static std::atomic<uint32_t> _clockSeq;
+	
+	/*!
+	 * @brief : This function extrapolates the wall clock to an esp_timer time
+	 *
+	 * @param[in] clock 	: clock parameters
+	 * @param[in] timerUs 	: esp_timer time
+	 *
+	 * @return unix time in microseconds
+	 */
+	static int64_t extrapolateClock(const clockParams& clock, int64_t timerUs);
+	
+	/*!
+	 * @brief : This function reads the published clock parameters without a lock
+	 *
+	 * @param[out] clock 	: clock parameters
+	 *
+	 * @return esp_timer time read with the parameters
+	 */
+	static int64_t readClock(clockParams& clock);
+	
+	/*!
+	 * @brief : This function converts an esp_timer time to the wall clock
+	 *
+	 * @param[in] clock 	: clock parameters
+	 * @param[in] timerUs 	: esp_timer time
+	 *
+	 * @return unix time in microseconds, 0 if the clock was never set
+	 */
+	static uint64_t clockAt(const clockParams& clock, int64_t timerUs);
 	
 	/*!
 	 * @brief : This function creates the random alphanumeric file seed for the log file
@@ -106,6 +165,42 @@ public:
 	 */
 	static RTC_PCF8523&	getRtc();
 	
+	/*!
+	 * @brief : This function reads the RTC and corrects the wall clock, the time served stays monotonic.
+	 *			Only the clock owner calls it: the setup before the tasks start, then the logging task.
+	 */
+	static void syncClock();
+	
+	/*!
+	 * @brief : This function reads the RTC once CLOCK_RESYNC_INTERVAL_US passed since the last read,
+	 *			called by the logging task, the clock owner
+	 */
+	static void serviceClock();
+	
+	/*!
+	 * @brief : This function retrieves the wall clock without an RTC read nor a lock, from any task
+	 *
+	 * @return unix time in microseconds
+	 */
+	static uint64_t getUnixTimeUs();
+	
+	/*!
+	 * @brief : This function retrieves the wall clock in seconds, same as getRtc().now().unixtime() without the I2C read
+	 *
+	 * @return unix time in seconds
+	 */
+	static uint32_t getUnixTime();
+	
+	/*!
+	 * @brief : This function converts an esp_timer time stamp taken earlier to the wall clock in seconds, so that
+	 *			time critical tasks stamp only the tick and the logging task converts it
+	 *
+	 * @param[in] tickUs : esp_timer time, as returned by getTickUs()
+	 *
+	 * @return unix time in seconds
+	 */
+	static uint32_t getUnixTime(uint64_t tickUs);
+	
 	/*!
 	 * @brief : This function retrieves the created file seed
 	 *
@@ -147,12 +242,63 @@ public:
 	 */
 	static demoRetCode getBsecConfig(const String& fileName, uint8_t configStr[BSEC_MAX_PROPERTY_BLOB_SIZE]);
 	
+	/*!
+	 * @brief : This function returns the time since power on from the 64 bit esp_timer, which does not wrap
+	 *
+	 * @return tick value in microseconds
+	 */
+	static inline uint64_t getTickUs(void)
+	{
+		return (uint64_t) esp_timer_get_time();
+	}
+	
 	/*!
 	 * @brief : This function returns the tick value (ms)
 	 *
 	 * @return tick value in milliseconds
 	 */
-	static uint64_t getTickMs(void);
+	static inline uint64_t getTickMs(void)
+	{
+		return getTickUs() / 1000;
+	}
+	
+	/*!
+	 * @brief : This function calculates the CRC-32 (IEEE 802.3) of a buffer, chained over several buffers
+	 *			by passing the previous result
+	 *
+	 * @param[in] data 	: buffer
+	 * @param[in] len 	: buffer length
+	 * @param[in] crc 	: CRC of the previous buffers, 0 for the first one
+	 *
+	 * @return CRC of all buffers
+	 */
+	static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+	
+	/*!
+	 * @brief : This function records the time since power on at which a boot phase completed,
+	 *			only the first completion is kept
+	 *
+	 * @param[in] phase : the completed boot phase
+	 */
+	static void setBootPhase(bootPhase phase);
+	
+	/*!
+	 * @brief : This function retrieves the completion time of a boot phase
+	 *
+	 * @param[in] phase : the boot phase
+	 *
+	 * @return time since power on in milliseconds, 0 if the phase has not completed yet
+	 */
+	static uint32_t getBootPhase(bootPhase phase);
+	
+	/*!
+	 * @brief : This function retrieves the name of a boot phase, as written to the log header
+	 *
+	 * @param[in] phase : the boot phase
+	 *
+	 * @return the boot phase name
+	 */
+	static const char* getBootPhaseName(bootPhase phase);
 };
 
 #endif
\ No newline at end of file
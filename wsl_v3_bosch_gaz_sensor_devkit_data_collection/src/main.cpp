@@ -54,9 +54,13 @@
 #include <label_provider.h>
 #include <led_controller.h>
 #include <sensor_manager.h>
+#include <bsec_manager.h>
+#include <bsec_state_store.h>
 // #include <ble_controller.h>
 #include <bsec2.h>
 #include <utils.h>
+#include <spsc_ring.h>
+#include <atomic>
 #include <pins_arduino.h>
 
 
@@ -75,15 +79,50 @@
 
 /*! BUFF_SIZE determines the size of the buffer */
 #define BUFF_SIZE 10
+/*! Serial command that dumps the bus transaction counters */
+#define CMD_BUS_STATS 's'
+/*! Upper bound of the idle wait, keeps the led, label and serial handling responsive */
+#define MAX_IDLE_WAIT_MS 50
+/*! Capacity of the sample ring between the acquisition and the logging task, a power of two */
+#define SAMPLE_RING_SIZE 64
+/*! Capacity of the output ring between the BSEC callback and the BSEC logging task, a power of two */
+#define BSEC_RING_SIZE 32
+/*! Acquisition runs next to the loop task on the application core, logging and the SD writer on the protocol core, which is idle without radio */
+#define ACQUISITION_CORE 1
+#define LOGGING_CORE 0
+#define ACQUISITION_TASK_STACK_SIZE 4096
+#define LOGGING_TASK_STACK_SIZE 8192
+#define BSEC_TASK_STACK_SIZE 8192
+/*! Acquisition preempts the loop task, which only handles the led, label and serial commands */
+#define ACQUISITION_TASK_PRIORITY 2
+#define LOGGING_TASK_PRIORITY 1
+/*! Raw data log format, build with BME68X_LOG_BINARY to write compact .bmerawbin files instead of .bmerawdata,
+	with BME68X_LOG_COMPRESSED for the delta and varint encoded .bmerawz files */
+#ifdef BME68X_LOG_BINARY
+#define BME68X_LOG_FORMAT BME68X_LOG_FORMAT_BINARY
+#elif defined(BME68X_LOG_COMPRESSED)
+#define BME68X_LOG_FORMAT BME68X_LOG_FORMAT_COMPRESSED
+#else
+#define BME68X_LOG_FORMAT BME68X_LOG_FORMAT_JSON
+#endif
+/*! Build with BSEC_LOGGING to run BSEC on all 8 sensors and log its outputs instead of the raw data,
+	the BSEC configuration string file is then required */
+#ifdef BSEC_LOGGING
+#define DEMO_DEFAULT_MODE DEMO_BLE_STREAMING_MODE
+#else
+#define DEMO_DEFAULT_MODE DEMO_DATALOGGER_MODE
+#endif
 
 /*!
- * @brief : This function is called by the BSEC library when a new output is available
+ * @brief : This function is called by the BSEC manager when a new output of a sensor is available
  *
- * @param[in] input 	: BME68X data
- * @param[in] outputs	: BSEC output data
+ * @param[in] num 			: sensor number
+ * @param[in] sensorId 		: unique id of the sensor
+ * @param[in] sensorMode 	: operation mode of the sensor
+ * @param[in] input 		: BME68X data
+ * @param[in] outputs		: BSEC output data
  */
-// void bsecCallBack(const bme68x_data input, const bsecOutputs outputs);
-void bsecCallBack(const bme68x_data input, const bsecOutputs outputs, Bsec2 bsec);
+void bsecCallBack(uint8_t num, uint32_t sensorId, uint8_t sensorMode, const bme68x_data& input, const bsecOutputs& outputs);
 
 /*!
  * @brief : This function handles sensor manager and BME68X datalogger configuration
@@ -104,16 +143,73 @@ demoRetCode configureSensorLogging(const String& bmeExtension);
  */
 demoRetCode configureBsecLogging(const String& bsecExtension, uint8_t bsecConfigStr[BSEC_MAX_PROPERTY_BLOB_SIZE]);
 
+/*!
+ * @brief : This task collects the due sensors and pushes the samples to the sample ring
+ *
+ * @param[in] arg : unused
+ */
+void acquisitionTask(void* arg);
+
+/*!
+ * @brief : This task runs the BSEC instances of all sensors and writes their outputs to the log file
+ *
+ * @param[in] arg : unused
+ */
+void bsecTask(void* arg);
+
+/*!
+ * @brief : This task pops the samples from the sample ring and writes them to the log file
+ *
+ * @param[in] arg : unused
+ */
+void loggingTask(void* arg);
+
+/*!
+ * @brief : This task pops the BSEC outputs from the output ring and writes them to the log file
+ *
+ * @param[in] arg : unused
+ */
+void bsecLoggingTask(void* arg);
+
+/*!
+ * @brief : This function writes the buffered BSEC outputs to the log file
+ */
+void writeBsecBuffer();
+
+/*!
+ * @brief : This function records the result of a task step in the status of the task, the first error is kept
+ *
+ * @param[inout] status	: status of the calling task, written by this task only
+ * @param[in] code 		: result of the step
+ */
+void setTaskStatus(std::atomic<demoRetCode>& status, demoRetCode code);
+
+/*!
+ * @brief : This function retrieves the status of the application
+ *
+ * @return  first error of the setup and the tasks, else the setup return code
+ */
+demoRetCode getAppStatus();
+
+/*!
+ * @brief : This function tells whether the logging goes on. Sensor errors of the acquisition task are
+ *			logged with the samples and kept in its status, they do not stop the application.
+ *
+ * @return  false once the setup, a logging task or the BSEC task failed
+ */
+bool isAppRunning();
+
 uint8_t 				bsecConfig[BSEC_MAX_PROPERTY_BLOB_SIZE];
-Bsec2 					bsec2;
+bsecManager 			bsecMgr;
+bsecStateStore 			bsecState;
 // bleController  			bleCtlr(bleMessageReceived);
 labelProvider 			labelPvr;
 ledController			ledCtlr;
 sensorManager 			sensorMgr;
 bme68xDataLogger		bme68xDlog;
 bsecDataLogger 			bsecDlog;
+/* return code of the setup, written before the tasks start */
 demoRetCode				retCode;
-uint8_t					bsecSelectedSensor;
 String 					bme68xConfigFile, bsecConfigFile;
 demoAppMode				appMode;
 gasLabel 				label;
@@ -122,6 +218,16 @@ commMux					comm;
 
 static volatile uint8_t buffCount = 0;
 static bsecDataLogger::SensorIoData buff[BUFF_SIZE];
+static bme68xSampleBatch sampleBatch;
+static bme68xSampleBatch logBatch;
+static spscRing<bme68xSampleRecord, SAMPLE_RING_SIZE> sampleRing;
+static spscRing<bsecDataLogger::SensorIoData, BSEC_RING_SIZE> bsecRing;
+static TaskHandle_t loggingTaskHandle = nullptr;
+/* status of each task, written by its own task only */
+static std::atomic<demoRetCode> acquisitionStatus(EDK_OK);
+static std::atomic<demoRetCode> loggingStatus(EDK_OK);
+static std::atomic<demoRetCode> bsecStatus(EDK_OK);
+static std::atomic<demoRetCode> bsecLoggingStatus(EDK_OK);
 
 void setup()
 {
@@ -130,15 +236,17 @@ void setup()
 	while (!Serial.available()){}
 	Serial.read();
 	SERIAL_PRINTLN("Check point 0");
+	#else
+	/* only used for the bus statistics dump, no need to wait for a terminal */
+	Serial.begin(115200);
 	#endif
 
 	/**********************************************   Disable brownout detectore   ********************************************/
   	WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
 	
 	/* Datalogger Mode is set by default */
-	appMode = DEMO_DATALOGGER_MODE;
+	appMode = DEMO_DEFAULT_MODE;
 	label = BSEC_NO_CLASS;
-	bsecSelectedSensor = 0;
 	/* Initializes the label provider module */
 	labelPvr.begin();
 	SERIAL_PRINTLN("Check point 10");
@@ -147,6 +255,10 @@ void setup()
 	SERIAL_PRINTLN("Check point 11");
 	/* Initializes the SD and RTC module */
 	retCode = utils::begin();
+	if (retCode >= EDK_OK)
+	{
+		utils::setBootPhase(BOOT_PHASE_STORAGE_READY);
+	}
 
 	SERIAL_PRINTLN("Check point 1");
 
@@ -159,7 +271,12 @@ void setup()
 		SERIAL_PRINTLN(bme68xConfigFile[0]);
 		if (bme68xConfigFile[0] != '/') bme68xConfigFile = String("/") + bme68xConfigFile;
 		
-		if (isBme68xConfAvailable)
+		if (appMode == DEMO_BLE_STREAMING_MODE)
+		{
+			if (bsecConfigFile.length() && (bsecConfigFile[0] != '/')) bsecConfigFile = String("/") + bsecConfigFile;
+			retCode = isBsecConfAvailable ? configureBsecLogging(bsecConfigFile, bsecConfig) : EDK_BSEC_CONFIG_STR_FILE_ERROR;
+		}
+		else if (isBme68xConfAvailable)
 		{
 			retCode = configureSensorLogging(bme68xConfigFile);
 		}
@@ -174,7 +291,7 @@ void setup()
 		if (retCode != EDK_SD_CARD_INIT_ERROR)
 		{
 			/* creates log file and updates the error codes */
-			if (bme68xDlog.begin(bme68xConfigFile) != EDK_SD_CARD_INIT_ERROR)
+			if (bme68xDlog.begin(bme68xConfigFile, BME68X_LOG_FORMAT) != EDK_SD_CARD_INIT_ERROR)
 			/* Writes the sensor data to the current log file */
 			(void) bme68xDlog.writeSensorData(nullptr, nullptr, nullptr, nullptr, label, retCode);
 			/* Flushes the buffered sensor data to the current log file */
@@ -183,14 +300,44 @@ void setup()
 		appMode = DEMO_IDLE_MODE;
 	}
 	SERIAL_PRINTLN("Check point 3");
-	bsec2.attachCallback(bsecCallBack);
+	
+	if (appMode == DEMO_DATALOGGER_MODE)
+	{
+		/* SD latency in the logging task must not delay the acquisition */
+		xTaskCreatePinnedToCore(loggingTask, "logging", LOGGING_TASK_STACK_SIZE, NULL, LOGGING_TASK_PRIORITY, &loggingTaskHandle, LOGGING_CORE);
+		xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQUISITION_TASK_STACK_SIZE, NULL, ACQUISITION_TASK_PRIORITY, NULL, ACQUISITION_CORE);
+	}
+	else if (appMode == DEMO_BLE_STREAMING_MODE)
+	{
+		/* runs in the place of the acquisition task, the BSEC logging task writes the outputs */
+		xTaskCreatePinnedToCore(bsecLoggingTask, "bsecLogging", LOGGING_TASK_STACK_SIZE, NULL, LOGGING_TASK_PRIORITY, &loggingTaskHandle, LOGGING_CORE);
+		xTaskCreatePinnedToCore(bsecTask, "bsec", BSEC_TASK_STACK_SIZE, NULL, ACQUISITION_TASK_PRIORITY, NULL, ACQUISITION_CORE);
+	}
 }
 
 void loop() 
 {
 	/* Updates the led controller status */
-	ledCtlr.update(retCode);
-	if (retCode >= EDK_OK)
+	ledCtlr.update(getAppStatus());
+	/* Dumps the bus transaction counters on request */
+	if (Serial.available() && (Serial.read() == CMD_BUS_STATS))
+	{
+		sensorMgr.printBusStats(Serial);
+		Serial.printf("sample ring: %lu/%lu used, high water %lu, overflows %lu\n", (unsigned long) sampleRing.size(),
+			(unsigned long) sampleRing.capacity(), (unsigned long) sampleRing.getHighWater(), (unsigned long) sampleRing.getOverflows());
+		Serial.printf("bsec ring: %lu/%lu used, high water %lu, overflows %lu\n", (unsigned long) bsecRing.size(),
+			(unsigned long) bsecRing.capacity(), (unsigned long) bsecRing.getHighWater(), (unsigned long) bsecRing.getOverflows());
+		bme68xDlog.printFlushStats(Serial);
+		bsecDlog.printFlushStats(Serial);
+		bsecState.printStats(Serial);
+		sdWriter::printStats(Serial);
+		Serial.printf("status: setup %d acquisition %d logging %d bsec %d bsec logging %d\n", (int) retCode,
+			(int) acquisitionStatus.load(), (int) loggingStatus.load(), (int) bsecStatus.load(), (int) bsecLoggingStatus.load());
+		/* a shrinking largest block at a steady free heap is fragmentation */
+		Serial.printf("heap: free %lu, largest block %lu, lowest free %lu\n", (unsigned long) ESP.getFreeHeap(),
+			(unsigned long) ESP.getMaxAllocHeap(), (unsigned long) ESP.getMinFreeHeap());
+	}
+	if (isAppRunning())
 	{
 		/* Retrieves the current label */
 		(void) labelPvr.getLabel(label);
@@ -198,45 +345,11 @@ void loop()
 		{
 			/*  Logs the bme688 sensors raw data from all 8 sensors */
 			case DEMO_DATALOGGER_MODE:
-			{
-				uint8_t i;
-				// SERIAL_PRINTLN("1");
-                /* Schedules the next readable sensor */
-				while (sensorMgr.scheduleSensor(i))
-				{
-					bme68x_data* sensorData[3];
-					/* Returns the selected sensor address */
-                    bme68xSensor* sensor = sensorMgr.getSensor(i);
-					/* Retrieves the selected sensor data */
-					retCode = sensorMgr.collectData(i, sensorData);
-					if (retCode < EDK_OK)
-					{
-						/* Writes the sensor data to the current log file */
-						retCode = bme68xDlog.writeSensorData(&i, &sensor->id, &sensor->mode, nullptr, label, retCode);
-					}
-					else
-					{
-						for (const auto data : sensorData)
-						{
-							if (data != nullptr)
-							{
-								retCode = bme68xDlog.writeSensorData(&i, &sensor->id, &sensor->mode, data, label, retCode);
-							}
-						}
-					}
-				}
-				
-				retCode = bme68xDlog.flush();
-			}
-			break;
-			/* Example of BSEC library integration: gets the data from one out of 8 sensors
-			   (this can be selected through application) and calls BSEC library,
-			   get the outputs in app and logs the data */
+			/* Runs BSEC on all 8 sensors, one instance each, and logs the outputs */
 			case DEMO_BLE_STREAMING_MODE:
 			{
-				/* Callback from the user to read data from the BME688 sensors using parallel mode/forced mode,
-				   process and store outputs */
-				(void) bsec2.run();
+				/* Data is collected and logged by the acquisition and logging tasks, or the BSEC task */
+				delay(MAX_IDLE_WAIT_MS);
 			}
 			break;
 			default:
@@ -245,44 +358,182 @@ void loop()
 	}
 	else
 	{
-		SERIAL_PRINTLN("Error code = " + String((int) retCode));
+		demoRetCode status = getAppStatus();
+		SERIAL_PRINTLN("Error code = " + String((int) status));
 		while(1)
 		{
 			/* Updates the led controller status */
-			ledCtlr.update(retCode);
+			ledCtlr.update(status);
 		}
 	}
 }
 
-void bsecCallBack(const bme68x_data input, const bsecOutputs outputs, Bsec2 bsec)
+void bsecCallBack(uint8_t num, uint32_t sensorId, uint8_t sensorMode, const bme68x_data& input, const bsecOutputs& outputs)
 { 
-	// bleNotifyBme68xData(input);	
-	// if (outputs.nOutputs)
-	// {
-	// 	bleNotifyBsecOutput(outputs);
-	// }
+	/* the callback runs in the BSEC task; only the tick, the logging task converts it to the time since
+	 * power on and the RTC time */
+	if (bsecRecord::push(bsecRing, num, sensorId, sensorMode, (uint8_t)label, (int8_t)bsecStatus.load(std::memory_order_relaxed),
+						 utils::getTickUs(), input, outputs))
+	{
+		utils::setBootPhase(BOOT_PHASE_FIRST_SAMPLE);
+	}
+}
+
+void writeBsecBuffer()
+{
+	setTaskStatus(bsecLoggingStatus, bsecDlog.writeBsecOutput(buff, buffCount));
+	buffCount = 0;
+}
+
+void setTaskStatus(std::atomic<demoRetCode>& status, demoRetCode code)
+{
+	if (status.load(std::memory_order_relaxed) >= EDK_OK)
+	{
+		status.store(code, std::memory_order_relaxed);
+	}
+}
+
+demoRetCode getAppStatus()
+{
+	const demoRetCode codes[] = {retCode, loggingStatus.load(), bsecLoggingStatus.load(), bsecStatus.load(), acquisitionStatus.load()};
+	
+	for (demoRetCode code : codes)
+	{
+		if (code < EDK_OK)
+		{
+			return code;
+		}
+	}
+	return retCode;
+}
+
+bool isAppRunning()
+{
+	return (retCode >= EDK_OK) && (loggingStatus.load() >= EDK_OK) && (bsecLoggingStatus.load() >= EDK_OK) &&
+		(bsecStatus.load() >= EDK_OK);
+}
+
+void bsecTask(void* arg)
+{
+	(void) arg;
+	TickType_t lastWake = xTaskGetTickCount();
+	
+	while (isAppRunning())
+	{
+		/* Each instance processes its sensor when BSEC requires, the outputs are queued by the callback */
+		setTaskStatus(bsecStatus, bsecMgr.run());
+		/* Captures the state of one instance once a snapshot is due, the logging task writes it */
+		if (bsecState.capture(bsecMgr) || bsecRing.size())
+		{
+			xTaskNotifyGive(loggingTaskHandle);
+		}
+		vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(BSEC_POLL_INTERVAL_MS));
+	}
+	vTaskDelete(NULL);
+}
+
+void bsecLoggingTask(void* arg)
+{
+	(void) arg;
+	
+	while (isAppRunning())
+	{
+		/* Reads the RTC once the wall clock is due for a correction, this task owns the clock */
+		utils::serviceClock();
+		/* the outputs are popped straight into the row buffer */
+		if (!bsecRing.pop(buff[buffCount]))
+		{
+			/* Writes the BSEC state snapshot, a failed one is retried at the next interval */
+			(void) bsecState.save();
+			/* Commits the buffered outputs once they are old enough, also without new outputs */
+			if (buffCount && bsecDlog.isFlushDue(label))
+			{
+				writeBsecBuffer();
+			}
+			/* Sleeps until the BSEC task queues outputs */
+			(void) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MAX_IDLE_WAIT_MS));
+			continue;
+		}
+		
+		/* Commits the outputs of the previous label first */
+		gasLabel rowLabel = (gasLabel)buff[buffCount].label;
+		if (buffCount && bsecDlog.isFlushDue(rowLabel))
+		{
+			bsecDataLogger::SensorIoData data = buff[buffCount];
+			writeBsecBuffer();
+			buff[0] = data;
+		}
+		buffCount ++;
+		bsecDlog.addPending(rowLabel);
+		
+		if ((buffCount == BUFF_SIZE) || bsecDlog.isFlushDue(rowLabel))
+		{
+			writeBsecBuffer();
+		}
+	}
+	vTaskDelete(NULL);
+}
+
+void acquisitionTask(void* arg)
+{
+	(void) arg;
+	bme68xSampleRecord record;
+	
+	while (isAppRunning())
+	{
+		/* Retrieves the data of all sensors due now, with one shared time stamp */
+		setTaskStatus(acquisitionStatus, sensorMgr.collectBatch(sampleBatch));
+		if (sampleBatch.count)
+		{
+			record.tickUs = sampleBatch.tickUs;
+			for (uint8_t i = 0; i < sampleBatch.count; i++)
+			{
+				record.sample = sampleBatch.samples[i];
+				/* a full ring drops the sample, counted as overflow */
+				(void) sampleRing.push(record);
+			}
+			xTaskNotifyGive(loggingTaskHandle);
+		}
+		/* Sleeps until the next sensor is due */
+		(void) sensorMgr.waitForSensor(MAX_IDLE_WAIT_MS);
+	}
+	vTaskDelete(NULL);
+}
 
-	bme68xSensor *sensor = sensorMgr.getSensor(bsecSelectedSensor); /* returns the selected sensor address */
+void loggingTask(void* arg)
+{
+	(void) arg;
+	bme68xSampleRecord record;
 	
-	if (sensor != nullptr)
+	while (isAppRunning())
 	{
-		buff[buffCount].sensorNum = bsecSelectedSensor;
-		buff[buffCount].sensorId = sensor->id;
-		buff[buffCount].sensorMode = sensor->mode;
-		buff[buffCount].inputData = input;
-		buff[buffCount].outputs = outputs;
-		buff[buffCount].label = label;
-		buff[buffCount].code = retCode;
-		buff[buffCount].timeSincePowerOn = millis();
-		buff[buffCount].rtcTsp = utils::getRtc().now().unixtime();
-		buffCount ++;  
+		/* Reads the RTC once the wall clock is due for a correction, this task owns the clock */
+		utils::serviceClock();
+		if (!sampleRing.peek(record))
+		{
+			/* Commits the buffered rows once they are old enough, also without new samples */
+			setTaskStatus(loggingStatus, bme68xDlog.flushIfDue(label));
+			/* Sleeps until the acquisition task pushes samples */
+			(void) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MAX_IDLE_WAIT_MS));
+			continue;
+		}
 		
-		if (buffCount == BUFF_SIZE)
+		/* Regroups the samples sharing a time stamp */
+		logBatch.tickUs = record.tickUs;
+		logBatch.count = 0;
+		while ((logBatch.count < SAMPLE_BATCH_SIZE) && sampleRing.peek(record) && (record.tickUs == logBatch.tickUs))
 		{
-			retCode = bsecDlog.writeBsecOutput(buff, BUFF_SIZE);
-			buffCount = 0;
+			(void) sampleRing.pop(record);
+			logBatch.samples[logBatch.count++] = record.sample;
 		}
+		
+		/* Writes the sensor data to the current log file */
+		setTaskStatus(loggingStatus, bme68xDlog.writeBatch(logBatch, label));
+		/* Flushes the buffered sensor data once the flush policy requires it */
+		setTaskStatus(loggingStatus, bme68xDlog.flushIfDue(label));
+		utils::setBootPhase(BOOT_PHASE_FIRST_SAMPLE);
 	}
+	vTaskDelete(NULL);
 }
 
 demoRetCode configureSensorLogging(const String& bmeConfigFile)
@@ -290,7 +541,9 @@ demoRetCode configureSensorLogging(const String& bmeConfigFile)
 	demoRetCode ret = sensorMgr.begin(bmeConfigFile);
 	if (ret >= EDK_OK)
 	{
-		ret = bme68xDlog.begin(bmeConfigFile);
+		ret = bme68xDlog.begin(bmeConfigFile, BME68X_LOG_FORMAT);
+		/* commits along the policy of the configuration file */
+		bme68xDlog.setFlushPolicy(sensorMgr.getFlushPolicy());
 	}
 	return ret;
 }
@@ -303,5 +556,23 @@ demoRetCode configureBsecLogging(const String& bsecConfigFile, uint8_t bsecConfi
 	{
 		ret = utils::getBsecConfig(bsecConfigFile, bsecConfigStr);
 	}
+	/* commits along the policy of the .bmeconfig file when present, the defaults otherwise */
+	logFlushPolicy flushPolicy;
+	if ((ret >= EDK_OK) && isBme68xConfAvailable &&
+		(profileTable::loadFlushPolicy(bme68xConfigFile, flushPolicy) == EDK_OK))
+	{
+		bsecDlog.setFlushPolicy(flushPolicy);
+	}
+	/* each sensor is brought up by its own BSEC instance */
+	if (ret >= EDK_OK)
+	{
+		ret = bsecMgr.begin(sensorMgr, bsecConfigStr, bsecCallBack);
+	}
+	/* resumes from the states saved before the power cycle, instead of building up the accuracy again */
+	if (ret >= EDK_OK)
+	{
+		ret = bsecState.restore(bsecMgr, bsecConfigStr) ? EDK_OK : EDK_BSEC_STATE_RESTORE_WARNING;
+		bsecState.printRestore(Serial);
+	}
 	return ret;
 }
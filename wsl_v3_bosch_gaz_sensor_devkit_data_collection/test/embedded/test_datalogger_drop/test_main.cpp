@@ -0,0 +1,164 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	On target test of the raw data log when rows are dropped, needs the SD card of the devkit
+ * 
+ * 
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <bme68x_datalogger.h>
+#include <sd_writer.h>
+#include <utils.h>
+
+/* Rows written before and after the drop */
+#define DROPPED_ROWS 3
+#define KEPT_ROWS 2
+
+static bme68xDataLogger dataLogger;
+
+/**
+ * @brief This function writes rows of sensor 0
+ */
+static void writeRows(uint8_t count)
+{
+	uint8_t num = 0, mode = BME68X_PARALLEL_MODE;
+	uint32_t sensorId = 0x5A0000C0;
+	bme68x_data data;
+
+	memset(&data, 0, sizeof(data));
+	data.temperature = 24.5f;
+	data.pressure = 101325.0f;
+	data.humidity = 40.0f;
+	data.gas_resistance = 50000.0f;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		data.gas_index = i;
+		(void) dataLogger.writeSensorData(&num, &sensorId, &mode, &data, BSEC_NO_CLASS, EDK_OK);
+	}
+}
+
+/**
+ * @brief This function reads the name of the open log file from the marker
+ */
+static String getOpenLogName(void)
+{
+	commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+	File marker = SD.open(BME68X_OPEN_LOG_MARKER, FILE_READ);
+	String name;
+
+	if (marker)
+	{
+		name = marker.readStringUntil('\n');
+		name.trim();
+		marker.close();
+	}
+	return name;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief The first flush of a file finds no free buffer: its rows are dropped, the file stays valid Json
+ *		  and holds the rows written after the drop
+ */
+void test_drop_first_rows(void)
+{
+	uint8_t* held[SD_WRITER_BUFFER_COUNT];
+	uint8_t nbHeld = 0;
+
+	TEST_ASSERT_EQUAL(EDK_OK, dataLogger.begin("", BME68X_LOG_FORMAT_JSON));
+	String fileName = getOpenLogName();
+	TEST_ASSERT_TRUE(fileName.length() > 0);
+
+	/* the first rows after "dataBlock": [ */
+	writeRows(DROPPED_ROWS);
+	/* all free buffers are taken, the flush of the logger times out */
+	while ((nbHeld < SD_WRITER_BUFFER_COUNT) && ((held[nbHeld] = sdWriter::acquire(0)) != nullptr))
+	{
+		nbHeld++;
+	}
+	TEST_ASSERT_EQUAL(EDK_DATALOGGER_DATA_DROP_WARNING, dataLogger.flush());
+	for (uint8_t i = 0; i < nbHeld; i++)
+	{
+		sdWriter::release(held[i]);
+	}
+
+	writeRows(KEPT_ROWS);
+	TEST_ASSERT_EQUAL(EDK_OK, dataLogger.flush());
+	sdWriter::sync();
+
+	/* the next begin closes the file with its footer */
+	TEST_ASSERT_EQUAL(EDK_OK, dataLogger.begin("", BME68X_LOG_FORMAT_JSON));
+
+	DynamicJsonDocument doc(16384);
+	{
+		commMuxBusGuard busGuard(COMM_MUX_OWNER_STORAGE);
+		File file = SD.open(fileName, FILE_READ);
+		TEST_ASSERT_TRUE((bool) file);
+		DeserializationError error = deserializeJson(doc, file);
+		file.close();
+		TEST_ASSERT_EQUAL_STRING("Ok", error.c_str());
+	}
+	JsonArray dataBlock = doc["rawDataBody"]["dataBlock"].as<JsonArray>();
+	TEST_ASSERT_EQUAL(KEPT_ROWS, dataBlock.size());
+	for (uint8_t i = 0; i < KEPT_ROWS; i++)
+	{
+		/* column 8 is the gas index, the kept rows count from 0 again */
+		TEST_ASSERT_EQUAL(i, dataBlock[i][8].as<int>());
+	}
+}
+
+void setup()
+{
+	/* leaves time for the serial monitor of the test runner to attach */
+	delay(2000);
+	UNITY_BEGIN();
+	RUN_TEST(test_drop_first_rows);
+	UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,256 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host test of the BSEC callback path: records built in place in the output ring, copies and time per callback
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "spsc_ring.h"
+#include "bsec_record.h"
+
+/* Ring size, as BSEC_RING_SIZE in src/main.cpp */
+#define TEST_RING_SIZE 			32
+/* Callbacks of the timing test */
+#define TEST_CALLBACKS 			(TEST_RING_SIZE * 20000)
+/* Bound of the time per callback on the host (ns), far above the expected one */
+#define TEST_CALLBACK_MAX_NS 	2000
+
+/* Copies of a record, by construction or assignment */
+static uint32_t recordCopies = 0;
+
+/*!
+ * @brief : Record counting its copies
+ */
+struct countedRecord : bsecOutputRecord
+{
+	countedRecord()
+	{
+	}
+	
+	countedRecord(const countedRecord& other) : bsecOutputRecord(other)
+	{
+		recordCopies++;
+	}
+	
+	countedRecord& operator=(const countedRecord& other)
+	{
+		bsecOutputRecord::operator=(other);
+		recordCopies++;
+		return *this;
+	}
+};
+
+static spscRing<countedRecord, TEST_RING_SIZE> ring;
+
+/*!
+ * @brief : Tick stand-in of utils::getTickUs()
+ */
+static uint64_t getTickUs(void)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * @brief : Builds the outputs of a sample: iaq and gas estimates 1 and 3
+ */
+static void makeOutputs(bme68x_data& input, bsecOutputs& outputs)
+{
+	input = bme68x_data();
+	input.temperature = 25.5f;
+	input.pressure = 101325.0f;
+	input.humidity = 40.25f;
+	input.gas_resistance = 123456.0f;
+	input.gas_index = 7;
+	
+	outputs = bsecOutputs();
+	outputs.output[0].sensor_id = BSEC_OUTPUT_IAQ;
+	outputs.output[0].signal = 42.0f;
+	outputs.output[0].accuracy = 2;
+	outputs.output[1].sensor_id = BSEC_OUTPUT_GAS_ESTIMATE_1;
+	outputs.output[1].signal = 0.75f;
+	outputs.output[1].accuracy = 3;
+	outputs.output[2].sensor_id = BSEC_OUTPUT_GAS_ESTIMATE_3;
+	outputs.output[2].signal = 0.25f;
+	outputs.output[2].accuracy = 1;
+	outputs.nOutputs = 3;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/** @brief The record holds the inputs, the subscribed outputs and the lowest gas estimate accuracy */
+void test_set_outputs(void)
+{
+	bme68x_data input;
+	bsecOutputs outputs;
+	bsecOutputRecord record;
+	
+	makeOutputs(input, outputs);
+	bsecRecord::setOutputs(record, input, outputs);
+	
+	TEST_ASSERT_EQUAL_FLOAT(25.5f, record.temperature);
+	TEST_ASSERT_EQUAL_FLOAT(101325.0f, record.pressure);
+	TEST_ASSERT_EQUAL_FLOAT(40.25f, record.humidity);
+	TEST_ASSERT_EQUAL_FLOAT(123456.0f, record.gasResistance);
+	TEST_ASSERT_EQUAL_UINT8(7, record.gasIndex);
+	TEST_ASSERT_EQUAL_FLOAT(42.0f, record.iaq);
+	TEST_ASSERT_EQUAL_UINT8(2, record.iaqAccuracy);
+	TEST_ASSERT_EQUAL_FLOAT(0.75f, record.gasEstimate[0]);
+	TEST_ASSERT_TRUE(isnan(record.gasEstimate[1]));
+	TEST_ASSERT_EQUAL_FLOAT(0.25f, record.gasEstimate[2]);
+	TEST_ASSERT_TRUE(isnan(record.gasEstimate[3]));
+	TEST_ASSERT_EQUAL_UINT8(1, record.gasAccuracy);
+}
+
+/** @brief Outputs absent or beyond nOutputs leave NaN and 0xFF, whatever the record held before */
+void test_set_outputs_absent(void)
+{
+	bme68x_data input;
+	bsecOutputs outputs;
+	bsecOutputRecord record;
+	
+	makeOutputs(input, outputs);
+	bsecRecord::setOutputs(record, input, outputs);
+	outputs.nOutputs = 0;
+	bsecRecord::setOutputs(record, input, outputs);
+	
+	TEST_ASSERT_TRUE(isnan(record.iaq));
+	TEST_ASSERT_EQUAL_UINT8(0xFF, record.iaqAccuracy);
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		TEST_ASSERT_TRUE(isnan(record.gasEstimate[i]));
+	}
+	TEST_ASSERT_EQUAL_UINT8(0xFF, record.gasAccuracy);
+}
+
+/** @brief The callback copies no record, the logging task one per record; the time per callback is reported */
+void test_callback_copies_and_time(void)
+{
+	bme68x_data input;
+	bsecOutputs outputs;
+	countedRecord record;
+	uint64_t callbackNs = 0;
+	uint32_t callbackCopies = 0;
+	uint32_t popCopies = 0;
+	uint32_t popped = 0;
+	
+	makeOutputs(input, outputs);
+	recordCopies = 0;
+	for (uint32_t i = 0; i < TEST_CALLBACKS; i += TEST_RING_SIZE)
+	{
+		/* a full ring of callbacks is timed, then drained as the logging task does */
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t j = 0; j < TEST_RING_SIZE; j++)
+		{
+			/* as bsecCallBack() in src/main.cpp */
+			TEST_ASSERT_TRUE(bsecRecord::push(ring, (uint8_t)(j & 7), 0x1000 + j, 1, 3, 0, getTickUs(), input, outputs));
+		}
+		auto stop = std::chrono::steady_clock::now();
+		callbackNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+		callbackCopies += recordCopies;
+		recordCopies = 0;
+		
+		while (ring.pop(record))
+		{
+			TEST_ASSERT_EQUAL_UINT32(0x1000 + (popped % TEST_RING_SIZE), record.sensorId);
+			TEST_ASSERT_EQUAL_UINT8(popped % 8, record.sensorNum);
+			TEST_ASSERT_EQUAL_UINT8(3, record.label);
+			TEST_ASSERT_EQUAL_FLOAT(42.0f, record.iaq);
+			popped++;
+		}
+		popCopies += recordCopies;
+		recordCopies = 0;
+	}
+	
+	printf("record %u bytes, bsec outputs %u bytes, %.1f ns per callback, %lu copies in callbacks, "
+		"%lu copies in %lu pops\n", (unsigned) sizeof(bsecOutputRecord), (unsigned) sizeof(bsecOutputs),
+		(double) callbackNs / TEST_CALLBACKS, (unsigned long) callbackCopies, (unsigned long) popCopies,
+		(unsigned long) popped);
+	
+	TEST_ASSERT_EQUAL_UINT32(TEST_CALLBACKS, popped);
+	TEST_ASSERT_EQUAL_UINT32(0, ring.getOverflows());
+	TEST_ASSERT_EQUAL_UINT32(0, callbackCopies);
+	TEST_ASSERT_EQUAL_UINT32(popped, popCopies);
+	TEST_ASSERT_TRUE((callbackNs / TEST_CALLBACKS) < TEST_CALLBACK_MAX_NS);
+}
+
+/** @brief A full ring drops the outputs and counts them, the records already pushed are kept */
+void test_push_full_ring(void)
+{
+	bme68x_data input;
+	bsecOutputs outputs;
+	countedRecord record;
+	
+	makeOutputs(input, outputs);
+	for (uint32_t i = 0; i < ring.capacity(); i++)
+	{
+		TEST_ASSERT_TRUE(bsecRecord::push(ring, 0, i, 1, 2, -1, 1000 + i, input, outputs));
+	}
+	TEST_ASSERT_FALSE(bsecRecord::push(ring, 0, 0xFFFF, 1, 2, -1, 0, input, outputs));
+	TEST_ASSERT_EQUAL_UINT32(1, ring.getOverflows());
+	
+	TEST_ASSERT_TRUE(ring.pop(record));
+	TEST_ASSERT_EQUAL_UINT32(0, record.sensorId);
+	TEST_ASSERT_EQUAL_UINT8(2, record.label);
+	TEST_ASSERT_EQUAL_INT8(-1, record.code);
+	TEST_ASSERT_EQUAL_UINT64(1000, record.tickUs);
+	while (ring.pop(record))
+	{
+	}
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_set_outputs);
+	RUN_TEST(test_set_outputs_absent);
+	RUN_TEST(test_callback_copies_and_time);
+	RUN_TEST(test_push_full_ring);
+	return UNITY_END();
+}
@@ -0,0 +1,391 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host test of the BSEC state snapshots: slot alternation, torn and corrupted slots, sensor and configuration checks
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "bsec_state_store.h"
+
+/* Sensors of the tests */
+#define TEST_INSTANCES 		3
+
+/* Slot files in memory */
+static std::vector<uint8_t> slots[BSEC_STATE_SLOT_COUNT];
+/* Slot of the last write and bytes kept of the next one, as cut short by a power loss, 0 for all */
+static int lastWrittenSlot = -1;
+static size_t writeLimit = 0;
+/* Time of the fake clock (us) */
+static uint64_t nowUs = 0;
+/* BSEC configuration strings */
+static uint8_t config[BSEC_MAX_PROPERTY_BLOB_SIZE];
+static uint8_t otherConfig[BSEC_MAX_PROPERTY_BLOB_SIZE];
+
+/*!
+ * @brief : Reads a slot in memory
+ */
+static size_t readSlot(void* context, uint8_t slot, uint8_t* data, size_t len)
+{
+	(void) context;
+	len = (len < slots[slot].size()) ? len : slots[slot].size();
+	memcpy(data, slots[slot].data(), len);
+	return len;
+}
+
+/*!
+ * @brief : Writes a slot in memory, cut short once if a limit is set
+ */
+static size_t writeSlot(void* context, uint8_t slot, const uint8_t* data, size_t len)
+{
+	(void) context;
+	if (writeLimit && (len > writeLimit))
+	{
+		len = writeLimit;
+		writeLimit = 0;
+	}
+	slots[slot].assign(data, data + len);
+	lastWrittenSlot = slot;
+	return len;
+}
+
+/*!
+ * @brief : Fake clock of the tests, advanced by hand
+ */
+static uint64_t fakeClockUs(void)
+{
+	return nowUs;
+}
+
+/*!
+ * @brief : Stand-in of the bsecManager: the state of an instance is its sensor id and a generation
+ */
+struct fakeBsecManager
+{
+	uint8_t nbInstances = TEST_INSTANCES;
+	uint32_t sensorIds[NUM_BME68X_UNITS];
+	uint8_t generation = 1;
+	uint8_t restored[NUM_BME68X_UNITS];
+	/* instance whose getState fails, -1 for none */
+	int failGetState = -1;
+	
+	fakeBsecManager()
+	{
+		for (uint8_t i = 0; i < NUM_BME68X_UNITS; i++)
+		{
+			sensorIds[i] = 0x1000 + i;
+		}
+		memset(restored, 0, sizeof(restored));
+	}
+	
+	uint8_t getInstanceCount() const
+	{
+		return nbInstances;
+	}
+	
+	uint32_t getSensorId(uint8_t num) const
+	{
+		return sensorIds[num];
+	}
+	
+	int32_t getStatus(uint8_t num) const
+	{
+		return (num == failGetState) ? -1 : 0;
+	}
+	
+	bool getState(uint8_t num, uint8_t state[BSEC_MAX_STATE_BLOB_SIZE])
+	{
+		memset(state, generation, BSEC_MAX_STATE_BLOB_SIZE);
+		state[0] = num;
+		return (num != failGetState);
+	}
+	
+	bool setState(uint8_t num, uint8_t state[BSEC_MAX_STATE_BLOB_SIZE])
+	{
+		restored[num] = state[1];
+		return (state[0] == num);
+	}
+};
+
+/*!
+ * @brief : Captures and saves a snapshot of all instances, once the interval elapsed
+ */
+static void takeSnapshot(bsecStateStore& store, fakeBsecManager& bsecMgr)
+{
+	nowUs += BSEC_STATE_SAVE_INTERVAL_US;
+	for (uint8_t i = 0; i < bsecMgr.nbInstances; i++)
+	{
+		TEST_ASSERT_EQUAL((i + 1) == bsecMgr.nbInstances, store.capture(bsecMgr));
+	}
+	TEST_ASSERT_TRUE(store.isPending());
+	TEST_ASSERT_TRUE(store.save());
+	TEST_ASSERT_FALSE(store.isPending());
+}
+
+/*!
+ * @brief : Retrieves the sequence number of a slot
+ */
+static uint32_t getSeq(uint8_t slot)
+{
+	bsecStateSnapshot snapshot;
+	
+	memcpy(&snapshot, slots[slot].data(), sizeof(snapshot));
+	return snapshot.seq;
+}
+
+void setUp(void)
+{
+	for (uint8_t slot = 0; slot < BSEC_STATE_SLOT_COUNT; slot++)
+	{
+		slots[slot].clear();
+	}
+	lastWrittenSlot = -1;
+	writeLimit = 0;
+	nowUs = 1000;
+	memset(config, 0x5A, sizeof(config));
+	memset(otherConfig, 0x5A, sizeof(otherConfig));
+	otherConfig[100] = 0x5B;
+}
+
+void tearDown(void)
+{
+}
+
+/** @brief Without snapshot the instances start from scratch, the snapshots alternate between the slots */
+void test_slot_alternation(void)
+{
+	bsecStateStore store(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager bsecMgr;
+	
+	TEST_ASSERT_TRUE(store.restore(bsecMgr, config));
+	TEST_ASSERT_EQUAL_UINT8(0, store.getRestoredCount());
+	
+	/* not due before the interval */
+	TEST_ASSERT_FALSE(store.capture(bsecMgr));
+	TEST_ASSERT_EQUAL(-1, lastWrittenSlot);
+	
+	takeSnapshot(store, bsecMgr);
+	TEST_ASSERT_EQUAL(0, lastWrittenSlot);
+	TEST_ASSERT_EQUAL_UINT32(1, getSeq(0));
+	takeSnapshot(store, bsecMgr);
+	TEST_ASSERT_EQUAL(1, lastWrittenSlot);
+	TEST_ASSERT_EQUAL_UINT32(2, getSeq(1));
+	bsecMgr.generation = 3;
+	takeSnapshot(store, bsecMgr);
+	TEST_ASSERT_EQUAL(0, lastWrittenSlot);
+	TEST_ASSERT_EQUAL_UINT32(3, getSeq(0));
+	
+	/* after a power cycle, the latest snapshot is restored and the next one overwrites the other slot */
+	bsecStateStore restarted(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager newMgr;
+	TEST_ASSERT_TRUE(restarted.restore(newMgr, config));
+	TEST_ASSERT_EQUAL_UINT8(TEST_INSTANCES, restarted.getRestoredCount());
+	TEST_ASSERT_EQUAL_UINT8(3, newMgr.restored[0]);
+	TEST_ASSERT_EQUAL_UINT8(3, newMgr.restored[TEST_INSTANCES - 1]);
+	takeSnapshot(restarted, newMgr);
+	TEST_ASSERT_EQUAL(1, lastWrittenSlot);
+	TEST_ASSERT_EQUAL_UINT32(4, getSeq(1));
+}
+
+/** @brief A write cut short by a power loss leaves the other slot, which is restored */
+void test_torn_write(void)
+{
+	bsecStateStore store(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager bsecMgr;
+	
+	(void) store.restore(bsecMgr, config);
+	takeSnapshot(store, bsecMgr);
+	bsecMgr.generation = 2;
+	takeSnapshot(store, bsecMgr);
+	
+	/* the third snapshot overwrites slot 0 and is cut at 1000 bytes */
+	bsecMgr.generation = 3;
+	writeLimit = 1000;
+	nowUs += BSEC_STATE_SAVE_INTERVAL_US;
+	for (uint8_t i = 0; i < TEST_INSTANCES; i++)
+	{
+		(void) store.capture(bsecMgr);
+	}
+	TEST_ASSERT_FALSE(store.save());
+	TEST_ASSERT_EQUAL_UINT32(1, store.getSaveErrors());
+	TEST_ASSERT_EQUAL_UINT32(1000, slots[0].size());
+	
+	bsecStateStore restarted(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager newMgr;
+	TEST_ASSERT_TRUE(restarted.restore(newMgr, config));
+	TEST_ASSERT_EQUAL_UINT8(TEST_INSTANCES, restarted.getRestoredCount());
+	TEST_ASSERT_EQUAL_UINT8(2, newMgr.restored[0]);
+	/* the torn slot is the next one written */
+	takeSnapshot(restarted, newMgr);
+	TEST_ASSERT_EQUAL(0, lastWrittenSlot);
+	TEST_ASSERT_EQUAL_UINT32(3, getSeq(0));
+}
+
+/** @brief A flipped byte fails the CRC, the other slot is restored */
+void test_flipped_byte(void)
+{
+	bsecStateStore store(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager bsecMgr;
+	
+	(void) store.restore(bsecMgr, config);
+	takeSnapshot(store, bsecMgr);
+	bsecMgr.generation = 2;
+	takeSnapshot(store, bsecMgr);
+	slots[1][offsetof(bsecStateSnapshot, states) + 500] ^= 0x01;
+	
+	bsecStateStore restarted(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager newMgr;
+	TEST_ASSERT_TRUE(restarted.restore(newMgr, config));
+	TEST_ASSERT_EQUAL_UINT8(TEST_INSTANCES, restarted.getRestoredCount());
+	TEST_ASSERT_EQUAL_UINT8(1, newMgr.restored[0]);
+	
+	/* both slots damaged: the instances start from scratch */
+	slots[0][0] ^= 0x80;
+	bsecStateStore damaged(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager scratchMgr;
+	TEST_ASSERT_TRUE(damaged.restore(scratchMgr, config));
+	TEST_ASSERT_EQUAL_UINT8(0, damaged.getRestoredCount());
+}
+
+/** @brief States built with another BSEC configuration are not restored */
+void test_config_mismatch(void)
+{
+	bsecStateStore store(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager bsecMgr;
+	
+	(void) store.restore(bsecMgr, config);
+	takeSnapshot(store, bsecMgr);
+	
+	bsecStateStore restarted(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager newMgr;
+	TEST_ASSERT_TRUE(restarted.restore(newMgr, otherConfig));
+	TEST_ASSERT_EQUAL_UINT8(0, restarted.getRestoredCount());
+	TEST_ASSERT_EQUAL_UINT8(0, newMgr.restored[0]);
+	
+	/* nor with the library default */
+	bsecStateStore library(readSlot, writeSlot, fakeClockUs);
+	TEST_ASSERT_TRUE(library.restore(newMgr, nullptr));
+	TEST_ASSERT_EQUAL_UINT8(0, library.getRestoredCount());
+}
+
+/** @brief The state of a replaced sensor is not restored and is counted, the others are */
+void test_sensor_mismatch(void)
+{
+	bsecStateStore store(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager bsecMgr;
+	
+	(void) store.restore(bsecMgr, config);
+	takeSnapshot(store, bsecMgr);
+	
+	bsecStateStore restarted(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager newMgr;
+	newMgr.sensorIds[1] = 0x2001;
+	TEST_ASSERT_TRUE(restarted.restore(newMgr, config));
+	TEST_ASSERT_EQUAL_UINT8(TEST_INSTANCES - 1, restarted.getRestoredCount());
+	TEST_ASSERT_EQUAL_UINT8(1, restarted.getMismatchedCount());
+	TEST_ASSERT_EQUAL_UINT8(1, newMgr.restored[0]);
+	TEST_ASSERT_EQUAL_UINT8(0, newMgr.restored[1]);
+	TEST_ASSERT_EQUAL_UINT8(1, newMgr.restored[2]);
+}
+
+/** @brief A getState failure drops the snapshot, the next one goes to the same slot with the next seq */
+void test_get_state_failure(void)
+{
+	bsecStateStore store(readSlot, writeSlot, fakeClockUs);
+	fakeBsecManager bsecMgr;
+	
+	(void) store.restore(bsecMgr, config);
+	takeSnapshot(store, bsecMgr);
+	TEST_ASSERT_EQUAL(0, lastWrittenSlot);
+	
+	bsecMgr.failGetState = 1;
+	nowUs += BSEC_STATE_SAVE_INTERVAL_US;
+	TEST_ASSERT_FALSE(store.capture(bsecMgr));
+	TEST_ASSERT_FALSE(store.capture(bsecMgr));
+	TEST_ASSERT_FALSE(store.isPending());
+	TEST_ASSERT_EQUAL_UINT32(1, store.getGetStateErrors());
+	/* nothing to write, the slots keep the previous snapshot */
+	TEST_ASSERT_TRUE(store.save());
+	TEST_ASSERT_EQUAL(0, lastWrittenSlot);
+	/* the next capture waits for the interval */
+	TEST_ASSERT_FALSE(store.capture(bsecMgr));
+	TEST_ASSERT_EQUAL_UINT32(1, store.getGetStateErrors());
+	
+	bsecMgr.failGetState = -1;
+	takeSnapshot(store, bsecMgr);
+	TEST_ASSERT_EQUAL(1, lastWrittenSlot);
+	TEST_ASSERT_EQUAL_UINT32(2, getSeq(1));
+}
+
+/** @brief The slot checks: complete, magic, version, configuration and CRC */
+void test_is_valid(void)
+{
+	static bsecStateSnapshot snapshot;
+	
+	memset(&snapshot, 0, sizeof(snapshot));
+	snapshot.nbInstances = TEST_INSTANCES;
+	bsecStateStore::seal(snapshot, 7, 0x1234);
+	TEST_ASSERT_TRUE(bsecStateStore::isValid(snapshot, sizeof(snapshot), 0x1234));
+	TEST_ASSERT_FALSE(bsecStateStore::isValid(snapshot, sizeof(snapshot) - 1, 0x1234));
+	TEST_ASSERT_FALSE(bsecStateStore::isValid(snapshot, sizeof(snapshot), 0x1235));
+	
+	snapshot.version = BSEC_STATE_VERSION - 1;
+	TEST_ASSERT_FALSE(bsecStateStore::isValid(snapshot, sizeof(snapshot), 0x1234));
+	bsecStateStore::seal(snapshot, 7, 0x1234);
+	snapshot.magic ^= 1;
+	TEST_ASSERT_FALSE(bsecStateStore::isValid(snapshot, sizeof(snapshot), 0x1234));
+	bsecStateStore::seal(snapshot, 7, 0x1234);
+	snapshot.sensorIds[0] ^= 1;
+	TEST_ASSERT_FALSE(bsecStateStore::isValid(snapshot, sizeof(snapshot), 0x1234));
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_slot_alternation);
+	RUN_TEST(test_torn_write);
+	RUN_TEST(test_flipped_byte);
+	RUN_TEST(test_config_mismatch);
+	RUN_TEST(test_sensor_mismatch);
+	RUN_TEST(test_get_state_failure);
+	RUN_TEST(test_is_valid);
+	return UNITY_END();
+}
@@ -0,0 +1,213 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host tests of the commMux chip select handling against a mocked I2C-Expander
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <vector>
+#include "commMux.h"
+
+#define I2C_EXPANDER_ADDR 0x20
+#define I2C_EXPANDER_OUTPUT_REG_ADDR 0x01
+#define I2C_EXPANDER_OUTPUT_DESELECT 0xFF
+/* Register accesses of bme68x_get_data in parallel mode: status, field data, status, heater current */
+#define SAMPLE_ACCESSES 4
+static const uint8_t sampleRegs[SAMPLE_ACCESSES] = {0xF3, 0x9D, 0xF3, 0xD0};
+static const uint8_t sampleLens[SAMPLE_ACCESSES] = {1, 51, 1, 30};
+
+/**
+ * I2C master recording the transactions sent to the I2C-Expander
+ */
+class mockWire : public TwoWire
+{
+public:
+	std::vector<std::vector<uint8_t>> transactions;
+
+	void beginTransmission(uint8_t address) override
+	{
+		TEST_ASSERT_EQUAL_UINT8(I2C_EXPANDER_ADDR, address);
+		_current.clear();
+	}
+	size_t write(uint8_t data) override
+	{
+		_current.push_back(data);
+		return 1;
+	}
+	uint8_t endTransmission(void) override
+	{
+		transactions.push_back(_current);
+		return 0;
+	}
+	/* output level written last, the chip select mask the expander drives */
+	uint8_t outputs(void) const
+	{
+		return transactions.empty() ? I2C_EXPANDER_OUTPUT_DESELECT : transactions.back().back();
+	}
+
+private:
+	std::vector<uint8_t> _current;
+};
+
+static mockWire wire;
+static SPIClass spi;
+static commMux comm[2];
+
+/**
+ * @brief This function reads a sample the way the bme68x driver does
+ */
+static void readSample(commMux &sensor)
+{
+	uint8_t data[64];
+
+	for (uint8_t i = 0; i < SAMPLE_ACCESSES; i++)
+	{
+		TEST_ASSERT_EQUAL_INT8(0, commMuxRead(sampleRegs[i], data, sampleLens[i], &sensor));
+	}
+}
+
+void setUp(void)
+{
+	commMuxBegin(wire, spi);
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		(void) commMuxSetConfig(wire, spi, i, comm[i]);
+		commMuxResetStats(comm[i]);
+	}
+	wire.transactions.clear();
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Without a session every access selects and deselects its sensor
+ */
+void test_access_without_session(void)
+{
+	uint32_t start = commMuxGetExpanderWrites();
+
+	readSample(comm[0]);
+
+	TEST_ASSERT_EQUAL_UINT32(2 * SAMPLE_ACCESSES, wire.transactions.size());
+	TEST_ASSERT_EQUAL_UINT32(wire.transactions.size(), commMuxGetExpanderWrites() - start);
+	TEST_ASSERT_EQUAL_UINT32(wire.transactions.size(), commMuxGetStats(comm[0]).expanderWrites);
+	TEST_ASSERT_EQUAL_UINT8(I2C_EXPANDER_OUTPUT_DESELECT, wire.outputs());
+}
+
+/**
+ * @brief Within a session each further access costs a single pulse, the sample takes 5 writes instead of 8
+ */
+void test_access_in_session(void)
+{
+	commMuxBeginSession(comm[0]);
+	readSample(comm[0]);
+	TEST_ASSERT_EQUAL_UINT8(comm[0].select, wire.outputs());
+	commMuxEndSession();
+
+	TEST_ASSERT_EQUAL_UINT32(SAMPLE_ACCESSES + 1, wire.transactions.size());
+	TEST_ASSERT_EQUAL_UINT32(wire.transactions.size(), commMuxGetStats(comm[0]).expanderWrites);
+	TEST_ASSERT_EQUAL_UINT8(I2C_EXPANDER_OUTPUT_DESELECT, wire.outputs());
+
+	/* select, pulses of deselect and reselect in one transaction, deselect */
+	std::vector<uint8_t> select = {I2C_EXPANDER_OUTPUT_REG_ADDR, comm[0].select};
+	std::vector<uint8_t> pulse = {I2C_EXPANDER_OUTPUT_REG_ADDR, I2C_EXPANDER_OUTPUT_DESELECT, comm[0].select};
+	std::vector<uint8_t> deselect = {I2C_EXPANDER_OUTPUT_REG_ADDR, I2C_EXPANDER_OUTPUT_DESELECT};
+	TEST_ASSERT_TRUE(wire.transactions.front() == select);
+	for (uint8_t i = 1; i < SAMPLE_ACCESSES; i++)
+	{
+		TEST_ASSERT_TRUE(wire.transactions[i] == pulse);
+	}
+	TEST_ASSERT_TRUE(wire.transactions.back() == deselect);
+}
+
+/**
+ * @brief An access to another sensor within a session does not leave two sensors selected
+ */
+void test_foreign_access_in_session(void)
+{
+	uint8_t data;
+
+	commMuxBeginSession(comm[0]);
+	TEST_ASSERT_EQUAL_INT8(0, commMuxRead(sampleRegs[0], &data, 1, &comm[0]));
+	TEST_ASSERT_EQUAL_INT8(0, commMuxRead(sampleRegs[0], &data, 1, &comm[1]));
+	TEST_ASSERT_EQUAL_UINT8(I2C_EXPANDER_OUTPUT_DESELECT, wire.outputs());
+	/* the session sensor is selected again from the deselected state */
+	TEST_ASSERT_EQUAL_INT8(0, commMuxRead(sampleRegs[0], &data, 1, &comm[0]));
+	TEST_ASSERT_EQUAL_UINT8(comm[0].select, wire.outputs());
+	commMuxEndSession();
+
+	for (const std::vector<uint8_t> &transaction : wire.transactions)
+	{
+		uint8_t mask = transaction.back();
+		/* at most one output driven low */
+		TEST_ASSERT_TRUE((mask == I2C_EXPANDER_OUTPUT_DESELECT) || (__builtin_popcount((uint8_t) ~mask) == 1));
+	}
+	TEST_ASSERT_EQUAL_UINT8(I2C_EXPANDER_OUTPUT_DESELECT, wire.outputs());
+}
+
+/**
+ * @brief A new session closes the open one first
+ */
+void test_nested_session(void)
+{
+	commMuxBeginSession(comm[0]);
+	readSample(comm[0]);
+	commMuxBeginSession(comm[1]);
+	readSample(comm[1]);
+	commMuxEndSession();
+
+	TEST_ASSERT_EQUAL_UINT32(2 * (SAMPLE_ACCESSES + 1), wire.transactions.size());
+	TEST_ASSERT_EQUAL_UINT32(SAMPLE_ACCESSES + 1, commMuxGetStats(comm[0]).expanderWrites);
+	TEST_ASSERT_EQUAL_UINT32(SAMPLE_ACCESSES + 1, commMuxGetStats(comm[1]).expanderWrites);
+	/* the bus is free again, the statistics can be taken without blocking */
+	TEST_ASSERT_EQUAL_UINT32(0, commMuxGetBusStats(COMM_MUX_OWNER_SENSORS).contentions);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_access_without_session);
+	RUN_TEST(test_access_in_session);
+	RUN_TEST(test_foreign_access_in_session);
+	RUN_TEST(test_nested_session);
+	return UNITY_END();
+}
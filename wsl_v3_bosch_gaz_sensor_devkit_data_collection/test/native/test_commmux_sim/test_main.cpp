@@ -0,0 +1,285 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host benchmark of commMux driving the simulated BME688 sensors on a virtual clock
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "commMux.h"
+
+/* Number of simulated sensors, one per expander output */
+#define SIM_UNITS 8
+/* Heater profile programmed into every sensor, one gas_wait multiplier per step */
+#define SIM_PROFILE_LEN 10
+/* Polling period of the benchmark, one heater step */
+#define SIM_POLL_US BME68X_SIM_STEP_BASE_US
+/* Simulated run time of one benchmark pass */
+#define SIM_RUN_US (60ULL * 1000000ULL)
+/* Register map of the BME688 */
+#define REG_FIELD0 0x1D
+#define LEN_FIELD 17
+#define NUM_FIELDS 3
+#define REG_GAS_WAIT0 0x64
+#define REG_CTRL_GAS_1 0x71
+#define REG_STATUS 0x73
+#define REG_CTRL_MEAS 0x74
+#define SPI_READ 0x80
+#define MEM_PAGE_1 0x10
+#define RUN_GAS 0x20
+#define MODE_PARALLEL 0x02
+#define NEW_DATA 0x80
+
+/* Virtual time base, only advances on delays */
+static uint64_t virtualUs = 0;
+
+static uint64_t virtualNow(void)
+{
+	return virtualUs;
+}
+
+static void virtualDelay(uint32_t period_us)
+{
+	virtualUs += period_us;
+}
+
+static const commMuxClock virtualClock = {virtualNow, virtualDelay};
+
+static TwoWire wire;
+static SPIClass spi;
+static commMux comm[SIM_UNITS];
+
+/**
+ * Outcome of one benchmark pass
+ */
+struct simRun {
+	uint32_t fields[SIM_UNITS];
+	uint32_t errors[SIM_UNITS];
+	uint32_t accesses;
+	uint32_t expanderWrites;
+	uint32_t checksum;
+	double hostNsPerAccess;
+};
+
+/**
+ * @brief This function powers up the simulated sensors and starts their parallel mode sequence
+ */
+static void startSensors(void)
+{
+	virtualUs = 0;
+	commMuxSetClock(&virtualClock);
+	commMuxBegin(wire, spi);
+
+	for (uint8_t i = 0; i < SIM_UNITS; i++)
+	{
+		uint8_t page = MEM_PAGE_1;
+		uint8_t gasCtrl = RUN_GAS | SIM_PROFILE_LEN;
+		uint8_t mode = MODE_PARALLEL;
+		uint8_t gasWait[2 * SIM_PROFILE_LEN - 1];
+
+		(void) commMuxSetConfig(wire, spi, i, comm[i]);
+		commMuxResetStats(comm[i]);
+		/* first register as address and data, the others as address/data pairs */
+		gasWait[0] = 1;
+		for (uint8_t s = 1; s < SIM_PROFILE_LEN; s++)
+		{
+			gasWait[2 * s - 1] = REG_GAS_WAIT0 + s;
+			gasWait[2 * s] = 1;
+		}
+		TEST_ASSERT_EQUAL(0, commMuxWrite(REG_STATUS, &page, 1, &comm[i]));
+		TEST_ASSERT_EQUAL(0, commMuxWrite(REG_GAS_WAIT0, gasWait, sizeof(gasWait), &comm[i]));
+		TEST_ASSERT_EQUAL(0, commMuxWrite(REG_CTRL_GAS_1, &gasCtrl, 1, &comm[i]));
+		TEST_ASSERT_EQUAL(0, commMuxWrite(REG_CTRL_MEAS, &mode, 1, &comm[i]));
+	}
+}
+
+/**
+ * @brief This function polls all sensors once per heater step for the run time, as the sensor manager does
+ */
+static simRun pollSensors(void)
+{
+	simRun run;
+	uint8_t fields[NUM_FIELDS * LEN_FIELD];
+	uint32_t startWrites = commMuxGetExpanderWrites();
+	uint64_t hostNs = 0;
+
+	memset(&run, 0, sizeof(run));
+	while (virtualUs < SIM_RUN_US)
+	{
+		commMuxDelay(SIM_POLL_US, nullptr);
+		for (uint8_t i = 0; i < SIM_UNITS; i++)
+		{
+			uint8_t status;
+			auto start = std::chrono::steady_clock::now();
+
+			commMuxBeginSession(comm[i]);
+			int8_t rslt = commMuxRead(REG_STATUS | SPI_READ, &status, 1, &comm[i]);
+			if (rslt == 0)
+			{
+				rslt = commMuxRead(REG_FIELD0 | SPI_READ, fields, sizeof(fields), &comm[i]);
+			}
+			commMuxEndSession();
+			hostNs += (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			run.accesses += 2;
+
+			if (rslt != 0)
+			{
+				run.errors[i]++;
+				continue;
+			}
+			for (uint8_t f = 0; f < NUM_FIELDS; f++)
+			{
+				const uint8_t *field = &fields[f * LEN_FIELD];
+				if (field[0] & NEW_DATA)
+				{
+					run.fields[i]++;
+					for (uint8_t b = 0; b < LEN_FIELD; b++)
+					{
+						run.checksum = (run.checksum * 31) + field[b];
+					}
+				}
+			}
+		}
+	}
+	run.expanderWrites = commMuxGetExpanderWrites() - startWrites;
+	run.hostNsPerAccess = run.accesses ? ((double) hostNs / run.accesses) : 0;
+	return run;
+}
+
+void setUp(void)
+{
+	for (uint8_t i = 0; i < SIM_UNITS; i++)
+	{
+		commMuxGetSim(i)->setFaults(BME68X_SIM_FAULT_NONE);
+	}
+}
+
+void tearDown(void)
+{
+	commMuxSetClock(nullptr);
+}
+
+/**
+ * @brief Every heater step of every sensor is published once, polling once per step keeps up
+ */
+void test_throughput(void)
+{
+	startSensors();
+	simRun run = pollSensors();
+	uint32_t expected = (uint32_t) (SIM_RUN_US / SIM_POLL_US);
+	uint32_t total = 0;
+
+	for (uint8_t i = 0; i < SIM_UNITS; i++)
+	{
+		TEST_ASSERT_EQUAL_UINT32(0, run.errors[i]);
+		TEST_ASSERT_EQUAL_UINT32(commMuxGetSim(i)->getFieldCount(), run.fields[i]);
+		TEST_ASSERT_LESS_OR_EQUAL(1, (int32_t) expected - (int32_t) run.fields[i]);
+		total += run.fields[i];
+	}
+	/* a session costs one select, a pulse for the second access and one deselect */
+	TEST_ASSERT_EQUAL_UINT32(run.accesses / 2 * 3, run.expanderWrites);
+
+	printf("throughput: %.1f fields/s over %u sensors, %.2f expander writes per poll, %.0f host ns per access\n",
+		(double) total * 1000000.0 / SIM_RUN_US, SIM_UNITS, (double) run.expanderWrites * 2 / run.accesses, run.hostNsPerAccess);
+}
+
+/**
+ * @brief Two passes from the same start read the same data, the virtual clock makes runs reproducible
+ */
+void test_reproducible(void)
+{
+	startSensors();
+	simRun first = pollSensors();
+	startSensors();
+	simRun second = pollSensors();
+
+	TEST_ASSERT_EQUAL_UINT32(first.checksum, second.checksum);
+	TEST_ASSERT_EQUAL_MEMORY(first.fields, second.fields, sizeof(first.fields));
+	TEST_ASSERT_EQUAL_UINT32(first.expanderWrites, second.expanderWrites);
+}
+
+/**
+ * @brief Injected faults show up on the faulty sensor only
+ */
+void test_faults(void)
+{
+	startSensors();
+	commMuxGetSim(1)->setFaults(BME68X_SIM_FAULT_BUS);
+	commMuxGetSim(2)->setFaults(BME68X_SIM_FAULT_STUCK);
+	commMuxGetSim(3)->setFaults(BME68X_SIM_FAULT_DROP_FIELD);
+	simRun run = pollSensors();
+
+	TEST_ASSERT_EQUAL_UINT32(run.accesses / 2 / SIM_UNITS, run.errors[1]);
+	TEST_ASSERT_EQUAL_UINT32(0, run.fields[1]);
+	TEST_ASSERT_EQUAL_UINT32(0, run.fields[2]);
+	/* the dropped step is lost, the sequence goes on */
+	TEST_ASSERT_EQUAL_UINT32(run.fields[0] - 1, run.fields[3]);
+	for (uint8_t i = 4; i < SIM_UNITS; i++)
+	{
+		TEST_ASSERT_EQUAL_UINT32(0, run.errors[i]);
+		TEST_ASSERT_EQUAL_UINT32(run.fields[0], run.fields[i]);
+	}
+}
+
+/**
+ * @brief The bus statistics run on the virtual clock: no time passes within a poll
+ */
+void test_bus_stats(void)
+{
+	startSensors();
+	commMuxBusStats before = commMuxGetBusStats(COMM_MUX_OWNER_SENSORS);
+	simRun run = pollSensors();
+	commMuxBusStats after = commMuxGetBusStats(COMM_MUX_OWNER_SENSORS);
+
+	TEST_ASSERT_EQUAL_UINT32(run.accesses / 2, after.acquisitions - before.acquisitions);
+	TEST_ASSERT_EQUAL_UINT32(0, after.contentions - before.contentions);
+	TEST_ASSERT_EQUAL_UINT32(0, after.maxHoldUs);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_throughput);
+	RUN_TEST(test_reproducible);
+	RUN_TEST(test_faults);
+	RUN_TEST(test_bus_stats);
+	return UNITY_END();
+}
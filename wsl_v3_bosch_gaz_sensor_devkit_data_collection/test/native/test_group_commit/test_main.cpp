@@ -0,0 +1,214 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host test of the group commit flush policy and its counters, on a fake clock
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include "group_commit.h"
+
+/* Time of the fake clock (ms) */
+static uint32_t nowMs = 0;
+
+/*!
+ * @brief : Fake clock of the tests, advanced by hand
+ */
+static uint32_t fakeClockMs(void)
+{
+	return nowMs;
+}
+
+/*!
+ * @brief : Sets a policy on a commit tracking the fake clock
+ */
+static void setPolicy(groupCommit& commit, uint32_t maxBytes, uint32_t maxDelayMs, bool onLabelChange)
+{
+	logFlushPolicy policy;
+	
+	policy.maxBytes = maxBytes;
+	policy.maxDelayMs = maxDelayMs;
+	policy.onLabelChange = onLabelChange;
+	commit.setPolicy(policy);
+}
+
+void setUp(void)
+{
+	/* close to the wrap around, the durations are computed modulo 2^32 */
+	nowMs = UINT32_C(0xFFFFF000);
+}
+
+void tearDown(void)
+{
+}
+
+/** @brief The default policy is the one of a configuration without "dataLogging" */
+void test_default_policy(void)
+{
+	groupCommit commit(fakeClockMs);
+	
+	TEST_ASSERT_EQUAL_UINT32(LOG_FLUSH_DEFAULT_BYTES, commit.getPolicy().maxBytes);
+	TEST_ASSERT_EQUAL_UINT32(LOG_FLUSH_DEFAULT_DELAY_MS, commit.getPolicy().maxDelayMs);
+	TEST_ASSERT_EQUAL(LOG_FLUSH_DEFAULT_ON_LABEL, commit.getPolicy().onLabelChange);
+}
+
+/** @brief The pending data is due once it reaches the byte threshold */
+void test_byte_threshold(void)
+{
+	groupCommit commit(fakeClockMs);
+	
+	setPolicy(commit, 100, 60000, false);
+	commit.add(60, 1);
+	TEST_ASSERT_FALSE(commit.isDue(1));
+	commit.add(39, 1);
+	TEST_ASSERT_FALSE(commit.isDue(1));
+	commit.add(1, 1);
+	TEST_ASSERT_TRUE(commit.isDue(1));
+	
+	commit.committed(100);
+	TEST_ASSERT_FALSE(commit.isDue(1));
+}
+
+/** @brief The pending data is due once the oldest pending data reaches the time threshold */
+void test_time_threshold(void)
+{
+	groupCommit commit(fakeClockMs);
+	
+	setPolicy(commit, 100000, 1000, false);
+	commit.add(10, 1);
+	nowMs += 600;
+	/* newer data does not restart the delay */
+	commit.add(10, 1);
+	nowMs += 399;
+	TEST_ASSERT_FALSE(commit.isDue(1));
+	nowMs += 1;
+	TEST_ASSERT_TRUE(commit.isDue(1));
+	
+	/* the delay starts again with the first data after a flush */
+	commit.committed(20);
+	nowMs += 5000;
+	commit.add(10, 1);
+	TEST_ASSERT_FALSE(commit.isDue(1));
+	nowMs += 1000;
+	TEST_ASSERT_TRUE(commit.isDue(1));
+}
+
+/** @brief A label change makes the pending data due only when the policy asks for it */
+void test_label_change(void)
+{
+	groupCommit onChange(fakeClockMs);
+	groupCommit offChange(fakeClockMs);
+	
+	setPolicy(onChange, 100000, 60000, true);
+	setPolicy(offChange, 100000, 60000, false);
+	onChange.add(10, 1);
+	offChange.add(10, 1);
+	
+	TEST_ASSERT_FALSE(onChange.isDue(1));
+	TEST_ASSERT_TRUE(onChange.isDue(2));
+	TEST_ASSERT_FALSE(offChange.isDue(1));
+	TEST_ASSERT_FALSE(offChange.isDue(2));
+	
+	/* the label of the latest data is the pending one */
+	onChange.add(10, 2);
+	TEST_ASSERT_FALSE(onChange.isDue(2));
+	TEST_ASSERT_TRUE(onChange.isDue(1));
+}
+
+/** @brief Nothing is due without pending data, whatever the time and label */
+void test_nothing_pending(void)
+{
+	groupCommit commit(fakeClockMs);
+	
+	setPolicy(commit, 1, 1, true);
+	TEST_ASSERT_FALSE(commit.isDue(1));
+	nowMs += 100000;
+	TEST_ASSERT_FALSE(commit.isDue(2));
+	
+	commit.add(10, 1);
+	TEST_ASSERT_TRUE(commit.isDue(1));
+	commit.committed(10);
+	nowMs += 100000;
+	TEST_ASSERT_FALSE(commit.isDue(2));
+}
+
+/** @brief The counters give the flushes per minute and the average bytes, empty flushes left out */
+void test_counters(void)
+{
+	groupCommit commit(fakeClockMs);
+	
+	setPolicy(commit, 100, 1000, true);
+	TEST_ASSERT_EQUAL_UINT32(0, commit.getFlushes());
+	TEST_ASSERT_EQUAL_UINT32(0, commit.getAverageBytes());
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, commit.getFlushesPerMinute());
+	
+	commit.add(100, 1);
+	commit.committed(100);
+	nowMs += 10000;
+	commit.add(200, 1);
+	commit.committed(200);
+	nowMs += 10000;
+	/* a flush that wrote nothing is not counted */
+	commit.committed(0);
+	commit.add(300, 1);
+	commit.committed(300);
+	nowMs += 10000;
+	
+	TEST_ASSERT_EQUAL_UINT32(3, commit.getFlushes());
+	TEST_ASSERT_EQUAL_UINT32(200, commit.getAverageBytes());
+	TEST_ASSERT_EQUAL_FLOAT(6.0f, commit.getFlushesPerMinute());
+	
+	/* a new policy starts the counters again */
+	setPolicy(commit, 100, 1000, true);
+	TEST_ASSERT_EQUAL_UINT32(0, commit.getFlushes());
+	TEST_ASSERT_EQUAL_UINT32(0, commit.getAverageBytes());
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_default_policy);
+	RUN_TEST(test_byte_threshold);
+	RUN_TEST(test_time_threshold);
+	RUN_TEST(test_label_change);
+	RUN_TEST(test_nothing_pending);
+	RUN_TEST(test_counters);
+	return UNITY_END();
+}
@@ -0,0 +1,390 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host test of bmerawbin_convert.py: the .bmerawbin and .bmerawz files of a sample set convert to the .bmerawdata text of the same samples
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "raw_record.h"
+#include "raw_row.h"
+#include "sample_encoder.h"
+
+/* Converter, relative to the project directory the tests run from */
+#define LOG_CONVERTER 			"../bmerawbin_convert.py"
+/* Samples of the set, several .bmerawz blocks */
+#define TEST_SAMPLES 			6000
+/* Space of one row, as kept free in the datalogger buffer */
+#define TEST_ROW_MAX_LEN 		384
+/* Layout of the .bmerawdata files, see createFile and closeFile of bme68x_datalogger.cpp */
+#define TEST_SECTOR_SIZE 		512
+#define TEST_DATA_BLOCK_LINE 	"\t    \"dataBlock\": ["
+#define TEST_FOOTER 			"\n\t    ]\n\t}\n}\n\r\n"
+
+/*!
+ * @brief : Output collecting the printed bytes, println ends the lines with "\r\n" like the Arduino Print class
+ */
+class stringPrint
+{
+public:
+	std::string text;
+	
+	void print(const char* str)
+	{
+		text += str;
+	}
+	
+	void println(const char* str)
+	{
+		text += str;
+		text += "\r\n";
+	}
+};
+
+/*!
+ * @brief : One sample of the set and its 64 bit time since power on
+ */
+struct testSample
+{
+	bme68xRawBinRecord record;
+	uint64_t timeSincePowerOn;
+};
+
+static std::vector<testSample> samples;
+static std::string headerText;
+static std::string tempDir;
+
+/*!
+ * @brief : Builds the sample set: 8 sensors cycling through their heater profile steps, label and mode changes,
+ *			error rows without sensor nor data, and a time since power on crossing 2^32 ms
+ */
+static void makeSamples(void)
+{
+	uint64_t tick = UINT64_C(0xFFFFFFFF) - 60000;
+	uint32_t rtc = 1760000000;
+	
+	samples.clear();
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++)
+	{
+		testSample sample;
+		bme68xRawBinRecord& record = sample.record;
+		uint8_t sensor = i % 8;
+		uint8_t step = (i / 8) % 12;
+		
+		tick += 17 + (i % 5);
+		if ((i % 59) == 0)
+		{
+			rtc++;
+		}
+		sample.timeSincePowerOn = tick;
+		record.timeSincePowerOn = (uint32_t)tick;
+		record.rtcTsp = rtc;
+		if ((i % 997) == 500)
+		{
+			/* error row, as written without sensor */
+			record.sensorIndex = BME68X_RAWBIN_NULL;
+			record.sensorId = 0;
+			record.gasIndex = BME68X_RAWBIN_NULL;
+			record.temperature = record.pressure = record.humidity = record.gasResistance = NAN;
+			record.modeLabel = BME68X_RAWBIN_MODE_NULL;
+			record.code = -12;
+		}
+		else
+		{
+			record.sensorIndex = sensor;
+			/* ids above 2^31 print as negative numbers */
+			record.sensorId = UINT32_C(0x9A000000) + sensor * UINT32_C(0x01234567);
+			/* steps beyond RAWZ_MAX_STEPS are encoded against 0 */
+			record.gasIndex = step;
+			record.temperature = 24.0f + sensor * 0.5f + (float)(i % 300) * 0.0131f - ((i % 1000) == 3 ? 40.0f : 0.0f);
+			record.pressure = 101325.0f * .01f + (float)(i % 17) * 0.07f;
+			record.humidity = 40.125f + (float)(i % 200) * 0.019f;
+			record.gasResistance = ((i % 1500) == 7) ? 2.5e9f : 1500.0f * (step + 1) + (float)(i % 97) * 13.37f;
+			record.modeLabel = (uint8_t)((i / 2000) % 2);
+			record.code = 0;
+		}
+		record.modeLabel |= (uint8_t)(((i / 700) % 5) << 4);
+		samples.push_back(sample);
+	}
+}
+
+/*!
+ * @brief : Builds the header text the binary files embed, the one of the .bmerawdata files up to its dataBlock line
+ */
+static void makeHeader(void)
+{
+	stringPrint header;
+	
+	header.println("{");
+	header.println("    \"configHeader\": {},");
+	header.println("    \"configBody\": {},");
+	header.println("    \"rawDataHeader\":");
+	header.println("\t{");
+	header.println("\t    \"counterPowerOnOff\": 1,");
+	header.println("\t    \"firmwareVersion\": \"1.5.5\"");
+	header.println("\t},");
+	header.println("    \"rawDataBody\":");
+	header.println("\t{");
+	logSchema::writeColumns(header, bme68xLogColumns, BME68X_LOG_COLUMN_COUNT);
+	headerText = header.text;
+}
+
+/*!
+ * @brief : Returns the .bmerawdata text the datalogger writes for the sample set
+ *
+ * @param[in] wide : the 64 bit time since power on of the Json and .bmerawz files, else the 32 bit one of the .bmerawbin records
+ */
+static std::string makeText(bool wide)
+{
+	std::string text = headerText;
+	std::vector<char> row(TEST_ROW_MAX_LEN);
+	
+	/* blank padding, the first row starts on a sector boundary */
+	size_t lineEnd = text.size() + strlen(TEST_DATA_BLOCK_LINE) + 2;
+	while (lineEnd++ % TEST_SECTOR_SIZE)
+	{
+		text += ' ';
+	}
+	text += TEST_DATA_BLOCK_LINE "\r\n";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		size_t len = 0;
+		uint64_t timeSincePowerOn = wide ? samples[i].timeSincePowerOn : samples[i].record.timeSincePowerOn;
+		
+		rawRow::appendText(row.data(), len, row.size(), samples[i].record, timeSincePowerOn);
+		if (i)
+		{
+			text += ",\n";
+		}
+		text.append(row.data(), len);
+	}
+	text += TEST_FOOTER;
+	return text;
+}
+
+/*!
+ * @brief : Returns a binary file of the sample set: fixed header, Json header with an empty dataBlock, zero padding
+ *			up to the first sector boundary and the records, fixed size or encoded
+ */
+static std::string makeBinary(bool compressed)
+{
+	stringPrint header;
+	bme68xRawBinHeader binHeader;
+	
+	header.text.assign(sizeof(binHeader), '\0');
+	header.text += headerText;
+	header.println(TEST_DATA_BLOCK_LINE);
+	header.println("\t    ]");
+	header.println("\t}");
+	header.println("}");
+	while (header.text.size() % TEST_SECTOR_SIZE)
+	{
+		header.text += '\0';
+	}
+	
+	memcpy(binHeader.magic, compressed ? BME68X_RAWZ_MAGIC : BME68X_RAWBIN_MAGIC, sizeof(binHeader.magic));
+	binHeader.version = compressed ? BME68X_RAWZ_VERSION : BME68X_RAWBIN_VERSION;
+	binHeader.recordSize = compressed ? 0 : sizeof(bme68xRawBinRecord);
+	binHeader.dataOffset = header.text.size();
+	header.text.replace(0, sizeof(binHeader), (const char*)&binHeader, sizeof(binHeader));
+	
+	sampleEncoder encoder;
+	uint8_t out[RAWZ_BLOCK_SYNC_LEN + RAWZ_RECORD_MAX_LEN + 1];
+	for (const testSample& sample : samples)
+	{
+		if (compressed)
+		{
+			size_t len = encoder.encode(out, sample.record, sample.timeSincePowerOn);
+			header.text.append((const char*)out, len);
+		}
+		else
+		{
+			header.text.append((const char*)&sample.record, sizeof(sample.record));
+		}
+	}
+	return header.text;
+}
+
+/*!
+ * @brief : Writes a file
+ */
+static bool writeFile(const std::string& path, const std::string& data)
+{
+	std::ofstream file(path, std::ios::binary);
+	file.write(data.data(), data.size());
+	return file.good();
+}
+
+/*!
+ * @brief : Reads a file, empty if missing
+ */
+static std::string readFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream data;
+	data << file.rdbuf();
+	return data.str();
+}
+
+/*!
+ * @brief : Runs the converter on a binary file, returns its .bmerawdata output
+ */
+static std::string convert(const std::string& name, const std::string& data)
+{
+	std::string input = tempDir + "/" + name;
+	std::string output = input + ".bmerawdata";
+	std::string command = "python3 " LOG_CONVERTER " \"" + input + "\" -o \"" + output + "\" > /dev/null";
+	
+	if (!writeFile(input, data) || (system(command.c_str()) != 0))
+	{
+		return std::string();
+	}
+	return readFile(output);
+}
+
+/*!
+ * @brief : Prints the first difference of two texts
+ */
+static void printDifference(const std::string& expected, const std::string& actual)
+{
+	size_t pos = 0;
+	while ((pos < expected.size()) && (pos < actual.size()) && (expected[pos] == actual[pos]))
+	{
+		pos++;
+	}
+	size_t start = (pos > 40) ? pos - 40 : 0;
+	printf("  sizes %zu/%zu, first difference at %zu\n  exp [%s]\n  got [%s]\n", expected.size(), actual.size(), pos,
+		   expected.substr(start, 80).c_str(), actual.substr(start, 80).c_str());
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/** @brief A row prints its columns in the dataColumns order, the floats with 6 decimals, missing values as null */
+void test_row_text(void)
+{
+	bme68xRawBinRecord record;
+	char row[TEST_ROW_MAX_LEN];
+	size_t len = 0;
+	
+	record.sensorIndex = 3;
+	record.sensorId = UINT32_C(0xFFFE1DC0);
+	record.rtcTsp = 1700000000;
+	record.temperature = 25.5f;
+	record.pressure = 1013.25f;
+	record.humidity = 40.125f;
+	record.gasResistance = 123456.0f;
+	record.gasIndex = 7;
+	record.modeLabel = (2 << 4) | 1;
+	record.code = -5;
+	rawRow::appendText(row, len, sizeof(row), record, UINT64_C(4294967396));
+	row[len] = '\0';
+	TEST_ASSERT_EQUAL_STRING("\t\t[3,-123456,4294967396,1700000000,25.500000,1013.250000,40.125000,123456.000000,7,1,2,-5]", row);
+	
+	len = 0;
+	record.sensorIndex = BME68X_RAWBIN_NULL;
+	record.gasIndex = BME68X_RAWBIN_NULL;
+	record.modeLabel = BME68X_RAWBIN_MODE_NULL;
+	record.code = -12;
+	rawRow::appendText(row, len, sizeof(row), record, 42);
+	row[len] = '\0';
+	TEST_ASSERT_EQUAL_STRING("\t\t[null,null,42,1700000000,null,null,null,null,null,null,0,-12]", row);
+}
+
+/** @brief The .bmerawz file of the sample set converts to the .bmerawdata text, byte for byte */
+void test_convert_compressed(void)
+{
+	std::string expected = makeText(true);
+	std::string actual = convert("samples.bmerawz", makeBinary(true));
+	
+	if (actual != expected)
+	{
+		printDifference(expected, actual);
+	}
+	TEST_ASSERT_TRUE(actual == expected);
+}
+
+/** @brief The .bmerawbin file of the sample set converts to the .bmerawdata text, with the 32 bit time since power on */
+void test_convert_binary(void)
+{
+	std::string expected = makeText(false);
+	std::string actual = convert("samples.bmerawbin", makeBinary(false));
+	
+	if (actual != expected)
+	{
+		printDifference(expected, actual);
+	}
+	TEST_ASSERT_TRUE(actual == expected);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	char dirTemplate[] = "/tmp/test_log_convert_XXXXXX";
+	
+	if (mkdtemp(dirTemplate) == nullptr)
+	{
+		return 1;
+	}
+	tempDir = dirTemplate;
+	makeSamples();
+	makeHeader();
+	
+	UNITY_BEGIN();
+	RUN_TEST(test_row_text);
+	RUN_TEST(test_convert_compressed);
+	RUN_TEST(test_convert_binary);
+	int failures = UNITY_END();
+	
+	(void) system(("rm -rf \"" + tempDir + "\"").c_str());
+	return failures;
+}
@@ -0,0 +1,275 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host test of the recovery of a log file left open by a power loss, on a file in memory
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "log_recovery.h"
+#include "storage_crc.h"
+
+/* Position of the first row, sector aligned */
+#define DATA_START 		512
+/* Size of a log file with its preallocated space */
+#define ALLOC_SIZE 		8192
+
+/* Log file in memory */
+static std::vector<uint8_t> logFile;
+/* Journal of the open log marker and sequence number of the last write */
+static bme68xJournalEntry journal[BME68X_LOG_JOURNAL_SLOTS];
+static uint32_t journalSeq;
+
+/*!
+ * @brief : Reads the log file in memory
+ */
+static size_t readBuffer(void* context, size_t pos, uint8_t* data, size_t len)
+{
+	const std::vector<uint8_t>* file = (const std::vector<uint8_t>*)context;
+	
+	if (pos >= file->size())
+	{
+		return 0;
+	}
+	if (len > (file->size() - pos))
+	{
+		len = file->size() - pos;
+	}
+	memcpy(data, file->data() + pos, len);
+	return len;
+}
+
+/*!
+ * @brief : Writes and journals rows up to the end, as the SD writer task: the write starts on the sector of
+ *			the end of the previous write, whose partial sector is written again
+ *
+ * @return the journal entry of the write
+ */
+static bme68xJournalEntry writeRows(size_t end, uint8_t fill)
+{
+	bme68xJournalEntry entry;
+	size_t prevEnd = journalSeq ? journal[journalSeq % BME68X_LOG_JOURNAL_SLOTS].end : DATA_START;
+	
+	entry.seq = ++journalSeq;
+	entry.start = prevEnd - (prevEnd % 512);
+	entry.end = end;
+	memset(&logFile[prevEnd], fill, end - prevEnd);
+	entry.crc = storageCrc::crc32(&logFile[entry.start], entry.end - entry.start);
+	journal[entry.seq % BME68X_LOG_JOURNAL_SLOTS] = entry;
+	return entry;
+}
+
+/*!
+ * @brief : Overwrites part of the log file, as a write torn by a power loss
+ */
+static void tear(size_t start, size_t end)
+{
+	memset(&logFile[start], 0xA5, end - start);
+}
+
+void setUp(void)
+{
+	logFile.assign(ALLOC_SIZE, 0);
+	memset(logFile.data(), 'h', DATA_START);
+	memset(journal, 0, sizeof(journal));
+	journalSeq = 0;
+}
+
+void tearDown(void)
+{
+}
+
+/** @brief The file is kept up to the end of the latest intact write, the preallocated space is cut off */
+void test_intact_writes(void)
+{
+	writeRows(1300, 'a');
+	writeRows(2100, 'b');
+	
+	TEST_ASSERT_EQUAL_UINT32(2100, logRecovery::committedLength(readBuffer, &logFile, journal, 0, logFile.size()));
+}
+
+/** @brief A torn latest write is cut off, the file is kept up to the end of the previous write */
+void test_torn_latest_write(void)
+{
+	writeRows(1300, 'a');
+	bme68xJournalEntry latest = writeRows(2100, 'b');
+	
+	/* the sectors after the first one of the write, the previous write is intact */
+	tear(latest.start + 512, latest.end);
+	TEST_ASSERT_EQUAL_UINT32(1300, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+}
+
+/** @brief A torn first sector damages the partial sector of the previous write, the file is kept up to its start */
+void test_torn_first_sector(void)
+{
+	bme68xJournalEntry previous = writeRows(1300, 'a');
+	bme68xJournalEntry latest = writeRows(2100, 'b');
+	
+	TEST_ASSERT_EQUAL_UINT32(1024, latest.start);
+	tear(latest.start, latest.start + 100);
+	TEST_ASSERT_EQUAL_UINT32(previous.start, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+	
+	/* an intact write before it is kept whole */
+	setUp();
+	bme68xJournalEntry first = writeRows(900, 'a');
+	previous = writeRows(1300, 'b');
+	latest = writeRows(2100, 'c');
+	tear(latest.start, latest.start + 100);
+	TEST_ASSERT_EQUAL_UINT32(first.end, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+}
+
+/** @brief The entries are checked in seq order, not slot order, once the journal wrapped */
+void test_seq_wrap(void)
+{
+	size_t end = DATA_START;
+	bme68xJournalEntry entries[11];
+	
+	for (uint8_t i = 0; i < 11; i++)
+	{
+		end += 300;
+		entries[i] = writeRows(end, 'a' + i);
+	}
+	/* slot 3 holds the latest write, slot 7 an older one */
+	TEST_ASSERT_EQUAL_UINT32(11, journal[3].seq);
+	TEST_ASSERT_EQUAL_UINT32(7, journal[7].seq);
+	TEST_ASSERT_EQUAL_UINT32(entries[10].end, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+	
+	tear(entries[10].end - 10, entries[10].end);
+	TEST_ASSERT_EQUAL_UINT32(entries[9].end, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+	
+	/* the writes up to seq 3 are no longer journaled: without an intact write, the oldest journaled start is kept */
+	tear(entries[3].start, entries[10].end);
+	TEST_ASSERT_EQUAL_UINT32(entries[3].start, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+}
+
+/** @brief A marker without journal, written before the journal existed, gives the committed length */
+void test_legacy_marker(void)
+{
+	TEST_ASSERT_EQUAL_UINT32(0, logRecovery::checkJournal(readBuffer, &logFile, journal, logFile.size()));
+	TEST_ASSERT_EQUAL_UINT32(1500, logRecovery::committedLength(readBuffer, &logFile, journal, 1500, logFile.size()));
+	/* without a length either, the whole file */
+	TEST_ASSERT_EQUAL_UINT32(ALLOC_SIZE, logRecovery::committedLength(readBuffer, &logFile, journal, 0, logFile.size()));
+	/* a length past the end of the file */
+	TEST_ASSERT_EQUAL_UINT32(ALLOC_SIZE, logRecovery::committedLength(readBuffer, &logFile, journal, ALLOC_SIZE + 1, logFile.size()));
+}
+
+/*!
+ * @brief : Sets the log file to a text
+ */
+static void setText(const std::string& text)
+{
+	logFile.assign(text.begin(), text.end());
+}
+
+/** @brief A .bmerawdata tail without a complete row is cut after the dataBlock line, the footer is added */
+void test_json_no_row(void)
+{
+	std::string header = "{\r\n\t\"rawDataBody\": {\r\n" + std::string(400, ' ') + "\t    \"dataBlock\": [\r\n";
+	bool addFooter = false;
+	
+	setText(header + "\t\t[120000, 1700000000, 0, 1234");
+	TEST_ASSERT_EQUAL_UINT32(header.size(), logRecovery::cutJson(readBuffer, &logFile, logFile.size(), addFooter));
+	TEST_ASSERT_TRUE(addFooter);
+}
+
+/** @brief A .bmerawdata file is cut after its last complete row, a complete file is kept */
+void test_json_rows(void)
+{
+	std::string rows = std::string(600, ' ') + "\t    \"dataBlock\": [\r\n"
+					   "\t\t[120000, 1700000000, 0, 1234, 24.5, 980.25, 40.125, 10500.5, 3, 1, 0, 0],\n"
+					   "\t\t[120140, 1700000000, 0, 1234, 24.5, 980.25, 40.125, 10500.5, 4, 1, 0, 0]";
+	bool addFooter = false;
+	
+	setText(rows + ",\n\t\t[120280, 17000");
+	TEST_ASSERT_EQUAL_UINT32(rows.size(), logRecovery::cutJson(readBuffer, &logFile, logFile.size(), addFooter));
+	TEST_ASSERT_TRUE(addFooter);
+	
+	setText(rows + END_OF_FILE "\r\n");
+	TEST_ASSERT_EQUAL_UINT32(logFile.size(), logRecovery::cutJson(readBuffer, &logFile, logFile.size(), addFooter));
+	TEST_ASSERT_FALSE(addFooter);
+}
+
+/** @brief A .bmerawbin file is cut to whole records */
+void test_binary_records(void)
+{
+	bme68xRawBinHeader binHeader;
+	
+	memcpy(binHeader.magic, BME68X_RAWBIN_MAGIC, sizeof(binHeader.magic));
+	binHeader.version = BME68X_RAWBIN_VERSION;
+	binHeader.recordSize = BME68X_RAWBIN_RECORD_SIZE;
+	binHeader.dataOffset = DATA_START;
+	memcpy(logFile.data(), &binHeader, sizeof(binHeader));
+	
+	TEST_ASSERT_EQUAL_UINT32(DATA_START + 5 * BME68X_RAWBIN_RECORD_SIZE,
+							 logRecovery::cutBinary(readBuffer, &logFile, DATA_START + 5 * BME68X_RAWBIN_RECORD_SIZE + 17));
+	TEST_ASSERT_EQUAL_UINT32(DATA_START, logRecovery::cutBinary(readBuffer, &logFile, DATA_START + 31));
+	
+	/* a .bmerawz file has no record size, it is kept up to the committed length */
+	binHeader.recordSize = 0;
+	memcpy(logFile.data(), &binHeader, sizeof(binHeader));
+	TEST_ASSERT_EQUAL_UINT32(DATA_START + 17, logRecovery::cutBinary(readBuffer, &logFile, DATA_START + 17));
+}
+
+/** @brief The CRC is the CRC-32 of the ROM of the board */
+void test_crc(void)
+{
+	const char* check = "123456789";
+	
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926, storageCrc::crc32((const uint8_t*)check, 9));
+	/* in chunks */
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926, storageCrc::crc32((const uint8_t*)check + 4, 5, storageCrc::crc32((const uint8_t*)check, 4)));
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_intact_writes);
+	RUN_TEST(test_torn_latest_write);
+	RUN_TEST(test_torn_first_sector);
+	RUN_TEST(test_seq_wrap);
+	RUN_TEST(test_legacy_marker);
+	RUN_TEST(test_json_no_row);
+	RUN_TEST(test_json_rows);
+	RUN_TEST(test_binary_records);
+	RUN_TEST(test_crc);
+	return UNITY_END();
+}
@@ -0,0 +1,314 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host test of the log file column headers generated from the column schema against the former hand-written ones
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <string>
+#include "log_schema.h"
+
+/*!
+ * @brief : Output collecting the printed bytes, println ends the lines with "\r\n" like the Arduino Print class
+ */
+class stringPrint
+{
+public:
+	std::string text;
+	
+	void print(const char* str)
+	{
+		text += str;
+	}
+	
+	void println(const char* str)
+	{
+		text += str;
+		text += "\r\n";
+	}
+};
+
+/*!
+ * @brief This function writes the dataColumns header of the .bmerawdata files as the 1.5.5 datalogger did
+ */
+static void writeLegacyBme68xColumns(stringPrint& legacy)
+{
+	legacy.println("\t    \"dataColumns\": [");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Sensor Index\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"sensor_index\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Sensor ID\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"sensorId\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Time Since PowerOn\",");
+	legacy.println("\t\t    \"unit\": \"Milliseconds\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"timestamp_since_poweron\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Real time clock\",");
+	legacy.println("\t\t    \"unit\": \"Unix Timestamp: seconds since Jan 01 1970. (UTC); 0 = missing\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"real_time_clock\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Temperature\",");
+	legacy.println("\t\t    \"unit\": \"DegreesClecius\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"temperature\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Pressure\",");
+	legacy.println("\t\t    \"unit\": \"Hectopascals\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"pressure\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Relative Humidity\",");
+	legacy.println("\t\t    \"unit\": \"Percent\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"relative_humidity\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Resistance Gassensor\",");
+	legacy.println("\t\t    \"unit\": \"Ohms\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"resistance_gassensor\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Heater Profile Step Index\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"heater_profile_step_index\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Scanning enabled\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"scanning_enabled\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Label Tag\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"label_tag\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Error Code\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"error_code\"");
+	legacy.println("\t\t}");
+	legacy.println("\t    ],");
+}
+
+/*!
+ * @brief This function writes the dataColumns header of the .bsecdata files as the 1.5.5 datalogger did
+ */
+static void writeLegacyBsecColumns(stringPrint& legacy)
+{
+	legacy.println("\t    \"dataColumns\": [");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Sensor Index\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"sensorIndex\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Sensor ID\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"sensorId\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Time Since PowerOn\",");
+	legacy.println("\t\t    \"unit\": \"Milliseconds\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"timeSincePowerOn\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Real time clock\",");
+	legacy.println("\t\t    \"unit\": \"Unix Timestamp: seconds since Jan 01 1970. (UTC); 0 = missing\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"realTimeClock\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Temperature\",");
+	legacy.println("\t\t    \"unit\": \"DegreesClecius\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"temperature\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Pressure\",");
+	legacy.println("\t\t    \"unit\": \"Hectopascals\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"pressure\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Relative Humidity\",");
+	legacy.println("\t\t    \"unit\": \"Percent\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"relativeHumidity\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Resistance Gassensor\",");
+	legacy.println("\t\t    \"unit\": \"Ohms\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"resistance_gassensor\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Heater Profile Step Index\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"heater_profile_step_index\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Scanning enabled\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"scanning_enabled\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Label Tag\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"label_tag\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Error Code\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"error_code\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Gas estimate 1\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"gas_estimate_1\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Gas estimate 2\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"gas_estimate_2\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Gas estimate 3\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"gas_estimate_3\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Gas estimate 4\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"gas_estimate_4\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"Gas estimate accuracy\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"gas_estimate_accuracy\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"IAQ\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"float\",");
+	legacy.println("\t\t    \"key\": \"iaq\"");
+	legacy.println("\t\t},");
+	legacy.println("\t\t{");
+	legacy.println("\t\t    \"name\": \"IAQ accuracy\",");
+	legacy.println("\t\t    \"unit\": \"\",");
+	legacy.println("\t\t    \"format\": \"integer\",");
+	legacy.println("\t\t    \"key\": \"iaqAccuracy\"");
+	legacy.println("\t\t}");
+	legacy.println("\t    ],");
+}
+
+/*!
+ * @brief This function checks the .bmerawdata column header against the hand-written one, byte for byte
+ */
+void test_bme68x_columns_match_legacy(void)
+{
+	stringPrint legacy, schema;
+	
+	writeLegacyBme68xColumns(legacy);
+	logSchema::writeColumns(schema, bme68xLogColumns, BME68X_LOG_COLUMN_COUNT);
+	
+	TEST_ASSERT_EQUAL_UINT32((uint32_t) legacy.text.size(), (uint32_t) schema.text.size());
+	TEST_ASSERT_EQUAL_STRING(legacy.text.c_str(), schema.text.c_str());
+}
+
+/*!
+ * @brief This function checks the .bsecdata column header against the hand-written one, byte for byte
+ */
+void test_bsec_columns_match_legacy(void)
+{
+	stringPrint legacy, schema;
+	
+	writeLegacyBsecColumns(legacy);
+	logSchema::writeColumns(schema, bsecLogColumns, BSEC_LOG_COLUMN_COUNT);
+	
+	TEST_ASSERT_EQUAL_UINT32((uint32_t) legacy.text.size(), (uint32_t) schema.text.size());
+	TEST_ASSERT_EQUAL_STRING(legacy.text.c_str(), schema.text.c_str());
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_bme68x_columns_match_legacy);
+	RUN_TEST(test_bsec_columns_match_legacy);
+	return UNITY_END();
+}
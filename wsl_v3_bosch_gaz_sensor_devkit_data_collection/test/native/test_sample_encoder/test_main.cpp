@@ -0,0 +1,319 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host round trip test of the .bmerawz encoder against a decoder following bmerawbin_convert.py
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "sample_encoder.h"
+#include "raw_record.h"
+
+/* Records of the round trip, several blocks */
+#define TEST_RECORDS 			20000
+/* Heater profile steps of the generated samples, the last ones beyond RAWZ_MAX_STEPS */
+#define TEST_STEPS 				12
+/* Period of the generated samples (ms) */
+#define TEST_PERIOD_MS 			140
+
+/*!
+ * @brief : Decoded record and its 64 bit time since power on
+ */
+struct decodedRecord
+{
+	bme68xRawBinRecord record;
+	uint64_t timeSincePowerOn;
+};
+
+/*!
+ * @brief This function reads an unsigned LEB128 varint
+ */
+static uint64_t readVarint(const std::vector<uint8_t>& data, size_t& pos)
+{
+	uint64_t value = 0;
+	uint8_t shift = 0;
+	
+	while (data.at(pos) & 0x80)
+	{
+		value |= (uint64_t)(data[pos++] & 0x7F) << shift;
+		shift += 7;
+	}
+	value |= (uint64_t)data[pos++] << shift;
+	return value;
+}
+
+/*!
+ * @brief This function reads a zigzag varint delta and applies it to the previous value
+ */
+static uint64_t readDelta(const std::vector<uint8_t>& data, size_t& pos, uint64_t previous)
+{
+	uint64_t value = readVarint(data, pos);
+	
+	return previous + ((value >> 1) ^ (0 - (value & 1)));
+}
+
+/*!
+ * @brief This function decodes the blocks from pos on, as decode_blocks of bmerawbin_convert.py
+ */
+static std::vector<decodedRecord> decode(const std::vector<uint8_t>& data, size_t pos)
+{
+	std::vector<decodedRecord> records;
+	
+	while (pos + RAWZ_BLOCK_SYNC_LEN <= data.size())
+	{
+		if (memcmp(&data[pos], RAWZ_BLOCK_SYNC, RAWZ_BLOCK_SYNC_LEN))
+		{
+			pos++;
+			continue;
+		}
+		pos += RAWZ_BLOCK_SYNC_LEN;
+		
+		uint32_t floatBits[RAWZ_MAX_SENSORS + 1][RAWZ_MAX_STEPS][4] = {};
+		uint32_t sensorId[RAWZ_MAX_SENSORS + 1] = {};
+		uint64_t tick = 0;
+		uint32_t rtc = 0;
+		uint8_t modeLabel = 0;
+		int8_t code = 0;
+		
+		while (pos < data.size())
+		{
+			uint8_t tag = data[pos];
+			if (tag & ~(RAWZ_TAG_SENSOR | RAWZ_TAG_SENSOR_ID | RAWZ_TAG_DATA | RAWZ_TAG_RTC | RAWZ_TAG_META))
+			{
+				break;
+			}
+			pos++;
+			
+			decodedRecord decoded;
+			bme68xRawBinRecord& record = decoded.record;
+			record.sensorIndex = (tag & RAWZ_TAG_SENSOR) ? data[pos++] : BME68X_RAWBIN_NULL;
+			uint8_t slot = (record.sensorIndex < RAWZ_MAX_SENSORS) ? record.sensorIndex : RAWZ_MAX_SENSORS;
+			if (tag & RAWZ_TAG_SENSOR_ID)
+			{
+				sensorId[slot] = (uint32_t)readVarint(data, pos);
+			}
+			record.sensorId = (tag & RAWZ_TAG_SENSOR) ? sensorId[slot] : 0;
+			tick = readDelta(data, pos, tick);
+			if (tag & RAWZ_TAG_RTC)
+			{
+				rtc = (uint32_t)readDelta(data, pos, rtc);
+			}
+			
+			uint32_t bits[4] = {0x7FC00000, 0x7FC00000, 0x7FC00000, 0x7FC00000};
+			record.gasIndex = BME68X_RAWBIN_NULL;
+			if (tag & RAWZ_TAG_DATA)
+			{
+				uint32_t unused[4] = {0, 0, 0, 0};
+				record.gasIndex = data[pos++];
+				uint32_t* previous = (record.gasIndex < RAWZ_MAX_STEPS) ? floatBits[slot][record.gasIndex] : unused;
+				for (uint8_t i = 0; i < 4; i++)
+				{
+					bits[i] = previous[i] = (uint32_t)readDelta(data, pos, previous[i]);
+				}
+			}
+			memcpy(&record.temperature, &bits[0], sizeof(float));
+			memcpy(&record.pressure, &bits[1], sizeof(float));
+			memcpy(&record.humidity, &bits[2], sizeof(float));
+			memcpy(&record.gasResistance, &bits[3], sizeof(float));
+			
+			if (tag & RAWZ_TAG_META)
+			{
+				modeLabel = data[pos++];
+				code = (int8_t)data[pos++];
+			}
+			record.modeLabel = modeLabel;
+			record.code = code;
+			record.rtcTsp = rtc;
+			record.timeSincePowerOn = (uint32_t)tick;
+			decoded.timeSincePowerOn = tick;
+			records.push_back(decoded);
+		}
+	}
+	return records;
+}
+
+/*!
+ * @brief This function generates the samples of 8 sensors cycling through their heater steps, with slowly
+ *		  drifting values, missing sensors and data, label changes and errors
+ */
+static std::vector<decodedRecord> generate(uint64_t startMs)
+{
+	std::vector<decodedRecord> records;
+	uint32_t seed = 12345;
+	
+	for (uint32_t i = 0; i < TEST_RECORDS; i++)
+	{
+		decodedRecord decoded;
+		bme68xRawBinRecord& record = decoded.record;
+		uint8_t sensor = i % 8;
+		uint8_t step = (i / 8) % TEST_STEPS;
+		
+		seed = seed * 1664525 + 1013904223;
+		decoded.timeSincePowerOn = startMs + (uint64_t)i * TEST_PERIOD_MS;
+		record.timeSincePowerOn = (uint32_t)decoded.timeSincePowerOn;
+		record.rtcTsp = 1790000000 + (uint32_t)(decoded.timeSincePowerOn / 1000);
+		record.sensorIndex = ((i % 997) == 5) ? BME68X_RAWBIN_NULL : sensor;
+		record.sensorId = (record.sensorIndex == BME68X_RAWBIN_NULL) ? 0 : 0x1A2B3C00 + sensor;
+		if ((i % 501) == 7)
+		{
+			record.temperature = record.pressure = record.humidity = record.gasResistance = NAN;
+			record.gasIndex = BME68X_RAWBIN_NULL;
+		}
+		else
+		{
+			record.temperature = 24.5f + sensor * .1f + (float)(seed % 100) * .001f;
+			record.pressure = 1013.25f + (float)(i / 1000) * .01f;
+			record.humidity = 41.0f + (float)((seed >> 8) % 50) * .01f;
+			record.gasResistance = 12000.0f * (step + 1) + (float)((seed >> 16) % 2000);
+			record.gasIndex = step;
+		}
+		record.modeLabel = (uint8_t)((record.sensorIndex == BME68X_RAWBIN_NULL) ? BME68X_RAWBIN_MODE_NULL : 1) | (uint8_t)(((i / 5000) % 3) << 4);
+		record.code = ((i % 3001) == 11) ? -3 : 0;
+		records.push_back(decoded);
+	}
+	return records;
+}
+
+/*!
+ * @brief This function encodes the records as the datalogger does, starting a new block at reset
+ */
+static void encode(const std::vector<decodedRecord>& records, std::vector<uint8_t>& data)
+{
+	sampleEncoder encoder;
+	uint8_t out[RAWZ_RECORD_MAX_LEN + RAWZ_BLOCK_SYNC_LEN + 1];
+	
+	encoder.reset();
+	for (const decodedRecord& decoded : records)
+	{
+		size_t len = encoder.encode(out, decoded.record, decoded.timeSincePowerOn);
+		TEST_ASSERT_TRUE(len <= sizeof(out));
+		data.insert(data.end(), out, out + len);
+	}
+}
+
+/*!
+ * @brief This function checks that the decoded records are bit exact, from the given record on
+ */
+static void checkRecords(const std::vector<decodedRecord>& expected, size_t first, const std::vector<decodedRecord>& decoded)
+{
+	TEST_ASSERT_EQUAL_UINT32((uint32_t)(expected.size() - first), (uint32_t)decoded.size());
+	for (size_t i = 0; i < decoded.size(); i++)
+	{
+		const decodedRecord& want = expected[first + i];
+		TEST_ASSERT_TRUE(want.timeSincePowerOn == decoded[i].timeSincePowerOn);
+		TEST_ASSERT_EQUAL_MEMORY(&want.record, &decoded[i].record, sizeof(bme68xRawBinRecord));
+	}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief The decoded records are bit exact, the NaN of the samples without data included
+ */
+void test_round_trip(void)
+{
+	std::vector<decodedRecord> records = generate(1000);
+	std::vector<uint8_t> data;
+	
+	encode(records, data);
+	
+	checkRecords(records, 0, decode(data, 0));
+	printf("%u records, %.2f bytes per record, %.1f times smaller than .bmerawbin\n", TEST_RECORDS,
+		   (double)data.size() / TEST_RECORDS, (double)TEST_RECORDS * BME68X_RAWBIN_RECORD_SIZE / data.size());
+}
+
+/**
+ * @brief The time since power on goes on past 2^32 ms (49.7 days) instead of wrapping
+ */
+void test_time_past_wrap(void)
+{
+	uint64_t start = UINT64_C(0xFFFFFFFF) - (TEST_RECORDS / 2) * TEST_PERIOD_MS;
+	std::vector<decodedRecord> records = generate(start);
+	std::vector<uint8_t> data;
+	
+	encode(records, data);
+	std::vector<decodedRecord> decoded = decode(data, 0);
+	checkRecords(records, 0, decoded);
+	TEST_ASSERT_TRUE(decoded.back().timeSincePowerOn > UINT32_MAX);
+}
+
+/**
+ * @brief Each block decodes on its own, without the records of the previous blocks
+ */
+void test_independent_blocks(void)
+{
+	std::vector<decodedRecord> records = generate(UINT64_C(5000000000));
+	std::vector<uint8_t> data;
+	
+	encode(records, data);
+	size_t blocks = 0;
+	
+	for (size_t pos = 0; pos + RAWZ_BLOCK_SYNC_LEN <= data.size(); pos++)
+	{
+		if (memcmp(&data[pos], RAWZ_BLOCK_SYNC, RAWZ_BLOCK_SYNC_LEN) || (pos == 0))
+		{
+			continue;
+		}
+		/* the block closed by the end of block tag before its sync */
+		TEST_ASSERT_EQUAL_HEX8(RAWZ_TAG_END_OF_BLOCK, data[pos - 1]);
+		std::vector<decodedRecord> decoded = decode(data, pos);
+		checkRecords(records, records.size() - decoded.size(), decoded);
+		blocks++;
+	}
+	TEST_ASSERT_TRUE(blocks >= 2);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_round_trip);
+	RUN_TEST(test_time_past_wrap);
+	RUN_TEST(test_independent_blocks);
+	return UNITY_END();
+}
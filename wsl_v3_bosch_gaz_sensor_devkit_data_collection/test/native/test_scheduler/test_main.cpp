@@ -0,0 +1,248 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host tests and benchmark of the sensor wake up schedule
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "sensor_scheduler.h"
+
+#define NUM_SENSORS 8
+/* Heater step and FreeRTOS tick of the firmware */
+#define STEP_US 140000ULL
+#define TICK_US 1000ULL
+/* Heater profile of the simulated sensors: steps per cycle and sleep between cycles */
+#define PROFILE_STEPS 10
+/* Simulated run time of the jitter benchmark */
+#define RUN_US (3600ULL * 1000000ULL)
+/* Schedule operations of the timing loop */
+#define BENCH_OPS 1000000
+
+static sensorScheduler<NUM_SENSORS> scheduler;
+
+void setUp(void)
+{
+	scheduler.clear();
+	srand(1);
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief The sensors come out by wake up time, then heater profile first, then sensor number
+ */
+void test_order(void)
+{
+	uint64_t wakeUpTime[NUM_SENSORS];
+	bool inProfile[NUM_SENSORS];
+
+	for (uint32_t round = 0; round < 1000; round++)
+	{
+		for (uint8_t i = 0; i < NUM_SENSORS; i++)
+		{
+			/* few distinct times, so that ties are frequent */
+			wakeUpTime[i] = (uint64_t) (rand() % 4) * STEP_US;
+			inProfile[i] = rand() & 1;
+			scheduler.schedule(i, wakeUpTime[i], inProfile[i]);
+		}
+		/* move some of them again */
+		for (uint8_t k = 0; k < 4; k++)
+		{
+			uint8_t i = (uint8_t) (rand() % NUM_SENSORS);
+			wakeUpTime[i] = (uint64_t) (rand() % 4) * STEP_US;
+			scheduler.schedule(i, wakeUpTime[i], inProfile[i]);
+		}
+
+		uint8_t previous = 0xFF;
+		uint8_t visited = scheduler.visitDue(UINT64_MAX - 1, [&](uint8_t num)
+		{
+			if (previous != 0xFF)
+			{
+				bool ordered = (wakeUpTime[previous] < wakeUpTime[num]) ||
+					((wakeUpTime[previous] == wakeUpTime[num]) && ((inProfile[previous] && !inProfile[num]) ||
+					((inProfile[previous] == inProfile[num]) && (previous < num))));
+				TEST_ASSERT_TRUE(ordered);
+			}
+			previous = num;
+		});
+		TEST_ASSERT_EQUAL_UINT8(NUM_SENSORS, visited);
+	}
+}
+
+/**
+ * @brief Each due sensor is visited once per pass, also when it is rescheduled at the pass time
+ */
+void test_visit_once(void)
+{
+	uint32_t visits[NUM_SENSORS] = {0};
+	uint64_t now = 5 * STEP_US;
+
+	for (uint8_t i = 0; i < NUM_SENSORS; i++)
+	{
+		/* sensor 7 is not due yet */
+		scheduler.schedule(i, (i == 7) ? (now + 1) : (i * STEP_US / 2), false);
+	}
+	uint8_t visited = scheduler.visitDue(now, [&](uint8_t num)
+	{
+		visits[num]++;
+		/* no sleep duration: due again at once, as collectData reschedules it */
+		scheduler.schedule(num, now, false);
+	});
+
+	TEST_ASSERT_EQUAL_UINT8(NUM_SENSORS - 1, visited);
+	for (uint8_t i = 0; i < NUM_SENSORS - 1; i++)
+	{
+		TEST_ASSERT_EQUAL_UINT32(1, visits[i]);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, visits[7]);
+	TEST_ASSERT_EQUAL_UINT8(NUM_SENSORS, scheduler.size());
+	/* the next pass picks them up again */
+	TEST_ASSERT_EQUAL_UINT8(NUM_SENSORS - 1, scheduler.visitDue(now, [&](uint8_t num) { scheduler.schedule(num, now + STEP_US, true); }));
+	TEST_ASSERT_EQUAL_UINT64(now + 1, scheduler.getNextWakeUpTime());
+}
+
+/**
+ * @brief A sensor the visitor leaves alone goes back with its former wake up time
+ */
+void test_visit_without_reschedule(void)
+{
+	uint8_t num;
+
+	scheduler.schedule(3, 10, true);
+	scheduler.schedule(5, 20, false);
+	TEST_ASSERT_EQUAL_UINT8(1, scheduler.visitDue(15, [](uint8_t) {}));
+	TEST_ASSERT_EQUAL_UINT8(2, scheduler.size());
+	TEST_ASSERT_TRUE(scheduler.peekDue(num, 10));
+	TEST_ASSERT_EQUAL_UINT8(3, num);
+	TEST_ASSERT_FALSE(scheduler.peekDue(num, 9));
+}
+
+/**
+ * @brief Host cost of the schedule operations of one collected sensor
+ */
+void test_overhead(void)
+{
+	uint64_t sink = 0;
+
+	for (uint8_t i = 0; i < NUM_SENSORS; i++)
+	{
+		scheduler.schedule(i, i, true);
+	}
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < BENCH_OPS; i++)
+	{
+		uint8_t num = 0;
+		(void) scheduler.peekDue(num, UINT64_MAX - 1);
+		/* the first sensor moves one step on, as after a collection */
+		scheduler.schedule(num, i + NUM_SENSORS, true);
+		sink += scheduler.getNextWakeUpTime();
+	}
+	double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	TEST_ASSERT_TRUE(sink > 0);
+	printf("overhead: %.1f host ns per reschedule of %u sensors\n", ns / BENCH_OPS, NUM_SENSORS);
+}
+
+/**
+ * @brief Waking on whole ticks as waitForSensor does, no sensor is collected a tick or more late and the
+ *		  sensors sharing a wake up time are collected in the same pass
+ */
+void test_jitter(void)
+{
+	uint64_t wakeUpTime[NUM_SENSORS];
+	uint8_t step[NUM_SENSORS];
+	uint64_t sleepUs[NUM_SENSORS];
+	uint64_t lateSum = 0, lateMax = 0;
+	uint32_t collections = 0, passes = 0;
+	uint64_t now = 0;
+
+	for (uint8_t i = 0; i < NUM_SENSORS; i++)
+	{
+		/* half of the sensors share their timing, the others drift against them */
+		sleepUs[i] = (i < NUM_SENSORS / 2) ? 0 : (uint64_t) (i * 12345);
+		step[i] = 0;
+		wakeUpTime[i] = 0;
+		scheduler.schedule(i, 0, false);
+	}
+	while (now < RUN_US)
+	{
+		uint64_t next = scheduler.getNextWakeUpTime();
+		/* rounded up to whole ticks */
+		now = ((next + TICK_US - 1) / TICK_US) * TICK_US;
+		uint64_t passTime = now;
+		uint8_t shared = 0;
+
+		passes++;
+		(void) scheduler.visitDue(passTime, [&](uint8_t num)
+		{
+			uint64_t late = passTime - wakeUpTime[num];
+			lateSum += late;
+			lateMax = (late > lateMax) ? late : lateMax;
+			collections++;
+			shared += (num < NUM_SENSORS / 2);
+
+			bool endOfCycle = (++step[num] == PROFILE_STEPS);
+			step[num] %= PROFILE_STEPS;
+			wakeUpTime[num] = passTime + (endOfCycle ? sleepUs[num] : STEP_US);
+			scheduler.schedule(num, wakeUpTime[num], !endOfCycle);
+		});
+		TEST_ASSERT_TRUE((shared == 0) || (shared == NUM_SENSORS / 2));
+	}
+
+	TEST_ASSERT_LESS_THAN(TICK_US, lateMax);
+	printf("jitter: %lu collections in %lu passes, lateness mean %.1f us max %lu us\n", (unsigned long) collections,
+		(unsigned long) passes, (double) lateSum / collections, (unsigned long) lateMax);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_order);
+	RUN_TEST(test_visit_once);
+	RUN_TEST(test_visit_without_reschedule);
+	RUN_TEST(test_overhead);
+	RUN_TEST(test_jitter);
+	return UNITY_END();
+}
@@ -0,0 +1,232 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host microbenchmark of the commMux SPI transfers against a counting SPI master
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "commMux.h"
+
+/* Register accesses of bme68x_get_data in parallel mode: status, field data, status, heater current */
+#define SAMPLE_ACCESSES 4
+static const uint8_t sampleRegs[SAMPLE_ACCESSES] = {0xF3, 0x9D, 0xF3, 0xD0};
+static const uint8_t sampleLens[SAMPLE_ACCESSES] = {1, 51, 1, 30};
+/* Samples read by the timing loop */
+#define BENCH_SAMPLES 100000
+
+/**
+ * SPI master counting the calls and bytes, the sensor answers with an incrementing pattern
+ */
+class countingSpi : public SPIClass
+{
+public:
+	uint32_t calls = 0;
+	uint32_t bytes = 0;
+	uint32_t transactions = 0;
+	uint8_t pattern = 0;
+	uint8_t written[64];
+	uint32_t writtenLen = 0;
+
+	void beginTransaction(const SPISettings &settings) override
+	{
+		(void) settings;
+		transactions++;
+		writtenLen = 0;
+	}
+	uint8_t transfer(uint8_t data) override
+	{
+		calls++;
+		bytes++;
+		record(&data, 1);
+		return pattern++;
+	}
+	void writeBytes(const uint8_t *data, uint32_t size) override
+	{
+		calls++;
+		bytes += size;
+		record(data, size);
+	}
+	void transferBytes(const uint8_t *data, uint8_t *out, uint32_t size) override
+	{
+		calls++;
+		bytes += size;
+		/* the read path sends no data, the bus then clocks out 0xFF */
+		TEST_ASSERT_NULL(data);
+		for (uint32_t i = 0; i < size; i++)
+		{
+			out[i] = pattern++;
+		}
+	}
+	void reset(void)
+	{
+		calls = bytes = transactions = 0;
+		pattern = 0;
+	}
+
+private:
+	void record(const uint8_t *data, uint32_t size)
+	{
+		for (uint32_t i = 0; (i < size) && (writtenLen < sizeof(written)); i++)
+		{
+			written[writtenLen++] = data[i];
+		}
+	}
+};
+
+static TwoWire wire;
+static countingSpi spi;
+static commMux comm;
+
+/**
+ * @brief This function reads a sample the way the bme68x driver does
+ */
+static void readSample(void)
+{
+	uint8_t data[64];
+
+	commMuxBeginSession(comm);
+	for (uint8_t i = 0; i < SAMPLE_ACCESSES; i++)
+	{
+		(void) commMuxRead(sampleRegs[i], data, sampleLens[i], &comm);
+	}
+	commMuxEndSession();
+}
+
+void setUp(void)
+{
+	commMuxBegin(wire, spi);
+	(void) commMuxSetConfig(wire, spi, 0, comm);
+	commMuxResetStats(comm);
+	spi.reset();
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Bursts go through one block call, a sample takes 8 calls instead of 87 byte transfers
+ */
+void test_calls_per_sample(void)
+{
+	uint32_t byteCalls = 0, sampleBytes = 0;
+
+	for (uint8_t i = 0; i < SAMPLE_ACCESSES; i++)
+	{
+		byteCalls += 1 + sampleLens[i];
+		sampleBytes += 1 + sampleLens[i];
+	}
+	readSample();
+
+	TEST_ASSERT_EQUAL_UINT32(SAMPLE_ACCESSES, spi.transactions);
+	TEST_ASSERT_EQUAL_UINT32(sampleBytes, spi.bytes);
+	TEST_ASSERT_EQUAL_UINT32(8, spi.calls);
+	printf("per sample: %lu calls (%lu with byte transfers), %.1f bytes per call (1.0)\n", (unsigned long) spi.calls,
+		(unsigned long) byteCalls, (double) spi.bytes / spi.calls);
+}
+
+/**
+ * @brief Short and long reads land in the buffer in bus order
+ */
+void test_read_data(void)
+{
+	uint8_t data[64];
+
+	memset(data, 0, sizeof(data));
+	TEST_ASSERT_EQUAL_INT8(0, commMuxRead(0xF3, data, 3, &comm));
+	/* pattern 0 is clocked out while the address is sent */
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		TEST_ASSERT_EQUAL_UINT8(i + 1, data[i]);
+	}
+	TEST_ASSERT_EQUAL_INT8(0, commMuxRead(0x9D, data, 51, &comm));
+	for (uint8_t i = 0; i < 51; i++)
+	{
+		TEST_ASSERT_EQUAL_UINT8(i + 5, data[i]);
+	}
+}
+
+/**
+ * @brief A heater profile burst is written with one block call after the address
+ */
+void test_write_burst(void)
+{
+	uint8_t profile[20];
+
+	for (uint8_t i = 0; i < sizeof(profile); i++)
+	{
+		profile[i] = (uint8_t) (0x40 + i);
+	}
+	TEST_ASSERT_EQUAL_INT8(0, commMuxWrite(0x5A, profile, sizeof(profile), &comm));
+
+	TEST_ASSERT_EQUAL_UINT32(2, spi.calls);
+	TEST_ASSERT_EQUAL_UINT32(1 + sizeof(profile), spi.writtenLen);
+	TEST_ASSERT_EQUAL_UINT8(0x5A, spi.written[0]);
+	TEST_ASSERT_EQUAL_MEMORY(profile, &spi.written[1], sizeof(profile));
+}
+
+/**
+ * @brief Host cost of a sample through commMux, call overhead of the fake bus included
+ */
+void test_sample_timing(void)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+	{
+		readSample();
+	}
+	double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	TEST_ASSERT_EQUAL_UINT32(8 * BENCH_SAMPLES, spi.calls);
+	printf("per sample: %.0f host ns\n", ns / BENCH_SAMPLES);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_calls_per_sample);
+	RUN_TEST(test_read_data);
+	RUN_TEST(test_write_burst);
+	RUN_TEST(test_sample_timing);
+	return UNITY_END();
+}
@@ -0,0 +1,271 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host tests of the single producer, single consumer ring buffer
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <thread>
+#include <atomic>
+#include "spsc_ring.h"
+
+/* Items pushed by the stress test */
+#define STRESS_ITEMS 2000000
+
+/**
+ * Item large enough that a torn copy shows up in its check word
+ */
+struct ringItem {
+	uint32_t seq;
+	uint32_t payload[6];
+	uint32_t check;
+};
+
+static ringItem makeItem(uint32_t seq)
+{
+	ringItem item;
+
+	item.seq = seq;
+	item.check = seq;
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		item.payload[i] = seq * (i + 3);
+		item.check ^= item.payload[i];
+	}
+	return item;
+}
+
+static bool isIntact(const ringItem &item)
+{
+	uint32_t check = item.seq;
+
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		if (item.payload[i] != item.seq * (i + 3))
+		{
+			return false;
+		}
+		check ^= item.payload[i];
+	}
+	return check == item.check;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Items come out in push order, across several wraps of the slots
+ */
+void test_order(void)
+{
+	static spscRing<uint32_t, 8> ring;
+	uint32_t next = 0, expected = 0, item;
+
+	for (uint32_t round = 0; round < 100; round++)
+	{
+		/* a varying fill level moves the wrap point */
+		for (uint32_t i = 0; i < (round % 8) + 1; i++)
+		{
+			TEST_ASSERT_TRUE(ring.push(next++));
+		}
+		TEST_ASSERT_TRUE(ring.peek(item));
+		TEST_ASSERT_EQUAL_UINT32(expected, item);
+		while (ring.pop(item))
+		{
+			TEST_ASSERT_EQUAL_UINT32(expected++, item);
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT32(next, expected);
+	TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+	TEST_ASSERT_FALSE(ring.peek(item));
+	TEST_ASSERT_EQUAL_UINT32(0, ring.getOverflows());
+}
+
+/**
+ * @brief A full ring drops and counts the new item, the stored ones are kept
+ */
+void test_overflow(void)
+{
+	static spscRing<uint32_t, 4> ring;
+	uint32_t item;
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		TEST_ASSERT_TRUE(ring.push(i));
+	}
+	TEST_ASSERT_FALSE(ring.push(100));
+	TEST_ASSERT_NULL(ring.reserve());
+	TEST_ASSERT_EQUAL_UINT32(2, ring.getOverflows());
+	TEST_ASSERT_EQUAL_UINT32(4, ring.size());
+	TEST_ASSERT_EQUAL_UINT32(4, ring.getHighWater());
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		TEST_ASSERT_TRUE(ring.pop(item));
+		TEST_ASSERT_EQUAL_UINT32(i, item);
+	}
+	/* the counters keep their values once there is room again */
+	TEST_ASSERT_TRUE(ring.push(5));
+	TEST_ASSERT_EQUAL_UINT32(2, ring.getOverflows());
+	TEST_ASSERT_EQUAL_UINT32(4, ring.getHighWater());
+}
+
+/**
+ * @brief An item built in place is invisible until it is committed
+ */
+void test_reserve_commit(void)
+{
+	static spscRing<uint32_t, 4> ring;
+	uint32_t item;
+
+	uint32_t *slot = ring.reserve();
+	TEST_ASSERT_NOT_NULL(slot);
+	*slot = 42;
+	TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+	TEST_ASSERT_FALSE(ring.peek(item));
+	ring.commit();
+	TEST_ASSERT_EQUAL_UINT32(1, ring.getHighWater());
+	TEST_ASSERT_TRUE(ring.pop(item));
+	TEST_ASSERT_EQUAL_UINT32(42, item);
+}
+
+/**
+ * @brief A producer and a consumer thread: every item arrives intact and in order, every failed push is
+ *		  counted as overflow. The producer retries most items, so that the ring runs full and empty often.
+ */
+void test_stress(void)
+{
+	static spscRing<ringItem, 64> ring;
+	std::atomic<bool> done(false);
+	uint32_t pushed = 0, failed = 0;
+	uint32_t received = 0, outOfOrder = 0, torn = 0;
+
+	std::thread producer([&]()
+	{
+		for (uint32_t seq = 0; seq < STRESS_ITEMS; seq++)
+		{
+			/* every 16th item is given up at the first failure */
+			bool retry = (seq % 16) != 0;
+			for (;;)
+			{
+				bool ok;
+				/* alternates both producer calls */
+				if (seq & 1)
+				{
+					ringItem *slot = ring.reserve();
+					ok = (slot != nullptr);
+					if (ok)
+					{
+						*slot = makeItem(seq);
+						ring.commit();
+					}
+				}
+				else
+				{
+					ok = ring.push(makeItem(seq));
+				}
+				if (ok)
+				{
+					pushed++;
+					break;
+				}
+				failed++;
+				if (!retry)
+				{
+					break;
+				}
+				std::this_thread::yield();
+			}
+		}
+		done.store(true);
+	});
+	std::thread consumer([&]()
+	{
+		int64_t last = -1;
+		ringItem item;
+
+		for (;;)
+		{
+			/* read before the pop, so that the last items are not missed */
+			bool finished = done.load();
+			if (!ring.pop(item))
+			{
+				if (finished)
+				{
+					break;
+				}
+				std::this_thread::yield();
+				continue;
+			}
+			received++;
+			outOfOrder += ((int64_t) item.seq <= last);
+			torn += !isIntact(item);
+			last = item.seq;
+		}
+	});
+	producer.join();
+	consumer.join();
+
+	printf("stress: %lu items received, %lu failed pushes, high water %lu\n", (unsigned long) received,
+		(unsigned long) failed, (unsigned long) ring.getHighWater());
+	TEST_ASSERT_EQUAL_UINT32(0, torn);
+	TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+	TEST_ASSERT_EQUAL_UINT32(pushed, received);
+	TEST_ASSERT_EQUAL_UINT32(failed, ring.getOverflows());
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32(STRESS_ITEMS - STRESS_ITEMS / 16, received);
+	TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32(ring.capacity(), ring.getHighWater());
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_order);
+	RUN_TEST(test_overflow);
+	RUN_TEST(test_reserve_commit);
+	RUN_TEST(test_stress);
+	return UNITY_END();
+}
@@ -0,0 +1,293 @@
+/*!
+ * Copyright (c) 2021 Bosch Sensortec GmbH. All rights reserved.
+ *
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @file	test_main.cpp
+ * @date	17 October 2026
+ * @version	1.5.5
+ * 
+ * @brief	Host benchmark of the Json row formatting against std::ostringstream
+ * 
+ * 
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include "text_format.h"
+
+/* Size of the row buffer, one SD writer buffer */
+#define ROW_BUFFER_SIZE 4096
+/* Rows of the timing loops */
+#define BENCH_ROWS 200000
+/* Rows of 24 hours: 8 sensors, one field per 140 ms heater step */
+#define DAY_ROWS (8ULL * 24 * 3600 * 1000 / 140)
+
+/* Heap allocations since start, counted by the replaced operator new */
+static uint64_t allocations = 0;
+
+void *operator new(size_t size)
+{
+	allocations++;
+	void *ptr = malloc(size ? size : 1);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+	(void) size;
+	free(ptr);
+}
+
+/**
+ * Values of one raw data row
+ */
+struct rowValues {
+	uint8_t num;
+	uint32_t sensorId;
+	uint32_t timeSincePowerOn;
+	uint32_t rtcTsp;
+	float temperature, pressure, humidity, gasResistance;
+	uint8_t gasIndex;
+	uint8_t scanning;
+	uint8_t label;
+	int8_t code;
+};
+
+static char buffer[ROW_BUFFER_SIZE];
+
+/**
+ * @brief This function draws the values of row i, as a sensor would deliver them
+ */
+static rowValues makeRow(uint64_t i)
+{
+	rowValues row;
+
+	row.num = (uint8_t) (i % 8);
+	row.sensorId = 0x5A0000C0 + row.num;
+	row.timeSincePowerOn = (uint32_t) (i * 140 / 8);
+	row.rtcTsp = 1792000000 + (uint32_t) (i * 140 / 8000);
+	row.temperature = 24.0f + (float) (i % 1000) * 0.00371f;
+	row.pressure = 1013.25f - (float) (i % 777) * 0.0113f;
+	row.humidity = 41.5f + (float) (i % 555) * 0.0217f;
+	row.gasResistance = 48000.0f + (float) (i % 9973) * 3.77f;
+	row.gasIndex = (uint8_t) (i % 10);
+	row.scanning = 1;
+	row.label = 0;
+	row.code = 0;
+	return row;
+}
+
+/**
+ * @brief This function formats a row as bme68xDataLogger::writeText does
+ */
+static size_t formatRow(char *out, size_t len, const rowValues &row)
+{
+	textFormat::append(out, len, "\t\t[");
+	textFormat::appendInt(out, len, row.num);
+	textFormat::append(out, len, ",");
+	textFormat::appendInt(out, len, (int32_t) row.sensorId);
+	textFormat::append(out, len, ",");
+	textFormat::appendUInt(out, len, row.timeSincePowerOn);
+	textFormat::append(out, len, ",");
+	textFormat::appendUInt(out, len, row.rtcTsp);
+	textFormat::append(out, len, ",");
+	textFormat::appendFloat(out, len, ROW_BUFFER_SIZE, row.temperature);
+	textFormat::append(out, len, ",");
+	textFormat::appendFloat(out, len, ROW_BUFFER_SIZE, row.pressure);
+	textFormat::append(out, len, ",");
+	textFormat::appendFloat(out, len, ROW_BUFFER_SIZE, row.humidity);
+	textFormat::append(out, len, ",");
+	textFormat::appendFloat(out, len, ROW_BUFFER_SIZE, row.gasResistance);
+	textFormat::append(out, len, ",");
+	textFormat::appendInt(out, len, row.gasIndex);
+	textFormat::append(out, len, ",");
+	textFormat::appendInt(out, len, row.scanning);
+	textFormat::append(out, len, ",");
+	textFormat::appendInt(out, len, row.label);
+	textFormat::append(out, len, ",");
+	textFormat::appendInt(out, len, row.code);
+	textFormat::append(out, len, "]");
+	return len;
+}
+
+/**
+ * @brief This function formats a row with a string stream, the reference
+ */
+static std::string streamRow(const rowValues &row)
+{
+	std::ostringstream out;
+
+	out << std::fixed << std::setprecision(6) << "\t\t[" << (int) row.num << "," << (int32_t) row.sensorId << ","
+		<< row.timeSincePowerOn << "," << row.rtcTsp << "," << row.temperature << "," << row.pressure << ","
+		<< row.humidity << "," << row.gasResistance << "," << (int) row.gasIndex << "," << (int) row.scanning << ","
+		<< (int) row.label << "," << (int) row.code << "]";
+	return out.str();
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief The floats print the digits of printf("%.6f"), also at the rounding ties and on the slow path
+ */
+void test_float_text(void)
+{
+	static const float values[] = {0.0f, -0.0f, 0.5f, 1.0000005f, 2.5e-7f, -3.75f, 123456.789f, 999999999.0f,
+		1e9f, -4.2e12f, 3.4e38f, NAN, INFINITY, -INFINITY};
+	char expected[64];
+
+	for (float value : values)
+	{
+		size_t len = 0;
+		textFormat::appendFloat(buffer, len, ROW_BUFFER_SIZE, value);
+		buffer[len] = '\0';
+		snprintf(expected, sizeof(expected), "%.6f", (double) value);
+		TEST_ASSERT_EQUAL_STRING(expected, buffer);
+	}
+	srand(7);
+	for (uint32_t i = 0; i < 1000000; i++)
+	{
+		uint32_t bits = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		size_t len = 0;
+		textFormat::appendFloat(buffer, len, ROW_BUFFER_SIZE, value);
+		buffer[len] = '\0';
+		snprintf(expected, sizeof(expected), "%.6f", (double) value);
+		TEST_ASSERT_EQUAL_STRING(expected, buffer);
+	}
+}
+
+/**
+ * @brief The rows are the same text as the string stream ones
+ */
+void test_row_text(void)
+{
+	for (uint64_t i = 0; i < 10000; i++)
+	{
+		rowValues row = makeRow(i);
+		size_t len = formatRow(buffer, 0, row);
+		buffer[len] = '\0';
+		TEST_ASSERT_EQUAL_STRING(streamRow(row).c_str(), buffer);
+	}
+}
+
+/**
+ * @brief Time and heap allocations per row, against the string stream
+ */
+void test_row_cost(void)
+{
+	size_t len = 0;
+	uint64_t start = allocations;
+	auto begin = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < BENCH_ROWS; i++)
+	{
+		/* the buffer is handed over to the SD writer once full */
+		if (len > ROW_BUFFER_SIZE - 256)
+		{
+			len = 0;
+		}
+		len = formatRow(buffer, len, makeRow(i));
+	}
+	double formatNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+	uint64_t formatAllocations = allocations - start;
+
+	size_t sink = 0;
+	start = allocations;
+	begin = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < BENCH_ROWS; i++)
+	{
+		sink += streamRow(makeRow(i)).size();
+	}
+	double streamNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+	uint64_t streamAllocations = allocations - start;
+
+	TEST_ASSERT_TRUE(sink > 0);
+	TEST_ASSERT_EQUAL_UINT64(0, formatAllocations);
+	printf("per row: textFormat %.0f ns, 0 allocations; ostringstream %.0f ns, %.2f allocations\n",
+		formatNs / BENCH_ROWS, streamNs / BENCH_ROWS, (double) streamAllocations / BENCH_ROWS);
+}
+
+/**
+ * @brief The rows of 24 hours of logging are formatted without a single heap allocation, so the row
+ *		  formatting cannot fragment the heap; the on-device 24 hour heap run covers the rest of the firmware
+ */
+void test_day_without_allocation(void)
+{
+	size_t len = 0;
+	uint64_t bytes = 0;
+	uint64_t start = allocations;
+
+	for (uint64_t i = 0; i < DAY_ROWS; i++)
+	{
+		if (len > ROW_BUFFER_SIZE - 256)
+		{
+			bytes += len;
+			len = 0;
+		}
+		len = formatRow(buffer, len, makeRow(i));
+	}
+	bytes += len;
+
+	TEST_ASSERT_EQUAL_UINT64(0, allocations - start);
+	printf("24 h: %llu rows, %llu bytes, 0 allocations\n", (unsigned long long) DAY_ROWS, (unsigned long long) bytes);
+}
+
+int main(int argc, char **argv)
+{
+	(void) argc;
+	(void) argv;
+	UNITY_BEGIN();
+	RUN_TEST(test_float_text);
+	RUN_TEST(test_row_text);
+	RUN_TEST(test_row_cost);
+	RUN_TEST(test_day_without_allocation);
+	return UNITY_END();
+}